@@ -0,0 +1,35 @@
+// An element-wise binary map, whose function body and element types are
+// set using preprocessor definitions:
+//
+//   ELEMENTWISE_OP  - an expression in terms of `x` and `y`, e.g. "x * y + 1"
+//   RESULT_TYPE     - the element type of the result buffer (default: float)
+//   X_TYPE          - the element type of the first input buffer (default: float)
+//   Y_TYPE          - the element type of the second input buffer (default: float)
+
+#include "include/elementwise.cuh"
+
+#ifndef RESULT_TYPE
+#define RESULT_TYPE float
+#endif
+#ifndef X_TYPE
+#define X_TYPE float
+#endif
+#ifndef Y_TYPE
+#define Y_TYPE float
+#endif
+
+struct binary_op {
+    __device__ __forceinline__ RESULT_TYPE operator()(X_TYPE x, Y_TYPE y) const
+    {
+        return (ELEMENTWISE_OP);
+    }
+};
+
+__global__ void elementwiseBinary(
+        RESULT_TYPE  * __restrict  result,
+        X_TYPE const * __restrict  x,
+        Y_TYPE const * __restrict  y,
+        size_t length)
+{
+    elementwise::apply(binary_op{}, length, result, x, y);
+}
@@ -0,0 +1,30 @@
+// An element-wise unary map, whose function body and element types are
+// set using preprocessor definitions:
+//
+//   ELEMENTWISE_OP  - an expression in terms of `x`, e.g. "x * x + 1"
+//   RESULT_TYPE     - the element type of the result buffer (default: float)
+//   X_TYPE          - the element type of the input buffer (default: float)
+
+#include "include/elementwise.cuh"
+
+#ifndef RESULT_TYPE
+#define RESULT_TYPE float
+#endif
+#ifndef X_TYPE
+#define X_TYPE float
+#endif
+
+struct unary_op {
+    __device__ __forceinline__ RESULT_TYPE operator()(X_TYPE x) const
+    {
+        return (ELEMENTWISE_OP);
+    }
+};
+
+__global__ void elementwiseUnary(
+        RESULT_TYPE  * __restrict  result,
+        X_TYPE const * __restrict  x,
+        size_t length)
+{
+    elementwise::apply(unary_op{}, length, result, x);
+}
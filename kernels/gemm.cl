@@ -0,0 +1,145 @@
+// A tiled matrix multiplication, C = A * B, with all matrices in row-major
+// layout: A is m x k, B is k x n and C is m x n. See gemm.cu for a description
+// of the tiling scheme; this is the same scheme, using local memory.
+//
+// Preprocessor definitions (all optional):
+//
+//   HALF_PRECISION  - elements are half-precision rather than single-precision
+//                     (accumulation is in single-precision regardless; the
+//                     cl_khr_fp16 extension is not required)
+//   TILE_M, TILE_N, TILE_K       - the work-group tile dimensions
+//   THREAD_TILE_M, THREAD_TILE_N - the per-work-item sub-tile dimensions
+//
+// The global work size must be (ceil(n / TILE_N) * TILE_N / THREAD_TILE_N) x
+// (ceil(m / TILE_M) * TILE_M / THREAD_TILE_M), with a local work size of
+// (TILE_N / THREAD_TILE_N) x (TILE_M / THREAD_TILE_M).
+
+#ifndef TILE_M
+#define TILE_M 64
+#endif
+#ifndef TILE_N
+#define TILE_N 64
+#endif
+#ifndef TILE_K
+#define TILE_K 8
+#endif
+#ifndef THREAD_TILE_M
+#define THREAD_TILE_M 4
+#endif
+#ifndef THREAD_TILE_N
+#define THREAD_TILE_N 4
+#endif
+
+#ifdef HALF_PRECISION
+typedef half value_type;
+#define LOAD_VALUE(ptr, index) vload_half((index), (ptr))
+#define STORE_VALUE(ptr, index, value) vstore_half((value), (index), (ptr))
+#else
+typedef float value_type;
+#define LOAD_VALUE(ptr, index) ((ptr)[(index)])
+#define STORE_VALUE(ptr, index, value) ((ptr)[(index)] = (value))
+#endif
+
+#define BLOCK_THREADS_M (TILE_M / THREAD_TILE_M)
+#define BLOCK_THREADS_N (TILE_N / THREAD_TILE_N)
+#define BLOCK_SIZE (BLOCK_THREADS_M * BLOCK_THREADS_N)
+#define A_TILE_LOADS_PER_THREAD ((TILE_M * TILE_K + BLOCK_SIZE - 1) / BLOCK_SIZE)
+#define B_TILE_LOADS_PER_THREAD ((TILE_K * TILE_N + BLOCK_SIZE - 1) / BLOCK_SIZE)
+
+__kernel void gemm(
+    __global value_type       * restrict C,
+    __global value_type const * restrict A,
+    __global value_type const * restrict B,
+    uint m,
+    uint n,
+    uint k)
+{
+    __local float a_tiles[2][TILE_K][TILE_M];
+    __local float b_tiles[2][TILE_K][TILE_N];
+
+    const uint tx = get_local_id(0);
+    const uint ty = get_local_id(1);
+    const uint thread_index = tx + ty * BLOCK_THREADS_N;
+    const uint row_base = get_group_id(1) * TILE_M;
+    const uint col_base = get_group_id(0) * TILE_N;
+
+    float a_staging[A_TILE_LOADS_PER_THREAD];
+    float b_staging[B_TILE_LOADS_PER_THREAD];
+    float accumulators[THREAD_TILE_M][THREAD_TILE_N];
+    for(uint i = 0; i < THREAD_TILE_M; i++) {
+        for(uint j = 0; j < THREAD_TILE_N; j++) {
+            accumulators[i][j] = 0.0f;
+        }
+    }
+
+    const uint num_slabs = (k + TILE_K - 1) / TILE_K;
+    for(uint slab = 0; slab <= num_slabs; slab++) {
+        // Iteration `slab` fetches slab `slab` and multiplies slab `slab - 1`
+        const uint current = (slab + 1) % 2;
+        const bool have_next = (slab < num_slabs);
+        if (have_next) {
+            const uint k_base = slab * TILE_K;
+            for(uint i = 0; i < A_TILE_LOADS_PER_THREAD; i++) {
+                uint pos = thread_index + i * BLOCK_SIZE;
+                uint row = row_base + pos / TILE_K;
+                uint col = k_base + pos % TILE_K;
+                a_staging[i] = (pos < TILE_M * TILE_K && row < m && col < k) ?
+                    (float) LOAD_VALUE(A, (size_t) row * k + col) : 0.0f;
+            }
+            for(uint i = 0; i < B_TILE_LOADS_PER_THREAD; i++) {
+                uint pos = thread_index + i * BLOCK_SIZE;
+                uint row = k_base + pos / TILE_N;
+                uint col = col_base + pos % TILE_N;
+                b_staging[i] = (pos < TILE_K * TILE_N && row < k && col < n) ?
+                    (float) LOAD_VALUE(B, (size_t) row * n + col) : 0.0f;
+            }
+        }
+
+        if (slab > 0) {
+            for(uint kk = 0; kk < TILE_K; kk++) {
+                float a_fragment[THREAD_TILE_M];
+                float b_fragment[THREAD_TILE_N];
+                for(uint i = 0; i < THREAD_TILE_M; i++) {
+                    a_fragment[i] = a_tiles[current][kk][ty + i * BLOCK_THREADS_M];
+                }
+                for(uint j = 0; j < THREAD_TILE_N; j++) {
+                    b_fragment[j] = b_tiles[current][kk][tx + j * BLOCK_THREADS_N];
+                }
+                for(uint i = 0; i < THREAD_TILE_M; i++) {
+                    for(uint j = 0; j < THREAD_TILE_N; j++) {
+                        accumulators[i][j] = mad(a_fragment[i], b_fragment[j], accumulators[i][j]);
+                    }
+                }
+            }
+        }
+
+        if (have_next) {
+            // The other buffer was last read in the previous iteration, before its closing barrier
+            const uint next = 1 - current;
+            for(uint i = 0; i < A_TILE_LOADS_PER_THREAD; i++) {
+                uint pos = thread_index + i * BLOCK_SIZE;
+                if (pos < TILE_M * TILE_K) {
+                    a_tiles[next][pos % TILE_K][pos / TILE_K] = a_staging[i];
+                }
+            }
+            for(uint i = 0; i < B_TILE_LOADS_PER_THREAD; i++) {
+                uint pos = thread_index + i * BLOCK_SIZE;
+                if (pos < TILE_K * TILE_N) {
+                    b_tiles[next][pos / TILE_N][pos % TILE_N] = b_staging[i];
+                }
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    for(uint i = 0; i < THREAD_TILE_M; i++) {
+        uint row = row_base + ty + i * BLOCK_THREADS_M;
+        if (row >= m) { continue; }
+        for(uint j = 0; j < THREAD_TILE_N; j++) {
+            uint col = col_base + tx + j * BLOCK_THREADS_N;
+            if (col < n) {
+                STORE_VALUE(C, (size_t) row * n + col, accumulators[i][j]);
+            }
+        }
+    }
+}
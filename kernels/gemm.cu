@@ -0,0 +1,178 @@
+// A tiled matrix multiplication, C = A * B, with all matrices in row-major
+// layout: A is m x k, B is k x n and C is m x n.
+//
+// Each block computes a TILE_M x TILE_N tile of C, iterating over TILE_K-wide
+// slabs of A and B which are staged in double-buffered shared memory: While
+// the current slab is being multiplied, the next one is fetched into registers
+// and then stored into the other buffer. Each thread computes a
+// THREAD_TILE_M x THREAD_TILE_N sub-tile of the block's C tile, in registers;
+// the sub-tile elements are strided across the block's tile, to avoid shared
+// memory bank conflicts.
+//
+// Preprocessor definitions (all optional):
+//
+//   HALF_PRECISION  - elements are half-precision rather than single-precision
+//                     (accumulation is in single-precision regardless)
+//   TILE_M, TILE_N, TILE_K       - the block tile dimensions
+//   THREAD_TILE_M, THREAD_TILE_N - the per-thread sub-tile dimensions
+//
+// The launch grid must be ceil(n / TILE_N) x ceil(m / TILE_M) blocks, each of
+// (TILE_N / THREAD_TILE_N) x (TILE_M / THREAD_TILE_M) threads.
+
+#include <cuda_fp16.h>
+
+#ifndef TILE_M
+#define TILE_M 64
+#endif
+#ifndef TILE_N
+#define TILE_N 64
+#endif
+#ifndef TILE_K
+#define TILE_K 8
+#endif
+#ifndef THREAD_TILE_M
+#define THREAD_TILE_M 4
+#endif
+#ifndef THREAD_TILE_N
+#define THREAD_TILE_N 4
+#endif
+
+#ifdef HALF_PRECISION
+typedef __half value_type;
+#else
+typedef float value_type;
+#endif
+typedef float accumulator_type;
+
+enum : unsigned {
+    block_threads_m = TILE_M / THREAD_TILE_M,
+    block_threads_n = TILE_N / THREAD_TILE_N,
+    block_size = block_threads_m * block_threads_n,
+    a_tile_loads_per_thread = (TILE_M * TILE_K + block_size - 1) / block_size,
+    b_tile_loads_per_thread = (TILE_K * TILE_N + block_size - 1) / block_size,
+};
+
+static_assert(TILE_M % THREAD_TILE_M == 0, "TILE_M must be a multiple of THREAD_TILE_M");
+static_assert(TILE_N % THREAD_TILE_N == 0, "TILE_N must be a multiple of THREAD_TILE_N");
+
+// Fetch this thread's share of the A and B slabs beginning at column/row k_base
+__device__ __forceinline__ void fetch_slabs(
+    accumulator_type        (&a_staging)[a_tile_loads_per_thread],
+    accumulator_type        (&b_staging)[b_tile_loads_per_thread],
+    value_type const * __restrict__ A,
+    value_type const * __restrict__ B,
+    unsigned m, unsigned n, unsigned k,
+    unsigned row_base, unsigned col_base, unsigned k_base)
+{
+    #pragma unroll
+    for(unsigned i = 0; i < a_tile_loads_per_thread; i++) {
+        unsigned pos = threadIdx.x + threadIdx.y * block_threads_n + i * block_size;
+        unsigned row = row_base + pos / TILE_K;
+        unsigned col = k_base + pos % TILE_K;
+        a_staging[i] = (pos < TILE_M * TILE_K and row < m and col < k) ?
+            static_cast<accumulator_type>(A[(size_t) row * k + col]) : accumulator_type(0);
+    }
+    #pragma unroll
+    for(unsigned i = 0; i < b_tile_loads_per_thread; i++) {
+        unsigned pos = threadIdx.x + threadIdx.y * block_threads_n + i * block_size;
+        unsigned row = k_base + pos / TILE_N;
+        unsigned col = col_base + pos % TILE_N;
+        b_staging[i] = (pos < TILE_K * TILE_N and row < k and col < n) ?
+            static_cast<accumulator_type>(B[(size_t) row * n + col]) : accumulator_type(0);
+    }
+}
+
+__device__ __forceinline__ void store_slabs(
+    accumulator_type (&a_tile)[TILE_K][TILE_M],
+    accumulator_type (&b_tile)[TILE_K][TILE_N],
+    const accumulator_type (&a_staging)[a_tile_loads_per_thread],
+    const accumulator_type (&b_staging)[b_tile_loads_per_thread])
+{
+    #pragma unroll
+    for(unsigned i = 0; i < a_tile_loads_per_thread; i++) {
+        unsigned pos = threadIdx.x + threadIdx.y * block_threads_n + i * block_size;
+        if (pos < TILE_M * TILE_K) {
+            // Stored transposed, so that the inner product loop reads along m
+            a_tile[pos % TILE_K][pos / TILE_K] = a_staging[i];
+        }
+    }
+    #pragma unroll
+    for(unsigned i = 0; i < b_tile_loads_per_thread; i++) {
+        unsigned pos = threadIdx.x + threadIdx.y * block_threads_n + i * block_size;
+        if (pos < TILE_K * TILE_N) {
+            b_tile[pos / TILE_N][pos % TILE_N] = b_staging[i];
+        }
+    }
+}
+
+__global__ void gemm(
+    value_type       * __restrict  C,
+    value_type const * __restrict  A,
+    value_type const * __restrict  B,
+    unsigned m,
+    unsigned n,
+    unsigned k)
+{
+    __shared__ accumulator_type a_tiles[2][TILE_K][TILE_M];
+    __shared__ accumulator_type b_tiles[2][TILE_K][TILE_N];
+
+    unsigned row_base = blockIdx.y * TILE_M;
+    unsigned col_base = blockIdx.x * TILE_N;
+
+    accumulator_type a_staging[a_tile_loads_per_thread];
+    accumulator_type b_staging[b_tile_loads_per_thread];
+    accumulator_type accumulators[THREAD_TILE_M][THREAD_TILE_N] = { };
+
+    fetch_slabs(a_staging, b_staging, A, B, m, n, k, row_base, col_base, 0);
+    store_slabs(a_tiles[0], b_tiles[0], a_staging, b_staging);
+    __syncthreads();
+
+    unsigned num_slabs = (k + TILE_K - 1) / TILE_K;
+    for(unsigned slab = 0; slab < num_slabs; slab++) {
+        unsigned current = slab % 2;
+        bool have_next = (slab + 1 < num_slabs);
+        if (have_next) {
+            fetch_slabs(a_staging, b_staging, A, B, m, n, k, row_base, col_base, (slab + 1) * TILE_K);
+        }
+
+        #pragma unroll
+        for(unsigned kk = 0; kk < TILE_K; kk++) {
+            accumulator_type a_fragment[THREAD_TILE_M];
+            accumulator_type b_fragment[THREAD_TILE_N];
+            #pragma unroll
+            for(unsigned i = 0; i < THREAD_TILE_M; i++) {
+                a_fragment[i] = a_tiles[current][kk][threadIdx.y + i * block_threads_m];
+            }
+            #pragma unroll
+            for(unsigned j = 0; j < THREAD_TILE_N; j++) {
+                b_fragment[j] = b_tiles[current][kk][threadIdx.x + j * block_threads_n];
+            }
+            #pragma unroll
+            for(unsigned i = 0; i < THREAD_TILE_M; i++) {
+                #pragma unroll
+                for(unsigned j = 0; j < THREAD_TILE_N; j++) {
+                    accumulators[i][j] += a_fragment[i] * b_fragment[j];
+                }
+            }
+        }
+
+        if (have_next) {
+            // The other buffer was last read in the previous iteration, before its closing barrier
+            store_slabs(a_tiles[1 - current], b_tiles[1 - current], a_staging, b_staging);
+        }
+        __syncthreads();
+    }
+
+    #pragma unroll
+    for(unsigned i = 0; i < THREAD_TILE_M; i++) {
+        unsigned row = row_base + threadIdx.y + i * block_threads_m;
+        if (row >= m) { continue; }
+        #pragma unroll
+        for(unsigned j = 0; j < THREAD_TILE_N; j++) {
+            unsigned col = col_base + threadIdx.x + j * block_threads_n;
+            if (col < n) {
+                C[(size_t) row * n + col] = value_type(accumulators[i][j]);
+            }
+        }
+    }
+}
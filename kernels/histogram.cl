@@ -0,0 +1,59 @@
+// Counts the number of keys falling into each of NUM_BINS equal-width bins
+// spanning the key range; bin b covers the keys k with k * NUM_BINS >> KEY_BITS == b.
+//
+// Each work-group accumulates into its own private copy of the bins, in local
+// memory, and merges that copy into the global histogram when done. The global
+// histogram is accumulated into, so it must be zeroed before the launch.
+//
+// Unlike the CUDA version, increments are not aggregated across a sub-group
+// before the atomic operation - OpenCL 1.2 offers no portable primitive for
+// finding the work-items with the same bin.
+//
+// Preprocessor definitions (all optional):
+//
+//   KEY_BITS - the key width: 8 or 16 (default: 8)
+//   NUM_BINS - the number of bins: A power of 2, at most 2^KEY_BITS, whose
+//              counters fit in local memory (default: 2^KEY_BITS, but at most 4096)
+//
+// The kernel uses a global-size-stride loop, so any global work size will do.
+
+#ifndef KEY_BITS
+#define KEY_BITS 8
+#endif
+#ifndef NUM_BINS
+#define NUM_BINS ((1 << KEY_BITS) < 4096 ? (1 << KEY_BITS) : 4096)
+#endif
+
+#if KEY_BITS == 8
+typedef uchar key_type;
+#elif KEY_BITS == 16
+typedef ushort key_type;
+#else
+#error "KEY_BITS must be either 8 or 16"
+#endif
+
+__kernel void histogram(
+    __global uint           * restrict bin_counts,
+    __global key_type const * restrict keys,
+    ulong num_keys)
+{
+    __local uint private_bins[NUM_BINS];
+
+    for(uint i = get_local_id(0); i < NUM_BINS; i += get_local_size(0)) {
+        private_bins[i] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(size_t i = get_global_id(0); i < num_keys; i += get_global_size(0)) {
+        uint bin = ((uint) keys[i] * NUM_BINS) >> KEY_BITS;
+        atomic_inc(private_bins + bin);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(uint i = get_local_id(0); i < NUM_BINS; i += get_local_size(0)) {
+        uint count = private_bins[i];
+        if (count > 0) {
+            atomic_add(bin_counts + i, count);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+// Counts the number of keys falling into each of NUM_BINS equal-width bins
+// spanning the key range; bin b covers the keys k with k * NUM_BINS >> KEY_BITS == b.
+//
+// Each block accumulates into its own private copy of the bins, in shared
+// memory, and merges that copy into the global histogram when done. Within a
+// warp, threads whose keys fall into the same bin first combine their
+// increments, so that only one of them performs the atomic addition.
+// The global histogram is accumulated into, so it must be zeroed before
+// the launch.
+//
+// Preprocessor definitions (all optional):
+//
+//   KEY_BITS - the key width: 8 or 16 (default: 8)
+//   NUM_BINS - the number of bins: A power of 2, at most 2^KEY_BITS, whose
+//              counters fit in shared memory (default: 2^KEY_BITS, but at most 4096)
+//
+// The kernel uses a grid-stride loop, so any grid size will do.
+
+#ifndef KEY_BITS
+#define KEY_BITS 8
+#endif
+#ifndef NUM_BINS
+#define NUM_BINS ((1 << KEY_BITS) < 4096 ? (1 << KEY_BITS) : 4096)
+#endif
+
+#if KEY_BITS == 8
+typedef unsigned char key_type;
+#elif KEY_BITS == 16
+typedef unsigned short key_type;
+#else
+#error "KEY_BITS must be either 8 or 16"
+#endif
+typedef unsigned int counter_type;
+
+static_assert(NUM_BINS > 0 and NUM_BINS <= (1 << KEY_BITS), "NUM_BINS must be positive, and no larger than the number of distinct keys");
+static_assert((NUM_BINS & (NUM_BINS - 1)) == 0, "NUM_BINS must be a power of 2");
+
+__device__ __forceinline__ unsigned bin_of(key_type key)
+{
+    return ((unsigned) key * NUM_BINS) >> KEY_BITS;
+}
+
+__device__ __forceinline__ void increment_bin(counter_type* bins, unsigned bin)
+{
+#if __CUDA_ARCH__ >= 700
+    // Warp-aggregated increment: One thread per distinct bin adds the number of peers
+    unsigned peers = __match_any_sync(__activemask(), bin);
+    unsigned lane = threadIdx.x % warpSize;
+    unsigned leader = __ffs(peers) - 1;
+    if (lane == leader) {
+        atomicAdd(bins + bin, __popc(peers));
+    }
+#else
+    atomicAdd(bins + bin, 1);
+#endif
+}
+
+__global__ void histogram(
+    counter_type         * __restrict  bin_counts,
+    key_type       const * __restrict  keys,
+    size_t num_keys)
+{
+    __shared__ counter_type private_bins[NUM_BINS];
+
+    for(unsigned i = threadIdx.x; i < NUM_BINS; i += blockDim.x) {
+        private_bins[i] = 0;
+    }
+    __syncthreads();
+
+    for(size_t i = (size_t) blockIdx.x * blockDim.x + threadIdx.x; i < num_keys; i += (size_t) gridDim.x * blockDim.x) {
+        increment_bin(private_bins, bin_of(keys[i]));
+    }
+    __syncthreads();
+
+    for(unsigned i = threadIdx.x; i < NUM_BINS; i += blockDim.x) {
+        counter_type count = private_bins[i];
+        if (count > 0) {
+            atomicAdd(bin_counts + i, count);
+        }
+    }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file elementwise.cuh
+ *
+ * @brief A templated framework for element-wise "map" kernels over any number
+ * of input buffers, writing a single output buffer.
+ *
+ * The framework takes care of the mechanics which are the same for every
+ * element-wise kernel:
+ *
+ * - Grid-stride iteration, so that any grid size covers any input length
+ *   (and the grid can be sized to fill the device rather than to fit the data);
+ * - Vectorized loads and stores, of up to 16 bytes per buffer per thread
+ *   per iteration;
+ * - Alignment peeling: When all buffers are equally misaligned relative to
+ *   their vectorized element types, a short scalar prologue brings them into
+ *   alignment; when they are not, we fall back to scalar access.
+ *
+ * A kernel using this framework only needs to provide the element-wise
+ * function, e.g.:
+ *
+ *   struct my_op {
+ *       __device__ float operator()(float x, float y) const { return x * y + 1; }
+ *   };
+ *
+ *   __global__ void my_kernel(float* result, const float* x, const float* y, size_t length)
+ *   {
+ *       elementwise::apply(my_op{}, length, result, x, y);
+ *   }
+ *
+ * @note The vectorization width is determined by the largest element type
+ * involved, so that all buffers are traversed with the same number of
+ * elements per vectorized access.
+ */
+#ifndef KERNELS_ELEMENTWISE_CUH_
+#define KERNELS_ELEMENTWISE_CUH_
+
+// Note: Avoiding standard library facilities here, since these are a bit difficult to access with NVRTC.
+
+// Fixed-width integer types, for element types such as int32_t, without needing <cstdint>. They're
+// the same types as the LP64 host's <cstdint> has, so that the two can coexist under NVCC.
+typedef signed char     int8_t;
+typedef unsigned char   uint8_t;
+typedef short           int16_t;
+typedef unsigned short  uint16_t;
+typedef int             int32_t;
+typedef unsigned int    uint32_t;
+typedef long            int64_t;
+typedef unsigned long   uint64_t;
+
+namespace elementwise {
+
+enum : size_t { max_vectorized_access_size = 16 }; // in bytes; the widest load/store a single thread can issue
+
+template <typename T, unsigned N>
+struct alignas(sizeof(T) * N) vector_of {
+    T elements[N];
+};
+
+namespace detail {
+
+template <typename T>
+constexpr size_t max_size_of() { return sizeof(T); }
+
+template <typename T1, typename T2, typename... Ts>
+constexpr size_t max_size_of()
+{
+    return sizeof(T1) > max_size_of<T2, Ts...>() ? sizeof(T1) : max_size_of<T2, Ts...>();
+}
+
+constexpr unsigned largest_power_of_2_not_exceeding(size_t x)
+{
+    return (x < 2) ? 1u : 2u * largest_power_of_2_not_exceeding(x / 2);
+}
+
+enum : size_t { no_common_alignment = ~size_t{0} };
+
+// The number of elements to skip, from the beginning of the buffer, before
+// the vectorized type is properly aligned
+template <unsigned N, typename T>
+__device__ __forceinline__ size_t peel_length(const T* ptr)
+{
+    constexpr const size_t alignment = sizeof(vector_of<T, N>);
+    auto misalignment = reinterpret_cast<size_t>(ptr) % alignment;
+    if (misalignment % sizeof(T) != 0) { return no_common_alignment; }
+    return ((alignment - misalignment) % alignment) / sizeof(T);
+}
+
+template <unsigned N, typename T>
+__device__ __forceinline__ size_t common_peel_length(const T* ptr)
+{
+    return peel_length<N>(ptr);
+}
+
+template <unsigned N, typename T1, typename T2, typename... Ts>
+__device__ __forceinline__ size_t common_peel_length(const T1* ptr, const T2* next_ptr, const Ts*... more_ptrs)
+{
+    auto first = peel_length<N>(ptr);
+    auto rest = common_peel_length<N>(next_ptr, more_ptrs...);
+    return (first == rest) ? first : size_t{no_common_alignment};
+}
+
+__device__ __forceinline__ size_t global_thread_index()
+{
+    return threadIdx.x + static_cast<size_t>(blockIdx.x) * blockDim.x;
+}
+
+__device__ __forceinline__ size_t grid_stride()
+{
+    return static_cast<size_t>(gridDim.x) * blockDim.x;
+}
+
+template <typename F, typename Result, typename... Inputs>
+__device__ __forceinline__ void scalar_grid_stride(
+    const F&                      f,
+    size_t                        start,
+    size_t                        end,
+    Result       * __restrict__   result,
+    const Inputs * __restrict__...inputs)
+{
+    for(size_t i = start + global_thread_index(); i < end; i += grid_stride()) {
+        result[i] = f(inputs[i]...);
+    }
+}
+
+template <unsigned N, typename F, typename Result, typename... Inputs>
+__device__ __forceinline__ vector_of<Result, N> apply_to_vectors(
+    const F& f, const vector_of<Inputs, N>&... input_vectors)
+{
+    vector_of<Result, N> result;
+    #pragma unroll
+    for(unsigned i = 0; i < N; i++) {
+        result.elements[i] = f(input_vectors.elements[i]...);
+    }
+    return result;
+}
+
+template <unsigned N, typename F, typename Result, typename... Inputs>
+__device__ __forceinline__ void vectorized_grid_stride(
+    const F&                      f,
+    size_t                        num_vectors,
+    Result       * __restrict__   result,
+    const Inputs * __restrict__...inputs)
+{
+    auto result_vectors = reinterpret_cast<vector_of<Result, N>*>(result);
+    for(size_t v = global_thread_index(); v < num_vectors; v += grid_stride()) {
+        result_vectors[v] = apply_to_vectors<N, F, Result, Inputs...>(
+            f, reinterpret_cast<const vector_of<Inputs, N>*>(inputs)[v]...);
+    }
+}
+
+} // namespace detail
+
+/**
+ * The number of elements each thread handles per vectorized access, for
+ * a map with the specified output and input element types
+ */
+template <typename Result, typename... Inputs>
+constexpr unsigned vector_width()
+{
+    return detail::largest_power_of_2_not_exceeding(
+        max_vectorized_access_size / detail::max_size_of<Result, Inputs...>());
+}
+
+/**
+ * Apply an element-wise function to the input buffers, writing the results
+ * into the output buffer; i.e. `result[i] = f(inputs[i]...)` for every
+ * `i` in `[0, length)`.
+ *
+ * @note To be called by all threads of the (one-dimensional) grid.
+ */
+template <typename F, typename Result, typename... Inputs>
+__device__ void apply(
+    F                             f,
+    size_t                        length,
+    Result       * __restrict__   result,
+    const Inputs * __restrict__...inputs)
+{
+    constexpr const unsigned N = vector_width<Result, Inputs...>();
+    auto peel = (N == 1) ? size_t{detail::no_common_alignment} : detail::common_peel_length<N>(result, inputs...);
+    if (peel == detail::no_common_alignment) {
+        detail::scalar_grid_stride(f, 0, length, result, inputs...);
+        return;
+    }
+    if (peel > length) { peel = length; }
+    detail::scalar_grid_stride(f, 0, peel, result, inputs...);
+    auto num_vectors = (length - peel) / N;
+    detail::vectorized_grid_stride<N>(f, num_vectors, result + peel, (inputs + peel)...);
+    detail::scalar_grid_stride(f, peel + num_vectors * N, length, result, inputs...);
+}
+
+} // namespace elementwise
+
+#endif // KERNELS_ELEMENTWISE_CUH_
@@ -0,0 +1,62 @@
+#ifndef KERNELS_RECORD_LAYOUT_CUH_
+#define KERNELS_RECORD_LAYOUT_CUH_
+
+// Common definitions for the kernels converting between an array of
+// NUM_COMPONENTS-component records (AoS) and NUM_COMPONENTS arrays, one
+// per component (SoA).
+//
+// Both directions stage a chunk of BLOCK_SIZE records in shared memory, so
+// that the accesses to the record array - which is read or written
+// contiguously - are coalesced, as are the accesses to each of the
+// component arrays.
+//
+// Preprocessor definitions:
+//
+//   NUM_COMPONENTS - the number of components per record: 2, 3 or 4 (required)
+//   ELEMENT_TYPE   - the type of each component (default: float)
+//   BLOCK_SIZE     - the number of threads per block, which is also the number
+//                    of records per chunk (default: 256)
+
+#include <cuda_fp16.h>
+
+#ifndef NUM_COMPONENTS
+#error "NUM_COMPONENTS must be defined"
+#endif
+#ifndef ELEMENT_TYPE
+#define ELEMENT_TYPE float
+#endif
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 256
+#endif
+
+static_assert(NUM_COMPONENTS >= 2 and NUM_COMPONENTS <= 4, "Only 2, 3 or 4 components per record are supported");
+
+typedef ELEMENT_TYPE element_type;
+
+namespace record_layout {
+
+enum : unsigned {
+    num_components = NUM_COMPONENTS,
+    block_size = BLOCK_SIZE,
+    chunk_length = block_size * num_components,
+    num_banks = 32,
+};
+
+// Within a chunk, thread t accesses the elements t * num_components + c, which - for
+// 2 or 4 components - would cause bank conflicts; skipping one position every
+// num_banks elements spreads such accesses over all banks.
+__device__ __forceinline__ constexpr unsigned padded(unsigned index_in_chunk)
+{
+    return index_in_chunk + index_in_chunk / num_banks;
+}
+
+enum : unsigned { padded_chunk_length = chunk_length + chunk_length / num_banks };
+
+__device__ __forceinline__ unsigned records_in_chunk(size_t first_record, size_t num_records)
+{
+    return (num_records - first_record < block_size) ? (unsigned) (num_records - first_record) : (unsigned) block_size;
+}
+
+} // namespace record_layout
+
+#endif // KERNELS_RECORD_LAYOUT_CUH_
@@ -0,0 +1,219 @@
+// A least-significant-digit-first radix sort of 32-bit or 64-bit unsigned keys,
+// optionally carrying 32-bit values along with the keys.
+//
+// The sort makes one pass per 4-bit digit. Each pass consists of three launches,
+// of the three kernels in this file (all built together):
+//
+//   1. radixSortHistogram: Each block counts the occurrences of each digit value
+//      in its tile of the input, writing the counts digit-major - all tiles'
+//      counts of digit value 0, then all tiles' counts of digit value 1 etc.
+//   2. radixSortScan: A single block replaces the counts with their exclusive
+//      prefix sum, which is the position in the output of each tile's first key
+//      with each digit value.
+//   3. radixSortScatter<SortPairs>: Each block writes the keys of its tile (and,
+//      for SortPairs = true, their values) to their positions, ranking keys with
+//      the same digit value in their input order, so the sort is stable.
+//
+// Passes alternate between two pairs of buffers; the sort itself does not place
+// the input in any particular buffer - that's up to whoever launches it.
+//
+// Preprocessor definitions (all optional):
+//
+//   KEY_BITS        - the key width: 32 or 64 (default: 32)
+//   BLOCK_SIZE      - threads per block; a multiple of 32, at most 1024 (default: 256)
+//   KEYS_PER_THREAD - the tile length, in multiples of the block size (default: 8)
+//
+// Histogram and scatter launches need one block per tile; the scan needs a single block.
+// The number of keys must be below 2^32.
+
+#ifndef KEY_BITS
+#define KEY_BITS 32
+#endif
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 256
+#endif
+#ifndef KEYS_PER_THREAD
+#define KEYS_PER_THREAD 8
+#endif
+
+#if KEY_BITS == 32
+typedef unsigned int key_type;
+#elif KEY_BITS == 64
+typedef unsigned long long key_type;
+#else
+#error "KEY_BITS must be either 32 or 64"
+#endif
+typedef unsigned int value_type;
+typedef unsigned int count_type;
+
+enum : unsigned {
+    digit_bits = 4,
+    radix = 1 << digit_bits,
+    warp_size = 32,
+    num_warps = BLOCK_SIZE / warp_size,
+    tile_length = BLOCK_SIZE * KEYS_PER_THREAD,
+    full_warp_mask = 0xFFFFFFFFu,
+};
+
+static_assert(BLOCK_SIZE % warp_size == 0 and BLOCK_SIZE <= 1024, "Unsupported block size");
+static_assert(BLOCK_SIZE >= radix, "Blocks must have at least one thread per digit value");
+
+__device__ __forceinline__ unsigned digit_of(key_type key, unsigned shift)
+{
+    return (unsigned) (key >> shift) & (radix - 1);
+}
+
+__device__ __forceinline__ size_t tile_start() { return (size_t) blockIdx.x * tile_length; }
+
+__device__ __forceinline__ unsigned num_tiles(size_t num_keys)
+{
+    return (unsigned) ((num_keys + tile_length - 1) / tile_length);
+}
+
+__global__ void radixSortHistogram(
+    count_type           * __restrict  digit_counts,
+    key_type       const * __restrict  keys,
+    size_t num_keys,
+    unsigned shift)
+{
+    __shared__ count_type counts[radix];
+    if (threadIdx.x < radix) { counts[threadIdx.x] = 0; }
+    __syncthreads();
+    for(unsigned i = threadIdx.x; i < tile_length; i += BLOCK_SIZE) {
+        size_t pos = tile_start() + i;
+        if (pos < num_keys) {
+            atomicAdd(counts + digit_of(keys[pos], shift), 1);
+        }
+    }
+    __syncthreads();
+    if (threadIdx.x < radix) {
+        digit_counts[threadIdx.x * num_tiles(num_keys) + blockIdx.x] = counts[threadIdx.x];
+    }
+}
+
+// Must be called by all threads of the block
+__device__ count_type block_exclusive_scan(count_type value, count_type& block_total)
+{
+    __shared__ count_type warp_prefixes[num_warps];
+    __shared__ count_type total;
+    unsigned lane = threadIdx.x % warp_size;
+    unsigned warp = threadIdx.x / warp_size;
+
+    count_type inclusive = value;
+    #pragma unroll
+    for(unsigned delta = 1; delta < warp_size; delta *= 2) {
+        count_type other = __shfl_up_sync(full_warp_mask, inclusive, delta);
+        if (lane >= delta) { inclusive += other; }
+    }
+    if (lane == warp_size - 1) { warp_prefixes[warp] = inclusive; }
+    __syncthreads();
+    if (warp == 0) {
+        count_type warp_total = (lane < num_warps) ? warp_prefixes[lane] : 0;
+        count_type scanned = warp_total;
+        #pragma unroll
+        for(unsigned delta = 1; delta < warp_size; delta *= 2) {
+            count_type other = __shfl_up_sync(full_warp_mask, scanned, delta);
+            if (lane >= delta) { scanned += other; }
+        }
+        if (lane < num_warps) { warp_prefixes[lane] = scanned - warp_total; }
+        if (lane == num_warps - 1) { total = scanned; }
+    }
+    __syncthreads();
+    count_type result = warp_prefixes[warp] + inclusive - value;
+    block_total = total;
+    __syncthreads(); // before the shared variables may be overwritten by another call
+    return result;
+}
+
+__global__ void radixSortScan(count_type* digit_counts, size_t num_keys)
+{
+    size_t length = (size_t) radix * num_tiles(num_keys);
+    count_type carry = 0;
+    for(size_t chunk_start = 0; chunk_start < length; chunk_start += BLOCK_SIZE) {
+        size_t pos = chunk_start + threadIdx.x;
+        count_type value = (pos < length) ? digit_counts[pos] : 0;
+        count_type chunk_total;
+        count_type scanned = block_exclusive_scan(value, chunk_total);
+        if (pos < length) { digit_counts[pos] = carry + scanned; }
+        carry += chunk_total;
+    }
+}
+
+// The lanes of the warp whose digit is the same as this lane's. Invalid positions
+// use the out-of-range digit value `radix`, so we need one bit beyond the digit.
+__device__ __forceinline__ unsigned lanes_with_same_digit(unsigned digit)
+{
+    unsigned peers = full_warp_mask;
+    #pragma unroll
+    for(unsigned bit = 0; bit <= digit_bits; bit++) {
+        bool bit_is_set = (digit >> bit) & 1;
+        unsigned lanes_with_bit_set = __ballot_sync(full_warp_mask, bit_is_set);
+        peers &= bit_is_set ? lanes_with_bit_set : ~lanes_with_bit_set;
+    }
+    return peers;
+}
+
+template <bool SortPairs>
+__global__ void radixSortScatter(
+    key_type             * __restrict  keys_out,
+    key_type       const * __restrict  keys_in,
+    value_type           * __restrict  values_out,
+    value_type     const * __restrict  values_in,
+    count_type     const * __restrict  digit_offsets,
+    size_t num_keys,
+    unsigned shift)
+{
+    __shared__ count_type next_position[radix];
+    __shared__ count_type warp_digit_offsets[num_warps][radix];
+    __shared__ count_type round_digit_counts[radix];
+    unsigned lane = threadIdx.x % warp_size;
+    unsigned warp = threadIdx.x / warp_size;
+    unsigned lower_lanes = (1u << lane) - 1;
+
+    if (threadIdx.x < radix) {
+        next_position[threadIdx.x] = digit_offsets[threadIdx.x * num_tiles(num_keys) + blockIdx.x];
+    }
+
+    // Each round ranks BLOCK_SIZE consecutive keys: by warp, then by lane
+    for(unsigned round_start = 0; round_start < tile_length; round_start += BLOCK_SIZE) {
+        size_t pos = tile_start() + round_start + threadIdx.x;
+        bool valid = (pos < num_keys);
+        key_type key = valid ? keys_in[pos] : 0;
+        unsigned digit = valid ? digit_of(key, shift) : radix;
+
+        for(unsigned i = threadIdx.x; i < num_warps * radix; i += BLOCK_SIZE) {
+            (&warp_digit_offsets[0][0])[i] = 0;
+        }
+        __syncthreads();
+
+        unsigned peers = lanes_with_same_digit(digit);
+        unsigned rank_in_warp = __popc(peers & lower_lanes);
+        if (valid and rank_in_warp == 0) {
+            warp_digit_offsets[warp][digit] = __popc(peers);
+        }
+        __syncthreads();
+
+        if (threadIdx.x < radix) {
+            count_type running_count = 0;
+            for(unsigned w = 0; w < num_warps; w++) {
+                count_type warp_count = warp_digit_offsets[w][threadIdx.x];
+                warp_digit_offsets[w][threadIdx.x] = running_count;
+                running_count += warp_count;
+            }
+            round_digit_counts[threadIdx.x] = running_count;
+        }
+        __syncthreads();
+
+        if (valid) {
+            count_type destination = next_position[digit] + warp_digit_offsets[warp][digit] + rank_in_warp;
+            keys_out[destination] = key;
+            if (SortPairs) {
+                values_out[destination] = values_in[pos];
+            }
+        }
+        __syncthreads();
+        if (threadIdx.x < radix) {
+            next_position[threadIdx.x] += round_digit_counts[threadIdx.x];
+        }
+    }
+}
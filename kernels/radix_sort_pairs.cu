@@ -0,0 +1,4 @@
+// A radix sort of key-value pairs, by key; see radix_sort.cu. The same
+// kernels sort keys alone; the adapter chooses the radixSortScatter instantiation.
+
+#include "radix_sort.cu"
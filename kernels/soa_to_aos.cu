@@ -0,0 +1,36 @@
+// Converts a separate array per record component (SoA) into an array of
+// records (AoS): soa[c * num_records + r] is written as component c of record r.
+//
+// See include/record_layout.cuh for the supported preprocessor definitions
+// and the staging scheme. The kernel uses a grid-stride loop over chunks
+// of records, so any grid size will do; the block size must be BLOCK_SIZE.
+
+#include "include/record_layout.cuh"
+
+__global__ void soaToAos(
+    element_type       * __restrict  aos,
+    element_type const * __restrict  soa,
+    size_t num_records)
+{
+    using namespace record_layout;
+    __shared__ element_type staging[padded_chunk_length];
+
+    for(size_t first_record = (size_t) blockIdx.x * block_size;
+        first_record < num_records;
+        first_record += (size_t) gridDim.x * block_size)
+    {
+        unsigned chunk_records = records_in_chunk(first_record, num_records);
+        if (threadIdx.x < chunk_records) {
+            #pragma unroll
+            for(unsigned c = 0; c < num_components; c++) {
+                staging[padded(threadIdx.x * num_components + c)] = soa[c * num_records + first_record + threadIdx.x];
+            }
+        }
+        __syncthreads();
+        element_type * chunk = aos + first_record * num_components;
+        for(unsigned i = threadIdx.x; i < chunk_records * num_components; i += block_size) {
+            chunk[i] = staging[padded(i)];
+        }
+        __syncthreads();
+    }
+}
@@ -0,0 +1,123 @@
+// Sparse matrix-vector multiplication, y = A * x, with the m x n matrix A in
+// Compressed Sparse Row (CSR) format: The non-zero values of row r, and their
+// column indices, are at positions row_offsets[r] ... row_offsets[r+1] - 1 of
+// `values` and `column_indices` respectively.
+//
+// SPMV_VARIANT selects the work distribution:
+//
+//   scalar_rows - one thread per row; simple, but suffers with long rows and
+//                 uncoalesced accesses
+//   vector_rows - VECTOR_WIDTH consecutive threads (part of a warp) per row,
+//                 reducing with shuffles; coalesced, but imbalanced for irregular rows
+//   merge_path  - each thread gets an equal share of the merged sequence of row
+//                 ends and non-zeros (Merrill & Garland, 2016), so long rows are split
+//                 across threads - whose partial sums are combined with atomic
+//                 additions; y must therefore be zeroed before the launch.
+//
+// Preprocessor definitions:
+//
+//   SPMV_VARIANT     - scalar_rows, vector_rows or merge_path (default: scalar_rows)
+//   VECTOR_WIDTH     - threads per row for vector_rows; a power of 2, at most 32 (default: 32)
+//   ITEMS_PER_THREAD - merge-path items (row ends plus non-zeros) per thread (default: 7)
+//
+// The scalar and vector variants use grid-stride loops over the rows, so any
+// grid will do; the merge-path variant needs ceil((m + nnz) / ITEMS_PER_THREAD) threads.
+
+#define scalar_rows 1
+#define vector_rows 2
+#define merge_path  3
+
+#ifndef SPMV_VARIANT
+#define SPMV_VARIANT scalar_rows
+#endif
+#ifndef VECTOR_WIDTH
+#define VECTOR_WIDTH 32
+#endif
+#ifndef ITEMS_PER_THREAD
+#define ITEMS_PER_THREAD 7
+#endif
+
+typedef unsigned int index_type;
+
+static_assert(VECTOR_WIDTH > 0 and VECTOR_WIDTH <= 32 and (VECTOR_WIDTH & (VECTOR_WIDTH - 1)) == 0,
+    "VECTOR_WIDTH must be a power of 2, at most 32");
+
+__device__ __forceinline__ size_t global_thread_index() { return (size_t) blockIdx.x * blockDim.x + threadIdx.x; }
+__device__ __forceinline__ size_t num_grid_threads() { return (size_t) gridDim.x * blockDim.x; }
+
+__global__ void spmvCsr(
+    float            * __restrict  y,
+    index_type const * __restrict  row_offsets,
+    index_type const * __restrict  column_indices,
+    float      const * __restrict  values,
+    float      const * __restrict  x,
+    index_type num_rows,
+    index_type num_nonzeros)
+{
+#if SPMV_VARIANT == scalar_rows
+    for(size_t row = global_thread_index(); row < num_rows; row += num_grid_threads()) {
+        float sum = 0;
+        for(index_type i = row_offsets[row]; i < row_offsets[row + 1]; i++) {
+            sum += values[i] * __ldg(x + column_indices[i]);
+        }
+        y[row] = sum;
+    }
+#elif SPMV_VARIANT == vector_rows
+    const unsigned lane_in_row = threadIdx.x % VECTOR_WIDTH;
+    const size_t num_row_groups = num_grid_threads() / VECTOR_WIDTH;
+    // The loop trip count is uniform across each group of VECTOR_WIDTH lanes, as the shuffles require
+    for(size_t row = global_thread_index() / VECTOR_WIDTH; row < num_rows; row += num_row_groups) {
+        float sum = 0;
+        for(index_type i = row_offsets[row] + lane_in_row; i < row_offsets[row + 1]; i += VECTOR_WIDTH) {
+            sum += values[i] * __ldg(x + column_indices[i]);
+        }
+        #pragma unroll
+        for(unsigned offset = VECTOR_WIDTH / 2; offset > 0; offset /= 2) {
+            sum += __shfl_down_sync(__activemask(), sum, offset, VECTOR_WIDTH);
+        }
+        if (lane_in_row == 0) { y[row] = sum; }
+    }
+#elif SPMV_VARIANT == merge_path
+    // We merge the sequence of row end offsets with the sequence of non-zero indices 0, 1, 2, ...;
+    // the thread's starting point is where its diagonal crosses the merge path.
+    const size_t diagonal = global_thread_index() * ITEMS_PER_THREAD;
+    if (diagonal >= (size_t) num_rows + num_nonzeros) { return; }
+    const index_type* row_ends = row_offsets + 1;
+    size_t lower = (diagonal > num_nonzeros) ? diagonal - num_nonzeros : 0;
+    size_t upper = (diagonal < num_rows) ? diagonal : num_rows;
+    while (lower < upper) {
+        size_t middle = (lower + upper) / 2;
+        if (row_ends[middle] <= diagonal - middle - 1) { lower = middle + 1; }
+        else { upper = middle; }
+    }
+    index_type row = lower;
+    index_type nonzero = diagonal - lower;
+
+    // Only the thread starting at the very beginning of a row can be sure
+    // no other thread contributes to it.
+    bool row_is_exclusive = (row_offsets[row] == nonzero);
+    bool have_partial_sum = false;
+    float sum = 0;
+    for(unsigned item = 0; item < ITEMS_PER_THREAD and row < num_rows; item++) {
+        if (nonzero < row_ends[row]) {
+            sum += values[nonzero] * __ldg(x + column_indices[nonzero]);
+            have_partial_sum = true;
+            nonzero++;
+        }
+        else {
+            if (row_is_exclusive) { y[row] = sum; }
+            else { atomicAdd(y + row, sum); }
+            sum = 0;
+            have_partial_sum = false;
+            row_is_exclusive = true;
+            row++;
+        }
+    }
+    if (have_partial_sum and row < num_rows) {
+        // The row continues into the next thread's share
+        atomicAdd(y + row, sum);
+    }
+#else
+#error "Unsupported SPMV_VARIANT"
+#endif
+}
@@ -0,0 +1,171 @@
+// Jacobi-style stencil iterations over a regular 2D or 3D grid of floats; see
+// stencil.cu for a description of the scheme, and of the preprocessor
+// definitions and launch grid - which are the same here, with work-groups
+// in place of blocks.
+
+#ifndef STENCIL_POINTS
+#define STENCIL_POINTS 5
+#endif
+#ifndef BLOCK_X
+#define BLOCK_X 32
+#endif
+#ifndef BLOCK_Y
+#define BLOCK_Y 8
+#endif
+#ifndef CELLS_PER_THREAD
+#define CELLS_PER_THREAD 8
+#endif
+
+#if STENCIL_POINTS == 5
+#define STENCIL_DIMENSIONS 2
+#elif STENCIL_POINTS == 7 || STENCIL_POINTS == 27
+#define STENCIL_DIMENSIONS 3
+#else
+#error "STENCIL_POINTS must be 5, 7 or 27"
+#endif
+
+#define STENCIL_WEIGHT (1.0f / STENCIL_POINTS)
+
+typedef struct {
+    float center;
+    float in_plane;
+    float across;
+} plane_terms;
+
+inline int clamped(int i, uint n)
+{
+    return min(max(i, 0), (int) n - 1);
+}
+
+#if STENCIL_DIMENSIONS == 2
+#define CELL_INDEX(x_, y_, m) ((size_t) (m) * nx + (x_))
+#else
+#define CELL_INDEX(x_, y_, m) (((size_t) (m) * ny + (y_)) * nx + (x_))
+#endif
+
+// Expects LOAD(dx, dy) to be defined as the value of the cell at an offset within the plane
+#if STENCIL_POINTS == 5
+#define MAKE_TERMS(terms) \
+    terms.center = LOAD(0, 0); \
+    terms.in_plane = LOAD(-1, 0) + terms.center + LOAD(1, 0); \
+    terms.across = terms.center;
+#elif STENCIL_POINTS == 7
+#define MAKE_TERMS(terms) \
+    terms.center = LOAD(0, 0); \
+    terms.in_plane = terms.center + LOAD(-1, 0) + LOAD(1, 0) + LOAD(0, -1) + LOAD(0, 1); \
+    terms.across = terms.center;
+#else
+#define MAKE_TERMS(terms) \
+    terms.center = LOAD(0, 0); \
+    terms.in_plane = 0; \
+    for(int dy = -1; dy <= 1; dy++) { \
+        for(int dx = -1; dx <= 1; dx++) { \
+            terms.in_plane += LOAD(dx, dy); \
+        } \
+    } \
+    terms.across = terms.in_plane;
+#endif
+
+#ifdef STENCIL_USE_SHARED_MEMORY
+#if STENCIL_DIMENSIONS == 2
+#define TILE_ROWS BLOCK_Y
+#define LOAD(dx, dy) tile[get_local_id(1)][get_local_id(0) + 1 + (dx)]
+#else
+#define TILE_ROWS (BLOCK_Y + 2)
+#define LOAD(dx, dy) tile[get_local_id(1) + 1 + (dy)][get_local_id(0) + 1 + (dx)]
+#endif
+
+// Must be called by all work-items of the work-group
+plane_terms terms_at(
+    __local float (*tile)[BLOCK_X + 2],
+    __global float const * restrict grid,
+    int x, int m, uint nx, uint ny, uint march_length)
+{
+    int clamped_m = clamped(m, march_length);
+    barrier(CLK_LOCAL_MEM_FENCE); // The previous plane's tile is no longer in use
+#if STENCIL_DIMENSIONS == 2
+    // Each row of work-items marches over different rows of the grid, so it has its own tile row
+    const uint lx = get_local_id(0);
+    const uint ly = get_local_id(1);
+    tile[ly][lx + 1] = grid[CELL_INDEX(clamped(x, nx), 0, clamped_m)];
+    if (lx == 0) {
+        tile[ly][0] = grid[CELL_INDEX(clamped(x - 1, nx), 0, clamped_m)];
+    }
+    if (lx == BLOCK_X - 1) {
+        tile[ly][BLOCK_X + 1] = grid[CELL_INDEX(clamped(x + 1, nx), 0, clamped_m)];
+    }
+#else
+    for(uint i = get_local_id(1) * BLOCK_X + get_local_id(0); i < (BLOCK_Y + 2) * (BLOCK_X + 2); i += BLOCK_X * BLOCK_Y) {
+        int tile_y = i / (BLOCK_X + 2);
+        int tile_x = i % (BLOCK_X + 2);
+        int grid_x = clamped(get_group_id(0) * BLOCK_X + tile_x - 1, nx);
+        int grid_y = clamped(get_group_id(1) * BLOCK_Y + tile_y - 1, ny);
+        tile[tile_y][tile_x] = grid[CELL_INDEX(grid_x, grid_y, clamped_m)];
+    }
+#endif
+    barrier(CLK_LOCAL_MEM_FENCE);
+    plane_terms terms;
+    MAKE_TERMS(terms)
+    return terms;
+}
+#define TERMS_AT(m) terms_at(tile, grid, x, (m), nx, ny, march_length)
+
+#else // STENCIL_USE_SHARED_MEMORY
+
+#define LOAD(dx, dy) grid[CELL_INDEX(clamped(x + (dx), nx), clamped(y + (dy), ny), clamped_m)]
+
+plane_terms terms_at(
+    __global float const * restrict grid,
+    int x, int y, int m, uint nx, uint ny, uint march_length)
+{
+    int clamped_m = clamped(m, march_length);
+    plane_terms terms;
+    MAKE_TERMS(terms)
+    return terms;
+}
+#define TERMS_AT(m) terms_at(grid, x, y, (m), nx, ny, march_length)
+
+#endif // STENCIL_USE_SHARED_MEMORY
+
+__kernel void stencil(
+    __global float       * restrict result,
+    __global float const * restrict grid,
+    uint nx,
+    uint ny,
+    uint nz)
+{
+    const int x = get_global_id(0);
+#if STENCIL_DIMENSIONS == 2
+    const int y = 0; // Planes are rows, so we only have an in-plane x coordinate
+    const uint march_length = ny;
+    const int march_start = get_global_id(1) * CELLS_PER_THREAD;
+    const bool within_plane = (x < nx);
+    const bool on_plane_boundary = (x == 0 || x == nx - 1);
+#else
+    const int y = get_global_id(1);
+    const uint march_length = nz;
+    const int march_start = get_group_id(2) * CELLS_PER_THREAD;
+    const bool within_plane = (x < nx && y < ny);
+    const bool on_plane_boundary = (x == 0 || x == nx - 1 || y == 0 || y == ny - 1);
+#endif
+#ifdef STENCIL_USE_SHARED_MEMORY
+    __local float tile[TILE_ROWS][BLOCK_X + 2];
+#endif
+
+    // Note: All work-items march through the same number of planes, even if out of range, so that
+    // the local memory variant's barriers are safe
+    plane_terms previous = TERMS_AT(march_start - 1);
+    plane_terms current = TERMS_AT(march_start);
+    for(int i = 0; i < CELLS_PER_THREAD; i++) {
+        int m = march_start + i;
+        plane_terms next = TERMS_AT(m + 1);
+        if (within_plane && m < march_length) {
+            bool on_boundary = on_plane_boundary || m == 0 || m == march_length - 1;
+            result[CELL_INDEX(x, y, m)] = on_boundary ?
+                current.center :
+                STENCIL_WEIGHT * (previous.across + current.in_plane + next.across);
+        }
+        previous = current;
+        current = next;
+    }
+}
@@ -0,0 +1,172 @@
+// Jacobi-style stencil iterations over a regular 2D or 3D grid of floats: Each
+// interior cell's new value is the average of the STENCIL_POINTS cells in its
+// neighborhood; boundary cells keep their values. The grid is stored with x
+// varying fastest, then y, then z.
+//
+// Each thread computes CELLS_PER_THREAD consecutive cells along the last grid
+// dimension (y for 2D, z for 3D), marching through the grid "planes" (rows for
+// 2D) along it. A cell's neighborhood is split into per-plane terms, kept in
+// registers and reused as the march proceeds, so each plane's neighborhood
+// values are only gathered once per thread. They are gathered either directly
+// from global memory, or - with STENCIL_USE_SHARED_MEMORY - from a tile of the
+// plane, including a halo, which the block first stages in shared memory.
+//
+// Preprocessor definitions:
+//
+//   STENCIL_POINTS            - 5 (2D), 7 or 27 (3D) (default: 5)
+//   STENCIL_USE_SHARED_MEMORY - (valueless) stage plane tiles in shared memory
+//   BLOCK_X, BLOCK_Y          - the block dimensions (default: 32 x 8)
+//   CELLS_PER_THREAD          - cells computed by each thread (default: 8)
+//
+// The launch grid must be ceil(nx / BLOCK_X) x ceil(ny / (BLOCK_Y * CELLS_PER_THREAD))
+// blocks for 2D, or ceil(nx / BLOCK_X) x ceil(ny / BLOCK_Y) x ceil(nz / CELLS_PER_THREAD)
+// blocks for 3D.
+
+#ifndef STENCIL_POINTS
+#define STENCIL_POINTS 5
+#endif
+#ifndef BLOCK_X
+#define BLOCK_X 32
+#endif
+#ifndef BLOCK_Y
+#define BLOCK_Y 8
+#endif
+#ifndef CELLS_PER_THREAD
+#define CELLS_PER_THREAD 8
+#endif
+
+#if STENCIL_POINTS == 5
+#define STENCIL_DIMENSIONS 2
+#elif STENCIL_POINTS == 7 || STENCIL_POINTS == 27
+#define STENCIL_DIMENSIONS 3
+#else
+#error "STENCIL_POINTS must be 5, 7 or 27"
+#endif
+
+#define STENCIL_WEIGHT (1.0f / STENCIL_POINTS)
+
+// A cell's contributions to the new values of cells in its own plane, and in the planes
+// before and after it. The new value is then the weighted sum of the previous cell's
+// `across`, this cell's `in_plane` and the next cell's `across`.
+struct plane_terms {
+    float center;
+    float in_plane;
+    float across;
+};
+
+__device__ __forceinline__ int clamped(int i, unsigned n)
+{
+    return min(max(i, 0), (int) n - 1);
+}
+
+// `load(dx, dy)` must return the value of the cell at an offset within the plane
+template <typename Load>
+__device__ __forceinline__ plane_terms make_terms(Load load)
+{
+    plane_terms terms;
+    terms.center = load(0, 0);
+#if STENCIL_POINTS == 5
+    terms.in_plane = load(-1, 0) + terms.center + load(1, 0);
+    terms.across = terms.center;
+#elif STENCIL_POINTS == 7
+    terms.in_plane = terms.center + load(-1, 0) + load(1, 0) + load(0, -1) + load(0, 1);
+    terms.across = terms.center;
+#else
+    float neighborhood_sum = 0;
+    #pragma unroll
+    for(int dy = -1; dy <= 1; dy++) {
+        #pragma unroll
+        for(int dx = -1; dx <= 1; dx++) {
+            neighborhood_sum += load(dx, dy);
+        }
+    }
+    terms.in_plane = neighborhood_sum;
+    terms.across = neighborhood_sum;
+#endif
+    return terms;
+}
+
+__global__ void stencil(
+    float       * __restrict  result,
+    float const * __restrict  grid,
+    unsigned nx,
+    unsigned ny,
+    unsigned nz)
+{
+    const int x = blockIdx.x * BLOCK_X + threadIdx.x;
+#if STENCIL_DIMENSIONS == 2
+    const int y = 0; // Planes are rows, so we only have an in-plane x coordinate
+    const unsigned march_length = ny;
+    const int march_start = (blockIdx.y * BLOCK_Y + threadIdx.y) * CELLS_PER_THREAD;
+    const bool within_plane = (x < nx);
+    const bool on_plane_boundary = (x == 0 or x == nx - 1);
+    auto cell_index = [&](int x_, int, int m) { return (size_t) m * nx + x_; };
+#else
+    const int y = blockIdx.y * BLOCK_Y + threadIdx.y;
+    const unsigned march_length = nz;
+    const int march_start = blockIdx.z * CELLS_PER_THREAD;
+    const bool within_plane = (x < nx and y < ny);
+    const bool on_plane_boundary = (x == 0 or x == nx - 1 or y == 0 or y == ny - 1);
+    auto cell_index = [&](int x_, int y_, int m) { return ((size_t) m * ny + y_) * nx + x_; };
+#endif
+
+#ifdef STENCIL_USE_SHARED_MEMORY
+#if STENCIL_DIMENSIONS == 2
+    // Each row of threads marches over different rows of the grid, so it has its own tile row
+    __shared__ float tile[BLOCK_Y][BLOCK_X + 2];
+    auto terms_at = [&](int m) {
+        int clamped_m = clamped(m, march_length);
+        __syncthreads(); // The previous plane's tile is no longer in use
+        tile[threadIdx.y][threadIdx.x + 1] = grid[cell_index(clamped(x, nx), 0, clamped_m)];
+        if (threadIdx.x == 0) {
+            tile[threadIdx.y][0] = grid[cell_index(clamped(x - 1, nx), 0, clamped_m)];
+        }
+        if (threadIdx.x == BLOCK_X - 1) {
+            tile[threadIdx.y][BLOCK_X + 1] = grid[cell_index(clamped(x + 1, nx), 0, clamped_m)];
+        }
+        __syncthreads();
+        return make_terms([&](int dx, int) { return tile[threadIdx.y][threadIdx.x + 1 + dx]; });
+    };
+#else
+    __shared__ float tile[BLOCK_Y + 2][BLOCK_X + 2];
+    auto terms_at = [&](int m) {
+        int clamped_m = clamped(m, march_length);
+        __syncthreads(); // The previous plane's tile is no longer in use
+        for(unsigned i = threadIdx.y * BLOCK_X + threadIdx.x; i < (BLOCK_Y + 2) * (BLOCK_X + 2); i += BLOCK_X * BLOCK_Y) {
+            int tile_y = i / (BLOCK_X + 2);
+            int tile_x = i % (BLOCK_X + 2);
+            int grid_x = clamped(blockIdx.x * BLOCK_X + tile_x - 1, nx);
+            int grid_y = clamped(blockIdx.y * BLOCK_Y + tile_y - 1, ny);
+            tile[tile_y][tile_x] = grid[cell_index(grid_x, grid_y, clamped_m)];
+        }
+        __syncthreads();
+        return make_terms([&](int dx, int dy) { return tile[threadIdx.y + 1 + dy][threadIdx.x + 1 + dx]; });
+    };
+#endif
+#else
+    auto terms_at = [&](int m) {
+        int clamped_m = clamped(m, march_length);
+        return make_terms([&](int dx, int dy) {
+            return grid[cell_index(clamped(x + dx, nx), clamped(y + dy, ny), clamped_m)];
+        });
+    };
+#endif
+
+    // Note: All threads march through the same number of planes, even if out of range, so that
+    // the shared memory variant's block synchronization is safe
+    plane_terms previous = terms_at(march_start - 1);
+    plane_terms current = terms_at(march_start);
+    #pragma unroll
+    for(int i = 0; i < CELLS_PER_THREAD; i++) {
+        int m = march_start + i;
+        plane_terms next = terms_at(m + 1);
+        if (within_plane and m < march_length) {
+            bool on_boundary = on_plane_boundary or m == 0 or m == march_length - 1;
+            result[cell_index(x, y, m)] = on_boundary ?
+                current.center :
+                STENCIL_WEIGHT * (previous.across + current.in_plane + next.across);
+        }
+        previous = current;
+        current = next;
+    }
+}
@@ -0,0 +1,61 @@
+// Transposes a rows x cols row-major matrix into a cols x rows row-major matrix.
+//
+// Each block transposes a TILE_DIM x TILE_DIM tile through shared memory, so
+// that both the reads and the writes of global memory are coalesced. The
+// shared tile has an extra column: Without it, the threads of a warp reading
+// a tile column would all hit the same bank.
+//
+// Preprocessor definitions (all optional):
+//
+//   ELEMENT_TYPE - the matrix element type (default: float)
+//   TILE_DIM     - the side of the square tile transposed by each block (default: 32)
+//   BLOCK_ROWS   - the number of tile rows covered by the block at once; must
+//                  divide TILE_DIM (default: 8)
+//
+// The launch grid must be ceil(cols / TILE_DIM) x ceil(rows / TILE_DIM) blocks,
+// each of TILE_DIM x BLOCK_ROWS threads.
+
+#include <cuda_fp16.h>
+
+#ifndef ELEMENT_TYPE
+#define ELEMENT_TYPE float
+#endif
+#ifndef TILE_DIM
+#define TILE_DIM 32
+#endif
+#ifndef BLOCK_ROWS
+#define BLOCK_ROWS 8
+#endif
+
+static_assert(TILE_DIM % BLOCK_ROWS == 0, "BLOCK_ROWS must divide TILE_DIM");
+
+typedef ELEMENT_TYPE element_type;
+
+__global__ void transpose(
+    element_type       * __restrict  transposed,
+    element_type const * __restrict  matrix,
+    unsigned rows,
+    unsigned cols)
+{
+    __shared__ element_type tile[TILE_DIM][TILE_DIM + 1];
+
+    unsigned col = blockIdx.x * TILE_DIM + threadIdx.x;
+    unsigned row = blockIdx.y * TILE_DIM + threadIdx.y;
+    #pragma unroll
+    for(unsigned j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        if (col < cols and row + j < rows) {
+            tile[threadIdx.y + j][threadIdx.x] = matrix[(size_t) (row + j) * cols + col];
+        }
+    }
+    __syncthreads();
+
+    // In the transposed matrix, this block's tile is at the mirrored position
+    unsigned transposed_col = blockIdx.y * TILE_DIM + threadIdx.x;
+    unsigned transposed_row = blockIdx.x * TILE_DIM + threadIdx.y;
+    #pragma unroll
+    for(unsigned j = 0; j < TILE_DIM; j += BLOCK_ROWS) {
+        if (transposed_col < rows and transposed_row + j < cols) {
+            transposed[(size_t) (transposed_row + j) * rows + transposed_col] = tile[threadIdx.x][threadIdx.y + j];
+        }
+    }
+}
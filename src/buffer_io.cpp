@@ -1,6 +1,15 @@
 #include <buffer_io.hpp>
 #include <spdlog/spdlog.h>
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
 
 void verify_path(const filesystem::path& path, path_check_kind check_kind, bool allow_overwrite)
 {
@@ -58,6 +67,40 @@ host_buffer_type read_input_file(const filesystem::path& src, size_t extra_buffe
     }
 }
 
+host_buffer_type read_input_file(const filesystem::path& src, const element_conversion_t& conversion, unsigned num_threads)
+{
+    // A multiple of any element size
+    constexpr const std::size_t chunk_size { 64 * 1024 * 1024 };
+
+    verify_input_path(src);
+    auto file_size = filesystem::file_size(src);
+    if (file_size % element_size(conversion.from) != 0) {
+        throw std::invalid_argument("Size of file " + src.native() + " is not a multiple of the size of its "
+            + element_type_name(conversion.from) + " elements");
+    }
+    host_buffer_type result(conversion.converted_size(file_size));
+    host_buffer_type staging(std::min<std::size_t>(file_size, chunk_size));
+    std::ifstream file(src, std::ios::binary);
+    try {
+        file.exceptions(std::ios::failbit | std::ios::badbit);
+        for(std::size_t offset = 0; offset < file_size; offset += chunk_size) {
+            auto size = std::min<std::size_t>(chunk_size, file_size - offset);
+            file.read(staging.data(), (std::streamsize) size);
+            convert_elements(conversion,
+                poor_mans_span{ staging.data(), size },
+                poor_mans_span{ result.data() + conversion.converted_size(offset), conversion.converted_size(size) },
+                num_threads);
+        }
+        return result;
+    } catch (std::ios_base::failure& ios_failure) {
+        if (errno == 0) {
+            throw ios_failure;
+        }
+        throw std::system_error(errno, std::generic_category(),
+            "trying to read " + std::to_string(file_size) + " from file " + src.native());
+    }
+}
+
 host_buffer_type read_file_as_null_terminated_string(const filesystem::path& source)
 {
     size_t add_one_extra_byte { 1 };
@@ -100,3 +143,242 @@ void write_buffer_to_file(
         poor_mans_span{const_cast<byte_type*>(buffer.data()), buffer.size()},
         destination, overwrite_allowed, spdlog::level::debug);
 }
+
+std::size_t read_fully(int file_descriptor, poor_mans_span destination)
+{
+    std::size_t total_read { 0 };
+    while (total_read < destination.size()) {
+        auto num_read = ::read(file_descriptor, destination.data() + total_read, destination.size() - total_read);
+        if (num_read == 0) { break; }
+        if (num_read < 0) {
+            if (errno == EINTR) { continue; }
+            throw std::system_error(errno, std::generic_category(),
+                "reading from file descriptor " + std::to_string(file_descriptor));
+        }
+        total_read += (std::size_t) num_read;
+    }
+    return total_read;
+}
+
+void write_fully(int file_descriptor, poor_mans_span source)
+{
+    std::size_t total_written { 0 };
+    while (total_written < source.size()) {
+        auto num_written = ::write(file_descriptor, source.data() + total_written, source.size() - total_written);
+        if (num_written < 0) {
+            if (errno == EINTR) { continue; }
+            throw std::system_error(errno, std::generic_category(),
+                "writing to file descriptor " + std::to_string(file_descriptor));
+        }
+        total_written += (std::size_t) num_written;
+    }
+}
+
+namespace {
+
+constexpr const char shm_prefix[] = "shm:";
+constexpr const char fd_prefix[] = "fd:";
+
+bool has_prefix(const std::string& s, const char* prefix)
+{
+    return s.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+// Returns a file descriptor which the caller must close
+int open_shared_buffer(const std::string& buffer_spec, path_check_kind check_kind)
+{
+    bool writing = (check_kind == for_writing);
+    if (has_prefix(buffer_spec, fd_prefix)) {
+        auto inherited_fd = std::stoi(buffer_spec.substr(std::strlen(fd_prefix)));
+        // Duplicated, so that the inherited descriptor remains usable by whoever else holds it
+        int fd = ::dup(inherited_fd);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "using file descriptor of buffer " + buffer_spec);
+        }
+        return fd;
+    }
+    auto name = buffer_spec.substr(std::strlen(shm_prefix));
+    if (name.empty() or name.front() != '/') { name.insert(0, 1, '/'); }
+    int fd = writing ? ::shm_open(name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR) : ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "opening shared-memory object " + name);
+    }
+    return fd;
+}
+
+} // namespace
+
+bool is_shared_buffer_spec(const std::string& buffer_spec)
+{
+    return has_prefix(buffer_spec, shm_prefix) or has_prefix(buffer_spec, fd_prefix);
+}
+
+bool is_compressed_buffer_file(const filesystem::path& path)
+{
+    return path.extension() == ".lz4";
+}
+
+mapped_shared_buffer::mapped_shared_buffer(
+    const std::string& buffer_spec,
+    path_check_kind    check_kind,
+    std::size_t        size_for_writing)
+    : spec_(buffer_spec), fd_(open_shared_buffer(buffer_spec, check_kind))
+{
+    bool writing = (check_kind == for_writing);
+    std::size_t size { size_for_writing };
+    if (not writing) {
+        struct stat status;
+        if (::fstat(fd_, &status) != 0) {
+            auto error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), "obtaining the size of shared buffer " + buffer_spec);
+        }
+        size = (std::size_t) status.st_size;
+    }
+    map(size, writing);
+}
+
+mapped_shared_buffer::mapped_shared_buffer(const filesystem::path& output_file, std::size_t size)
+    : spec_(output_file.native()), fd_(::open(output_file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644))
+{
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "opening output file " + spec_);
+    }
+    map(size, true);
+}
+
+void mapped_shared_buffer::map(std::size_t size, bool writing)
+{
+    if (writing and ::ftruncate(fd_, (off_t) size) != 0) {
+        auto error = errno;
+        ::close(fd_);
+        throw std::system_error(error, std::generic_category(), "resizing " + spec_);
+    }
+    if (size > 0) {
+        auto protection = writing ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* mapped = ::mmap(nullptr, size, protection, MAP_SHARED, fd_, 0);
+        if (mapped == MAP_FAILED) {
+            auto error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), "mapping " + spec_);
+        }
+        span_ = poor_mans_span{ static_cast<byte_type*>(mapped), size };
+    }
+    spdlog::debug("Mapped {} for {}: {} bytes at {}", spec_, writing ? "writing" : "reading", size, (void*) span_.data());
+}
+
+void mapped_shared_buffer::sync(bool including_metadata) const
+{
+    if (span_.data() != nullptr and ::msync(span_.data(), span_.size(), MS_SYNC) != 0) {
+        throw std::system_error(errno, std::generic_category(), "synchronizing the mapping of " + spec_);
+    }
+    if (including_metadata and ::fsync(fd_) != 0) {
+        throw std::system_error(errno, std::generic_category(), "synchronizing " + spec_);
+    }
+}
+
+mapped_shared_buffer::~mapped_shared_buffer()
+{
+    if (span_.data() != nullptr) {
+        if (unmap_hook_) { unmap_hook_(span_); }
+        ::munmap(span_.data(), span_.size());
+    }
+    ::close(fd_);
+}
+
+asynchronous_file_writer::asynchronous_file_writer() : thread_([this]() { work(); }) { }
+
+asynchronous_file_writer::~asynchronous_file_writer()
+{
+    if (not thread_.joinable()) { return; }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishing_ = true;
+    }
+    state_changed_.notify_all();
+    thread_.join();
+}
+
+void asynchronous_file_writer::enqueue(task_t task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    state_changed_.notify_all();
+}
+
+void asynchronous_file_writer::open(const std::string& buffer_name, const filesystem::path& destination, bool overwrite_allowed)
+{
+    verify_path(destination, for_writing, overwrite_allowed);
+    enqueue(task_t{ task_t::open, buffer_name, destination, poor_mans_span{ nullptr, 0 } });
+}
+
+void asynchronous_file_writer::append(poor_mans_span chunk)
+{
+    enqueue(task_t{ task_t::append, {}, {}, chunk });
+}
+
+void asynchronous_file_writer::close()
+{
+    enqueue(task_t{ task_t::close, {}, {}, poor_mans_span{ nullptr, 0 } });
+}
+
+void asynchronous_file_writer::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishing_ = true;
+    }
+    state_changed_.notify_all();
+    thread_.join();
+    if (failure_) { std::rethrow_exception(failure_); }
+}
+
+void asynchronous_file_writer::work()
+{
+    int fd { -1 };
+    std::string buffer_name;
+    filesystem::path destination;
+    while (true) {
+        task_t task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            state_changed_.wait(lock, [&]() { return finishing_ or not tasks_.empty(); });
+            if (tasks_.empty()) { break; }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        if (failure_) { continue; } // Only the first failure is reported; later tasks are moot
+        try {
+            switch(task.kind) {
+            case task_t::open:
+                buffer_name = std::move(task.buffer_name);
+                destination = std::move(task.destination);
+                spdlog::debug("Writing output buffer '{}' to file {}", buffer_name, destination.c_str());
+                fd = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0) {
+                    throw std::system_error(errno, std::generic_category(),
+                        "opening file " + destination.native() + " for output buffer '" + buffer_name + "'");
+                }
+                break;
+            case task_t::append:
+                write_fully(fd, task.chunk);
+                break;
+            case task_t::close:
+                if (::close(fd) != 0) {
+                    fd = -1;
+                    throw std::system_error(errno, std::generic_category(),
+                        "closing file " + destination.native() + " of output buffer '" + buffer_name + "'");
+                }
+                fd = -1;
+                break;
+            }
+        }
+        catch(...) {
+            failure_ = std::current_exception();
+            if (fd >= 0) { ::close(fd); fd = -1; }
+        }
+    }
+    if (fd >= 0) { ::close(fd); }
+}
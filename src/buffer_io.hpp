@@ -2,11 +2,21 @@
 #define BUFFER_IO_HPP_
 
 #include <common_types.hpp>
+#include <element_conversion.hpp>
 #include <spdlog/common.h>
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+
 
 void verify_path(const filesystem::path& path, path_check_kind check_kind, bool allow_overwrite);
 host_buffer_type read_input_file(const filesystem::path& src, size_t extra_buffer_size = 0);
+// Reads the file in chunks, converting each chunk's elements as soon as it has been read
+host_buffer_type read_input_file(const filesystem::path& src, const element_conversion_t& conversion, unsigned num_threads);
 host_buffer_type read_file_as_null_terminated_string(const filesystem::path& source);
 void write_data_to_file(
     std::string kind,
@@ -21,6 +31,90 @@ void write_buffer_to_file(
     filesystem::path destination,
     bool overwrite_allowed);
 
+// For pipes and other file descriptors which may deliver or accept less than requested at a time:
+// Reads until the destination is full or the input has ended, returning the number of bytes read
+std::size_t read_fully(int file_descriptor, poor_mans_span destination);
+void write_fully(int file_descriptor, poor_mans_span source);
+
+/**
+ * Buffers can also be exchanged with other processes without going through the filesystem:
+ * Instead of a file path, specify either shm:NAME, for a POSIX shared-memory object, or fd:N,
+ * for an open file descriptor inherited from the parent process (e.g. of a memfd).
+ */
+bool is_shared_buffer_spec(const std::string& buffer_spec);
+
+// Buffer files with an .lz4 extension are LZ4-frame-compressed (see lz4_frame.hpp)
+bool is_compressed_buffer_file(const filesystem::path& path);
+
+// Maps a shared buffer - or a regular output file - into this process' address space,
+// for as long as the object lives
+class mapped_shared_buffer {
+public:
+    // For reading, the entire object is mapped; for writing, it is first resized to the specified size
+    mapped_shared_buffer(const std::string& buffer_spec, path_check_kind check_kind, std::size_t size_for_writing = 0);
+    // Creates (or truncates) the file and sizes it, for writing through the mapping
+    mapped_shared_buffer(const filesystem::path& output_file, std::size_t size);
+    mapped_shared_buffer(const mapped_shared_buffer&) = delete;
+    ~mapped_shared_buffer();
+
+    poor_mans_span span() const { return span_; }
+    const std::string& spec() const { return spec_; }
+
+    // Blocks until the mapped contents have reached the underlying object; optionally
+    // also its metadata (i.e. msync alone, or followed by fsync)
+    void sync(bool including_metadata) const;
+
+    // Invoked with the mapped span just before it is unmapped, e.g. to undo pinning it
+    void set_unmap_hook(std::function<void(poor_mans_span)> hook) { unmap_hook_ = std::move(hook); }
+
+protected:
+    void map(std::size_t size, bool writing);
+
+    std::string spec_;
+    int fd_ { -1 };
+    poor_mans_span span_ { nullptr, 0 };
+    std::function<void(poor_mans_span)> unmap_hook_;
+};
+
+/**
+ * Writes files on a separate thread, as their contents are handed over chunk by chunk - so
+ * that whatever produces later chunks (e.g. copying from the device) overlaps the writing of
+ * earlier ones. Files are written one after the other, in the order in which they're opened;
+ * the chunks must remain valid until @ref finish() returns.
+ */
+class asynchronous_file_writer {
+public:
+    asynchronous_file_writer();
+    asynchronous_file_writer(const asynchronous_file_writer&) = delete;
+    ~asynchronous_file_writer(); // waits for the pending writes, ignoring any failure
+
+    // The destination path is verified immediately, on the calling thread
+    void open(const std::string& buffer_name, const filesystem::path& destination, bool overwrite_allowed);
+    void append(poor_mans_span chunk);
+    void close();
+
+    // Waits for all pending writes; rethrows the first failure of any of them
+    void finish();
+
+protected:
+    struct task_t {
+        enum kind_t { open, append, close } kind;
+        std::string buffer_name;
+        filesystem::path destination;
+        poor_mans_span chunk;
+    };
+
+    void enqueue(task_t task);
+    void work();
+
+    std::mutex mutex_;
+    std::condition_variable state_changed_;
+    std::deque<task_t> tasks_;
+    bool finishing_ { false };
+    std::exception_ptr failure_;
+    std::thread thread_;
+};
+
 inline void verify_input_path(const filesystem::path& path)
 {
     return verify_path(path, for_reading, false);
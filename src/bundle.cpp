@@ -0,0 +1,193 @@
+#include <bundle.hpp>
+#include <buffer_io.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace bundle {
+
+namespace {
+
+constexpr const char magic[8] = { 'G', 'K', 'R', 'B', 'U', 'N', 'D', 'L' };
+constexpr const uint64_t format_version { 1 };
+constexpr const uint64_t payload_alignment { 4096 };
+
+struct header_t {
+    char magic[8];
+    uint64_t version;
+    uint64_t num_entries;
+    uint64_t names_offset;
+    uint64_t names_size;
+};
+
+struct index_record_t {
+    uint64_t name_offset; // relative to the string table
+    uint64_t name_length;
+    uint64_t data_offset; // relative to the beginning of the file
+    uint64_t data_size;
+};
+
+uint64_t round_up(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void writer::add(const std::string& name, std::string data)
+{
+    owned_data_.emplace_back(new std::string(std::move(data)));
+    auto& owned = *owned_data_.back();
+    add(name, poor_mans_span{ reinterpret_cast<byte_type*>(&owned[0]), owned.size() });
+}
+
+void writer::add(const std::string& name, poor_mans_span data)
+{
+    spdlog::trace("Adding bundle entry '{}' ({} bytes)", name, data.size());
+    entries_.push_back(entry_t{ name, data });
+}
+
+void writer::write(const filesystem::path& destination, bool overwrite_allowed) const
+{
+    verify_path(destination, for_writing, overwrite_allowed);
+
+    header_t header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = format_version;
+    header.num_entries = entries_.size();
+    header.names_offset = sizeof(header_t) + entries_.size() * sizeof(index_record_t);
+
+    std::string names;
+    std::vector<index_record_t> index;
+    for(const auto& entry : entries_) {
+        index.push_back(index_record_t{ names.size(), entry.name.size(), 0, entry.data.size() });
+        names += entry.name;
+    }
+    header.names_size = names.size();
+    uint64_t offset = header.names_offset + header.names_size;
+    for(auto& record : index) {
+        offset = round_up(offset, payload_alignment);
+        record.data_offset = offset;
+        offset += record.data_size;
+    }
+
+    std::ofstream file(destination, std::ios::out | std::ios::binary | std::ios::trunc);
+    file.exceptions(std::ios::failbit | std::ios::badbit);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(index.data()), (std::streamsize) (index.size() * sizeof(index_record_t)));
+    file.write(names.data(), (std::streamsize) names.size());
+    uint64_t position = header.names_offset + header.names_size;
+    const std::vector<char> padding(payload_alignment, '\0');
+    for(std::size_t i = 0; i < entries_.size(); i++) {
+        file.write(padding.data(), (std::streamsize) (index[i].data_offset - position));
+        file.write(reinterpret_cast<const char*>(entries_[i].data.data()), (std::streamsize) index[i].data_size);
+        position = index[i].data_offset + index[i].data_size;
+    }
+    spdlog::info("Wrote a bundle of {} entries ({} bytes) to {}", entries_.size(), position, destination.native());
+}
+
+reader::reader(const filesystem::path& bundle_file) : path_(bundle_file)
+{
+    verify_input_path(bundle_file);
+    int fd = ::open(bundle_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "opening bundle file " + bundle_file.native());
+    }
+    mapped_size_ = filesystem::file_size(bundle_file);
+    if (mapped_size_ < sizeof(header_t)) {
+        ::close(fd);
+        throw std::invalid_argument("Not a kernel run bundle (too short): " + bundle_file.native());
+    }
+    void* mapped = ::mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "mapping bundle file " + bundle_file.native());
+    }
+    mapped_ = static_cast<byte_type*>(mapped);
+    try {
+        index_entries();
+    }
+    catch(...) {
+        ::munmap(mapped_, mapped_size_);
+        mapped_ = nullptr;
+        throw;
+    }
+    spdlog::debug("Mapped bundle {}, with {} entries", bundle_file.native(), entries_.size());
+}
+
+void reader::index_entries()
+{
+    auto header = reinterpret_cast<const header_t*>(mapped_);
+    if (std::memcmp(header->magic, magic, sizeof(magic)) != 0) {
+        throw std::invalid_argument("Not a kernel run bundle: " + path_.native());
+    }
+    if (header->version != format_version) {
+        throw std::invalid_argument("Unsupported bundle format version " + std::to_string(header->version)
+            + " in " + path_.native());
+    }
+    // The checks are phrased so as not to overflow, whatever the values in a corrupt file
+    if (header->names_offset < sizeof(header_t) or header->names_offset > mapped_size_ or
+        header->num_entries > (header->names_offset - sizeof(header_t)) / sizeof(index_record_t) or
+        header->names_size > mapped_size_ - header->names_offset)
+    {
+        throw std::invalid_argument("Corrupt bundle index in " + path_.native());
+    }
+    auto index = reinterpret_cast<const index_record_t*>(mapped_ + sizeof(header_t));
+    auto names = mapped_ + header->names_offset;
+    for(uint64_t i = 0; i < header->num_entries; i++) {
+        const auto& record = index[i];
+        if (record.name_length > header->names_size or record.name_offset > header->names_size - record.name_length or
+            record.data_size > mapped_size_ or record.data_offset > mapped_size_ - record.data_size)
+        {
+            throw std::invalid_argument("Corrupt bundle entry in " + path_.native());
+        }
+        entries_.emplace(
+            std::string(reinterpret_cast<const char*>(names) + record.name_offset, record.name_length),
+            poor_mans_span{ mapped_ + record.data_offset, record.data_size });
+    }
+}
+
+reader::~reader()
+{
+    if (mapped_ != nullptr) { ::munmap(mapped_, mapped_size_); }
+}
+
+bool reader::contains(const std::string& name) const
+{
+    return entries_.find(name) != entries_.cend();
+}
+
+poor_mans_span reader::at(const std::string& name) const
+{
+    auto find_result = entries_.find(name);
+    if (find_result == entries_.cend()) {
+        throw std::invalid_argument("No entry '" + name + "' in bundle " + path_.native());
+    }
+    return find_result->second;
+}
+
+std::string reader::string_at(const std::string& name) const
+{
+    auto data = at(name);
+    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+std::vector<std::string> reader::names_with_prefix(const std::string& prefix) const
+{
+    std::vector<std::string> result;
+    for(const auto& p : entries_) {
+        if (p.first.compare(0, prefix.length(), prefix) == 0) {
+            result.push_back(p.first.substr(prefix.length()));
+        }
+    }
+    return result;
+}
+
+} // namespace bundle
@@ -0,0 +1,68 @@
+#ifndef BUNDLE_HPP_
+#define BUNDLE_HPP_
+
+#include <common_types.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * A single-file archive of named binary entries, used for recording everything
+ * needed to replay a kernel run.
+ *
+ * The layout is chosen so that a reader can map the file into memory and use the
+ * entries in place, without any parsing beyond the fixed-size index:
+ *
+ *   header       - magic, format version, entry count, string table location
+ *   index        - one fixed-size record per entry: name and payload locations
+ *   string table - the entry names, concatenated (not null-terminated)
+ *   payloads     - each beginning at a page-aligned offset
+ *
+ * All integers are 64-bit, in the native byte order of the recording machine.
+ */
+namespace bundle {
+
+class writer {
+public:
+    // The data is copied into the writer
+    void add(const std::string& name, std::string data);
+    // The data must remain valid until the bundle is written
+    void add(const std::string& name, poor_mans_span data);
+    void write(const filesystem::path& destination, bool overwrite_allowed) const;
+
+protected:
+    struct entry_t {
+        std::string name;
+        poor_mans_span data;
+    };
+    std::vector<entry_t> entries_;
+    std::vector<std::unique_ptr<std::string>> owned_data_;
+};
+
+class reader {
+public:
+    explicit reader(const filesystem::path& bundle_file);
+    reader(const reader&) = delete;
+    ~reader();
+
+    bool contains(const std::string& name) const;
+    // Views into the mapped file; valid for the lifetime of the reader
+    poor_mans_span at(const std::string& name) const;
+    std::string string_at(const std::string& name) const;
+    // Names of all entries beginning with the prefix, with the prefix removed
+    std::vector<std::string> names_with_prefix(const std::string& prefix) const;
+
+protected:
+    void index_entries(); // of the mapped file, validating its layout
+
+    filesystem::path path_;
+    byte_type* mapped_ { nullptr };
+    std::size_t mapped_size_ { 0 };
+    std::unordered_map<std::string, poor_mans_span> entries_;
+};
+
+} // namespace bundle
+
+#endif /* BUNDLE_HPP_ */
@@ -6,6 +6,9 @@
 
 #include <string>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -85,7 +88,37 @@ inline constexpr const char* parameter_direction_name(parameter_direction_t dir)
     return names[(int) dir];
 }
 
-using host_buffer_type = std::vector<byte_type>;
+// Host-side buffers are aligned for SIMD loads and stores; those of at least a page are
+// page-aligned, as DMA transfers and direct (O_DIRECT) file I/O require
+constexpr const std::size_t host_buffer_simd_alignment { 64 };
+constexpr const std::size_t host_buffer_page_alignment { 4096 };
+
+template <typename T>
+struct aligned_host_allocator {
+    using value_type = T;
+
+    aligned_host_allocator() noexcept = default;
+    template <typename U> aligned_host_allocator(const aligned_host_allocator<U>&) noexcept { }
+
+    T* allocate(std::size_t n)
+    {
+        auto size = n * sizeof(T);
+        auto alignment = (size >= host_buffer_page_alignment) ?
+            host_buffer_page_alignment : host_buffer_simd_alignment;
+        void* allocated;
+        if (posix_memalign(&allocated, alignment, (size > 0) ? size : 1) != 0) { throw std::bad_alloc{}; }
+        return static_cast<T*>(allocated);
+    }
+
+    void deallocate(T* p, std::size_t) noexcept { std::free(p); }
+};
+
+template <typename T, typename U>
+bool operator==(const aligned_host_allocator<T>&, const aligned_host_allocator<U>&) noexcept { return true; }
+template <typename T, typename U>
+bool operator!=(const aligned_host_allocator<T>&, const aligned_host_allocator<U>&) noexcept { return false; }
+
+using host_buffer_type = std::vector<byte_type, aligned_host_allocator<byte_type>>;
 using host_buffers_map = std::unordered_map<std::string, host_buffer_type>;
 
 struct poor_mans_span {
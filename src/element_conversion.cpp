@@ -0,0 +1,269 @@
+#include "element_conversion.hpp"
+
+#include <util/parallel.hpp>
+#include <util/miscellany.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// The IEEE 754 binary16 conversions are bit manipulations, after F. Giesen's public-domain
+// float_to_half_fast3_rtne() and half_to_float_fast5()
+
+inline std::uint32_t bits_of(float f) { std::uint32_t u; std::memcpy(&u, &f, sizeof(u)); return u; }
+inline float float_of(std::uint32_t u) { float f; std::memcpy(&f, &u, sizeof(f)); return f; }
+
+inline std::uint16_t float_to_half(float f)
+{
+    constexpr const std::uint32_t float_infinity { 255u << 23 };
+    constexpr const std::uint32_t half_overflow { (127u + 16) << 23 };
+    constexpr const std::uint32_t denormal_magic { ((127u - 15) + (23 - 10) + 1) << 23 };
+    auto u = bits_of(f);
+    auto sign = u & 0x80000000u;
+    u ^= sign;
+    std::uint16_t result;
+    if (u >= half_overflow) {
+        result = (u > float_infinity) ? 0x7E00 : 0x7C00; // NaN or infinity
+    }
+    else if (u < (113u << 23)) {
+        // The result is subnormal (or zero); let the FPU do the rounding
+        result = static_cast<std::uint16_t>(bits_of(float_of(u) + float_of(denormal_magic)) - denormal_magic);
+    }
+    else {
+        auto mantissa_is_odd = (u >> 13) & 1;
+        u += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xFFF;
+        u += mantissa_is_odd;
+        result = static_cast<std::uint16_t>(u >> 13);
+    }
+    return static_cast<std::uint16_t>(result | (sign >> 16));
+}
+
+inline float half_to_float(std::uint16_t h)
+{
+    constexpr const std::uint32_t shifted_exponent { 0x7C00u << 13 };
+    std::uint32_t u = (h & 0x7FFFu) << 13;
+    auto exponent = u & shifted_exponent;
+    u += (127u - 15) << 23;
+    if (exponent == shifted_exponent) {
+        u += (128u - 16) << 23; // infinity or NaN
+    }
+    else if (exponent == 0) {
+        u += 1u << 23; // zero or subnormal: renormalize
+        u = bits_of(float_of(u) - float_of(113u << 23));
+    }
+    return float_of(u | (std::uint32_t{h & 0x8000u} << 16));
+}
+
+template <element_type_t Type> struct element_traits;
+#define ELEMENT_TRAITS(type_, storage_) \
+template <> struct element_traits<element_type_t::type_> { using storage = storage_; };
+ELEMENT_TRAITS(int8,    std::int8_t)
+ELEMENT_TRAITS(uint8,   std::uint8_t)
+ELEMENT_TRAITS(int16,   std::int16_t)
+ELEMENT_TRAITS(uint16,  std::uint16_t)
+ELEMENT_TRAITS(int32,   std::int32_t)
+ELEMENT_TRAITS(uint32,  std::uint32_t)
+ELEMENT_TRAITS(int64,   std::int64_t)
+ELEMENT_TRAITS(uint64,  std::uint64_t)
+ELEMENT_TRAITS(float16, std::uint16_t)
+ELEMENT_TRAITS(float32, float)
+ELEMENT_TRAITS(float64, double)
+#undef ELEMENT_TRAITS
+
+template <element_type_t Type>
+using storage_t = typename element_traits<Type>::storage;
+
+template <element_type_t Type>
+constexpr bool is_integral() { return not is_floating_point(Type); }
+
+// Single-precision arithmetic is exact enough only when neither side has more than 24 significant bits
+template <element_type_t From, element_type_t To>
+using compute_t = typename std::conditional<
+    (element_size(From) <= 2 or From == element_type_t::float32) and
+    (element_size(To) <= 2 or To == element_type_t::float32),
+    float, double>::type;
+
+template <element_type_t Type, typename Compute>
+inline Compute load(storage_t<Type> x)
+{
+    return (Type == element_type_t::float16) ? static_cast<Compute>(half_to_float(static_cast<std::uint16_t>(x))) : static_cast<Compute>(x);
+}
+
+template <element_type_t Type, typename Compute>
+inline storage_t<Type> store(Compute x, std::true_type /* integral */)
+{
+    using storage = storage_t<Type>;
+    if (std::isnan(x)) { return 0; }
+    if (x >= static_cast<Compute>(std::numeric_limits<storage>::max())) { return std::numeric_limits<storage>::max(); }
+    if (x <= static_cast<Compute>(std::numeric_limits<storage>::lowest())) { return std::numeric_limits<storage>::lowest(); }
+    return static_cast<storage>(std::nearbyint(x));
+}
+
+template <element_type_t Type, typename Compute>
+inline storage_t<Type> store(Compute x, std::false_type /* integral */)
+{
+    return (Type == element_type_t::float16) ?
+        static_cast<storage_t<Type>>(float_to_half(static_cast<float>(x))) : static_cast<storage_t<Type>>(x);
+}
+
+// Integer-to-integer conversions without scaling don't go through floating-point, which
+// would lose precision for 64-bit values
+template <element_type_t From, element_type_t To>
+inline storage_t<To> convert_integer(storage_t<From> x)
+{
+    using to_storage = storage_t<To>;
+    constexpr const auto max = std::numeric_limits<to_storage>::max();
+    if (std::is_signed<storage_t<From>>::value) {
+        auto wide = static_cast<std::int64_t>(x);
+        if (wide < 0) {
+            return (std::is_signed<to_storage>::value and wide >= static_cast<std::int64_t>(std::numeric_limits<to_storage>::lowest())) ?
+                static_cast<to_storage>(wide) : std::numeric_limits<to_storage>::lowest();
+        }
+        return (static_cast<std::uint64_t>(wide) > static_cast<std::uint64_t>(max)) ? max : static_cast<to_storage>(wide);
+    }
+    auto wide = static_cast<std::uint64_t>(x);
+    return (wide > static_cast<std::uint64_t>(max)) ? max : static_cast<to_storage>(wide);
+}
+
+// Returns true if handled
+template <element_type_t From, element_type_t To>
+bool convert_with_f16c(const storage_t<From>* source, storage_t<To>* destination, std::size_t& num_converted, std::size_t n, double scale)
+{
+#if defined(__F16C__)
+    if (scale != 1.0) { return false; }
+    constexpr const std::size_t width { 8 };
+    if (From == element_type_t::float32 and To == element_type_t::float16) {
+        for(; num_converted + width <= n; num_converted += width) {
+            auto v = _mm256_loadu_ps(reinterpret_cast<const float*>(source + num_converted));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + num_converted), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+        }
+        return true;
+    }
+    if (From == element_type_t::float16 and To == element_type_t::float32) {
+        for(; num_converted + width <= n; num_converted += width) {
+            auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + num_converted));
+            _mm256_storeu_ps(reinterpret_cast<float*>(destination + num_converted), _mm256_cvtph_ps(v));
+        }
+        return true;
+    }
+#else
+    (void) source; (void) destination; (void) num_converted; (void) n; (void) scale;
+#endif
+    return false;
+}
+
+// The loops are simple enough for the compiler to vectorize (other than for float16, which
+// has explicit SIMD code when F16C is available)
+template <element_type_t From, element_type_t To>
+void convert_chunk(const byte_type* source_bytes, byte_type* destination_bytes, std::size_t n, double scale)
+{
+    auto source = reinterpret_cast<const storage_t<From>*>(source_bytes);
+    auto destination = reinterpret_cast<storage_t<To>*>(destination_bytes);
+    std::size_t i { 0 };
+    convert_with_f16c<From, To>(source, destination, i, n, scale);
+    if (is_integral<From>() and is_integral<To>() and scale == 1.0) {
+        for(; i < n; i++) { destination[i] = convert_integer<From, To>(source[i]); }
+        return;
+    }
+    using compute = compute_t<From, To>;
+    auto scale_ = static_cast<compute>(scale);
+    std::integral_constant<bool, is_integral<To>()> to_integral;
+    for(; i < n; i++) {
+        destination[i] = store<To, compute>(load<From, compute>(source[i]) * scale_, to_integral);
+    }
+}
+
+template <typename F>
+void with_element_type(element_type_t type, F f)
+{
+    switch(type) {
+    case element_type_t::int8:    f(std::integral_constant<element_type_t, element_type_t::int8>{});    break;
+    case element_type_t::uint8:   f(std::integral_constant<element_type_t, element_type_t::uint8>{});   break;
+    case element_type_t::int16:   f(std::integral_constant<element_type_t, element_type_t::int16>{});   break;
+    case element_type_t::uint16:  f(std::integral_constant<element_type_t, element_type_t::uint16>{});  break;
+    case element_type_t::int32:   f(std::integral_constant<element_type_t, element_type_t::int32>{});   break;
+    case element_type_t::uint32:  f(std::integral_constant<element_type_t, element_type_t::uint32>{});  break;
+    case element_type_t::int64:   f(std::integral_constant<element_type_t, element_type_t::int64>{});   break;
+    case element_type_t::uint64:  f(std::integral_constant<element_type_t, element_type_t::uint64>{});  break;
+    case element_type_t::float16: f(std::integral_constant<element_type_t, element_type_t::float16>{}); break;
+    case element_type_t::float32: f(std::integral_constant<element_type_t, element_type_t::float32>{}); break;
+    case element_type_t::float64: f(std::integral_constant<element_type_t, element_type_t::float64>{}); break;
+    }
+}
+
+constexpr const std::size_t elements_per_chunk { 1 << 20 };
+
+} // namespace
+
+float float16_to_float32(std::uint16_t half) { return half_to_float(half); }
+std::uint16_t float32_to_float16(float x) { return float_to_half(x); }
+
+element_conversion_t parse_element_conversion(const std::string& spec)
+{
+    auto first_colon = spec.find(':');
+    if (first_colon == std::string::npos) {
+        throw std::invalid_argument("Invalid element conversion \"" + spec + "\": Expected FROM:TO or FROM:TO:SCALE");
+    }
+    auto second_colon = spec.find(':', first_colon + 1);
+    element_conversion_t result;
+    result.from = parse_element_type(spec.substr(0, first_colon));
+    result.to = parse_element_type(spec.substr(first_colon + 1, second_colon - first_colon - 1));
+    if (second_colon != std::string::npos) {
+        std::size_t parsed_length;
+        auto scale_str = spec.substr(second_colon + 1);
+        result.scale = std::stod(scale_str, &parsed_length);
+        if (parsed_length != scale_str.length()) {
+            throw std::invalid_argument("Invalid scale factor in element conversion \"" + spec + "\"");
+        }
+    }
+    return result;
+}
+
+void convert_elements(
+    const element_conversion_t& conversion,
+    poor_mans_span              source,
+    poor_mans_span              destination,
+    unsigned                    num_threads)
+{
+    auto from_size = element_size(conversion.from);
+    auto to_size = element_size(conversion.to);
+    if (source.size() % from_size != 0) {
+        throw std::invalid_argument("Buffer size " + std::to_string(source.size()) + " is not a multiple of the size of "
+            + element_type_name(conversion.from) + " elements");
+    }
+    auto num_elements = source.size() / from_size;
+    if (destination.size() < num_elements * to_size) {
+        throw std::invalid_argument("Insufficient space for the converted elements");
+    }
+    auto num_chunks = util::div_rounding_up(num_elements, elements_per_chunk);
+    with_element_type(conversion.from, [&](auto from) {
+        with_element_type(conversion.to, [&](auto to) {
+            util::parallel_for(num_chunks, num_threads, [&](std::size_t chunk_index) {
+                auto offset = chunk_index * elements_per_chunk;
+                auto n = std::min(elements_per_chunk, num_elements - offset);
+                convert_chunk<decltype(from)::value, decltype(to)::value>(
+                    source.data() + offset * from_size, destination.data() + offset * to_size, n, conversion.scale);
+            });
+        });
+    });
+}
+
+host_buffer_type convert_elements(
+    const element_conversion_t& conversion,
+    poor_mans_span              source,
+    unsigned                    num_threads)
+{
+    host_buffer_type result(conversion.converted_size(source.size()));
+    convert_elements(conversion, source, poor_mans_span{ result.data(), result.size() }, num_threads);
+    return result;
+}
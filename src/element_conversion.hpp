@@ -0,0 +1,59 @@
+#ifndef ELEMENT_CONVERSION_HPP_
+#define ELEMENT_CONVERSION_HPP_
+
+#include "common_types.hpp"
+#include "element_types.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+ * A conversion of a buffer's elements between how they are stored in its file and how the
+ * kernel sees them - applied when reading an input buffer (from the file's type to the
+ * kernel's), and when writing an output buffer (from the kernel's type to the file's). Each
+ * element is multiplied by the scale factor in the process, e.g. to map fixed-point int16
+ * samples to floating-point values.
+ *
+ * Conversions to integer types round to nearest, and saturate; conversions to float16
+ * round to nearest-even.
+ */
+struct element_conversion_t {
+    element_type_t from;
+    element_type_t to;
+    double scale { 1.0 };
+
+    std::size_t converted_size(std::size_t size) const
+    {
+        return size / element_size(from) * element_size(to);
+    }
+
+    // For writing back an in-out buffer which was converted when it was read
+    element_conversion_t inverse() const { return { to, from, 1.0 / scale }; }
+};
+
+using element_conversions_t = std::unordered_map<std::string, element_conversion_t>; // by buffer name
+
+// Parses FROM:TO or FROM:TO:SCALE, e.g. "float64:float32" or "int16:float:0.001"
+element_conversion_t parse_element_conversion(const std::string& spec);
+
+/**
+ * Converts the source elements into the destination, which must be large enough for the
+ * converted elements. Large spans are split into chunks, converted by multiple threads.
+ */
+void convert_elements(
+    const element_conversion_t& conversion,
+    poor_mans_span              source,
+    poor_mans_span              destination,
+    unsigned                    num_threads);
+
+host_buffer_type convert_elements(
+    const element_conversion_t& conversion,
+    poor_mans_span              source,
+    unsigned                    num_threads);
+
+// Single IEEE 754 binary16 values, held as their bits, e.g. for host-side reference computations
+float float16_to_float32(std::uint16_t half);
+std::uint16_t float32_to_float16(float x); // rounding to nearest-even
+
+#endif /* ELEMENT_CONVERSION_HPP_ */
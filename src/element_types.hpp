@@ -0,0 +1,100 @@
+#ifndef ELEMENT_TYPES_HPP_
+#define ELEMENT_TYPES_HPP_
+
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * The element types which kernel buffers commonly hold, and which the
+ * runner or its kernel adapters may need to reason about on the host side
+ * (e.g. for computing buffer sizes from element counts).
+ */
+enum class element_type_t {
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    int64,
+    uint64,
+    float16,
+    float32,
+    float64,
+};
+
+inline constexpr std::size_t element_size(element_type_t type)
+{
+    constexpr const std::size_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 2, 4, 8 };
+    return sizes[(int) type];
+}
+
+inline constexpr const char* element_type_name(element_type_t type)
+{
+    constexpr const char* names[] = {
+        "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64",
+        "float16", "float32", "float64" };
+    return names[(int) type];
+}
+
+inline constexpr bool is_floating_point(element_type_t type)
+{
+    return type == element_type_t::float16 or type == element_type_t::float32 or type == element_type_t::float64;
+}
+
+/**
+ * Determine an element type from its name - either one of our own short names
+ * (e.g. "float32", "uint16"), or a name of the type as it would appear in kernel
+ * source code (e.g. "float", "unsigned short", "uint16_t", "half").
+ *
+ * @throws std::invalid_argument if the name is not recognized
+ */
+inline element_type_t parse_element_type(const std::string& name)
+{
+    static const std::unordered_map<std::string, element_type_t> types_by_name = {
+        { "int8",     element_type_t::int8    }, { "int8_t",   element_type_t::int8    },
+        { "char",     element_type_t::int8    }, { "signed char", element_type_t::int8 },
+        { "uint8",    element_type_t::uint8   }, { "uint8_t",  element_type_t::uint8   },
+        { "uchar",    element_type_t::uint8   }, { "unsigned char", element_type_t::uint8 },
+        { "int16",    element_type_t::int16   }, { "int16_t",  element_type_t::int16   },
+        { "short",    element_type_t::int16   },
+        { "uint16",   element_type_t::uint16  }, { "uint16_t", element_type_t::uint16  },
+        { "ushort",   element_type_t::uint16  }, { "unsigned short", element_type_t::uint16 },
+        { "int32",    element_type_t::int32   }, { "int32_t",  element_type_t::int32   },
+        { "int",      element_type_t::int32   },
+        { "uint32",   element_type_t::uint32  }, { "uint32_t", element_type_t::uint32  },
+        { "uint",     element_type_t::uint32  }, { "unsigned", element_type_t::uint32  },
+        { "unsigned int", element_type_t::uint32 },
+        { "int64",    element_type_t::int64   }, { "int64_t",  element_type_t::int64   },
+        { "long",     element_type_t::int64   }, { "long long", element_type_t::int64  },
+        { "uint64",   element_type_t::uint64  }, { "uint64_t", element_type_t::uint64  },
+        { "ulong",    element_type_t::uint64  }, { "unsigned long", element_type_t::uint64 },
+        { "unsigned long long", element_type_t::uint64 }, { "size_t", element_type_t::uint64 },
+        { "float16",  element_type_t::float16 }, { "half",     element_type_t::float16 },
+        { "__half",   element_type_t::float16 }, { "f16",      element_type_t::float16 },
+        { "float32",  element_type_t::float32 }, { "float",    element_type_t::float32 },
+        { "f32",      element_type_t::float32 },
+        { "float64",  element_type_t::float64 }, { "double",   element_type_t::float64 },
+        { "f64",      element_type_t::float64 },
+    };
+    auto find_result = types_by_name.find(name);
+    if (find_result == types_by_name.cend()) {
+        throw std::invalid_argument("Unsupported element type name: \"" + name + "\"");
+    }
+    return find_result->second;
+}
+
+// The element type named by the value of a preprocessor definition, or the default if it is not defined
+inline element_type_t defined_element_type(
+    const std::unordered_map<std::string, std::string>& valued_definitions,
+    const std::string& defined_term,
+    element_type_t default_type)
+{
+    auto find_result = valued_definitions.find(defined_term);
+    return (find_result == valued_definitions.cend()) ?
+        default_type : parse_element_type(find_result->second);
+}
+
+#endif /* ELEMENT_TYPES_HPP_ */
@@ -27,10 +27,14 @@ DISABLE_WARNING_POP
 #include <memory>
 #include <utility>
 #include <tuple>
+#include <chrono>
+#include <array>
 
 using string_map = std::unordered_map<std::string, std::string>;
 using include_paths_t = std::vector<std::string>;
 using buffer_sizes = std::unordered_map<std::string, size_t>;
+using execution_duration_type = std::chrono::duration<double, std::nano>;
+using output_hash_t = std::array<std::uint64_t, 2>; // of an output buffer's contents, computed on the device
 
 // TODO: Switch to a variant, perhaps?
 union device_buffer_type {
@@ -52,7 +56,20 @@ struct marshalled_arguments_type {
     std::vector<const void*> pointers;
     std::vector<size_t> sizes;
 };
+
+// One of several kernel launches making up a single run, for kernel adapters
+// which can't do their work with a single launch
+struct kernel_launch_step {
+    optional_launch_config_components_t launch_config_components;
+    marshalled_arguments_type arguments;
+    std::vector<std::shared_ptr<const void>> owned_argument_values;
+        // For arguments which are specific to the step rather than held in the context; the
+        // pointers in the marshalled arguments remain valid when the step is moved
+    launch_configuration_type launch_config; // realized by the runner
+    std::string kernel_function; // one of the adapter's additional kernel functions; empty for the main one
+};
 class kernel_adapter;
+class mapped_shared_buffer;
 
 // Essentially, a manually-managed closure and some other dynamically-generated data
 struct execution_context_t {
@@ -67,10 +84,21 @@ struct execution_context_t {
             device_buffers_map inputs, outputs;
                 // Note: in-out buffers have one pristine copy in the inputs map,
                 // and a "working" copy the outputs map
+            device_buffers_map scratch; // not passed to or from the host; requested by the adapter
+            device_buffers_map bound_inputs;
+                // Output buffers of earlier kernels in a pipeline, used as inputs of this one
+                // without being copied to and from the host
         } device_side;
         struct {
             string_map inputs, outputs; // , expected;
         } filenames;
+        struct {
+            std::unordered_map<std::string, std::shared_ptr<mapped_shared_buffer>> inputs, outputs;
+        } shared;
+            // For buffers exchanged with other processes through shared memory rather than through
+            // files, and for output files written through memory mappings. An input's host-side
+            // buffer is a copy of its mapping, for the adapter's use; outputs, however, are copied
+            // from the device directly into their mappings, and have no host-side buffer contents.
     } buffers;
         // Note: in-out buffers will appear both in the input and the output buffer maps;
         // The input copy will not be used by the kernel directly; rather, before a run,
@@ -80,9 +108,16 @@ struct execution_context_t {
     execution_ecosystem_t ecosystem;
     struct cuda_specific_t {
         optional<cuda::context_t>  context;
+        std::shared_ptr<void>      context_lifetime;
+            // Shared by all contexts using the same CUDA context, and released just before it is
+            // destroyed - after which the host memory registered in it is no longer registered
         optional<cuda::module_t>   module; // in the context
         optional<std::string>      mangled_kernel_signature;
+        std::unordered_map<std::string, std::string> mangled_kernel_signatures;
+            // for all built kernel functions, by function name or name expression
         optional<cuda::stream_t>  stream;
+        optional<cuda::module_t>   output_scan_module; // of the bundled kernels scanning outputs, once built
+        std::unordered_map<std::string, std::string> output_scan_kernel_signatures;
     };
     cuda_specific_t cuda;
     struct {
@@ -90,6 +125,7 @@ struct execution_context_t {
         cl::Device        device;
         cl::Program       program;
         cl::Kernel        built_kernel;
+        std::unordered_map<std::string, cl::Kernel> built_kernels; // all built kernel functions, by name
         cl::CommandQueue  queue;
         std::vector<std::size_t> finalized_argument_sizes;
             // TODO: Consider moving these out of the OpenCL-specific structure
@@ -107,7 +143,14 @@ struct execution_context_t {
     } finalized_preprocessor_definitions;
     include_paths_t finalized_include_dir_paths;
     marshalled_arguments_type finalized_arguments;
+    optional_launch_config_components_t kernel_launch_config_components; // from which the configuration was realized
     launch_configuration_type kernel_launch_configuration;
+    std::vector<kernel_launch_step> launch_steps; // empty unless the adapter uses multiple launches per run
+    std::vector<execution_duration_type> run_durations; // Only populated when timing with events
+    struct {
+        std::unordered_map<std::string, output_hash_t> of_first_run;
+        std::unordered_map<std::string, run_index_t> first_divergent_runs; // of the outputs which weren't the same in every run
+    } output_hashes; // Only populated when checking the determinism of the outputs
 
 public:
 
@@ -133,6 +176,111 @@ inline bool execution_context_t::get_defined_value<bool>(const std::string& s)
 template <execution_ecosystem_t Ecosystem>
 void initialize_execution_context(execution_context_t& context);
 
+// The number of CUDA multiprocessors or OpenCL compute units on the device we're using
+inline unsigned multiprocessor_count(const execution_context_t& context)
+{
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        return (unsigned) context.cuda.context->device().get_attribute(CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT);
+    }
+    return (unsigned) context.opencl.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+}
+
+// The amount of shared memory (OpenCL: local memory) a single block (OpenCL: work group) may
+// use, without opting in to more of it
+inline std::size_t max_shared_memory_per_block(const execution_context_t& context)
+{
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        return (std::size_t) context.cuda.context->device().get_attribute(CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK);
+    }
+    return (std::size_t) context.opencl.device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+}
+
+// The number of threads (OpenCL: work items) which may be simultaneously resident on a single
+// multiprocessor (OpenCL: compute unit); for OpenCL this is not exposed, so we make a rough guess.
+inline unsigned max_resident_threads_per_multiprocessor(const execution_context_t& context)
+{
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        return (unsigned) context.cuda.context->device().get_attribute(CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_MULTIPROCESSOR);
+    }
+    constexpr const unsigned assumed_resident_maximal_work_groups_per_compute_unit { 2 };
+    return (unsigned) context.opencl.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>() *
+        assumed_resident_maximal_work_groups_per_compute_unit;
+}
+
+// The number of blocks of the specified size which can all be resident on the device at once -
+// a reasonable grid size for kernels using grid-stride loops
+inline std::size_t blocks_filling_device(const execution_context_t& context, std::size_t block_size)
+{
+    std::size_t resident_blocks_per_multiprocessor =
+        std::max<std::size_t>(1, max_resident_threads_per_multiprocessor(context) / block_size);
+    return multiprocessor_count(context) * resident_blocks_per_multiprocessor;
+}
+
+// The built CUDA kernel function - the main one, or one of the adapter's additional kernel functions
+inline cuda::kernel_t built_cuda_kernel(const execution_context_t& context, const std::string& kernel_function = {})
+{
+    const auto& mangled_signature = kernel_function.empty() ?
+        context.cuda.mangled_kernel_signature.value() : context.cuda.mangled_kernel_signatures.at(kernel_function);
+    return context.cuda.module->get_kernel(mangled_signature.c_str());
+}
+
+// The device-side buffer the kernel uses for the named buffer (of any kind), if there is one;
+// for an in-out buffer, that's its working copy
+inline const device_buffer_type* find_device_side_buffer(const execution_context_t& context, const std::string& buffer_name)
+{
+    const auto& device_side = context.buffers.device_side;
+    for(const auto* buffers : { &device_side.outputs, &device_side.inputs, &device_side.scratch, &device_side.bound_inputs }) {
+        auto find_result = buffers->find(buffer_name);
+        if (find_result != buffers->cend()) { return &find_result->second; }
+    }
+    return nullptr;
+}
+
+// The number of blocks of the specified size - and dynamic shared memory use - which can all be
+// resident on the device at once, running the built kernel (or one of the adapter's additional
+// kernel functions), according to the CUDA occupancy calculator; this is the largest grid
+// allowed for a cooperative launch. OpenCL has no occupancy API, so there we fall back on
+// @ref blocks_filling_device .
+inline std::size_t max_co_resident_blocks(
+    const execution_context_t& context,
+    std::size_t                block_size,
+    std::size_t                dynamic_shared_memory_size = 0,
+    const std::string&         kernel_function = {})
+{
+    if (context.ecosystem != execution_ecosystem_t::cuda) {
+        return blocks_filling_device(context, block_size);
+    }
+    cuda::context::current::scoped_override_t context_for_this_scope(*context.cuda.context);
+    auto kernel = built_cuda_kernel(context, kernel_function);
+    int blocks_per_multiprocessor;
+    auto status = cuOccupancyMaxActiveBlocksPerMultiprocessor(
+        &blocks_per_multiprocessor, kernel.handle(), (int) block_size, dynamic_shared_memory_size);
+    if (status != CUDA_SUCCESS) {
+        throw std::runtime_error("Failed determining the number of co-resident blocks of "
+            + std::to_string(block_size) + " threads per multiprocessor: CUDA driver error " + std::to_string(status));
+    }
+    return multiprocessor_count(context) * (std::size_t) blocks_per_multiprocessor;
+}
+
+// Sets a one-dimensional grid which exactly fills the device - as many blocks as can be resident
+// at once (see @ref max_co_resident_blocks) - for a persistent kernel, whose blocks loop over the
+// work rather than each handling a fixed part of it. The block dimensions must already be set.
+inline void set_persistent_grid(
+    optional_launch_config_components_t& components,
+    const execution_context_t&           context,
+    const std::string&                   kernel_function = {})
+{
+    const auto& bd = components.block_dimensions.value();
+    auto num_blocks = max_co_resident_blocks(context, bd[0] * bd[1] * bd[2],
+        components.dynamic_shared_memory_size.value_or(0), kernel_function);
+    if (num_blocks == 0) {
+        throw std::invalid_argument("Blocks of " + std::to_string(bd[0] * bd[1] * bd[2])
+            + " threads can't be resident on the device at all");
+    }
+    components.set_grid_dims(num_blocks, 1, 1);
+    components.overall_grid_dimensions = nullopt;
+}
+
 template <typename Scalar>
 const Scalar& get_scalar_argument(const execution_context_t& context, const char* scalar_parameter_name)
 {
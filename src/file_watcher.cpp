@@ -0,0 +1,96 @@
+#include <file_watcher.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace {
+
+constexpr const uint32_t watched_event_kinds { IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF };
+
+filesystem::path directory_of(const filesystem::path& file)
+{
+    auto directory = file.parent_path();
+    return directory.empty() ? filesystem::path{"."} : directory;
+}
+
+} // namespace
+
+file_watcher::file_watcher() : inotify_fd_(::inotify_init1(IN_CLOEXEC))
+{
+    if (inotify_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "initializing inotify");
+    }
+}
+
+file_watcher::~file_watcher()
+{
+    ::close(inotify_fd_);
+}
+
+void file_watcher::watch(const std::vector<filesystem::path>& files)
+{
+    for(const auto& p : watched_directories_) {
+        ::inotify_rm_watch(inotify_fd_, p.first);
+    }
+    watched_directories_.clear();
+    watched_files_.clear();
+
+    std::unordered_set<std::string> directories;
+    for(const auto& file : files) {
+        auto directory = filesystem::absolute(directory_of(file));
+        watched_files_.insert((directory / file.filename()).native());
+        directories.insert(directory.native());
+    }
+    for(const auto& directory : directories) {
+        int watch_descriptor = ::inotify_add_watch(inotify_fd_, directory.c_str(), watched_event_kinds);
+        if (watch_descriptor < 0) {
+            throw std::system_error(errno, std::generic_category(), "watching directory " + directory);
+        }
+        watched_directories_.emplace(watch_descriptor, directory);
+    }
+    spdlog::debug("Watching {} files, in {} directories", watched_files_.size(), watched_directories_.size());
+}
+
+bool file_watcher::collect_changes(int timeout_in_milliseconds, std::unordered_set<std::string>& changed)
+{
+    pollfd poll_descriptor { inotify_fd_, POLLIN, 0 };
+    int poll_result = ::poll(&poll_descriptor, 1, timeout_in_milliseconds);
+    if (poll_result < 0) {
+        if (errno == EINTR) { return false; }
+        throw std::system_error(errno, std::generic_category(), "waiting for file changes");
+    }
+    if (poll_result == 0) { return false; }
+
+    alignas(inotify_event) char events_buffer[4096];
+    auto bytes_read = ::read(inotify_fd_, events_buffer, sizeof(events_buffer));
+    if (bytes_read < 0) {
+        throw std::system_error(errno, std::generic_category(), "reading file change events");
+    }
+    for(char* pos = events_buffer; pos < events_buffer + bytes_read; ) {
+        const auto& event = *reinterpret_cast<const inotify_event*>(pos);
+        pos += sizeof(inotify_event) + event.len;
+        auto find_result = watched_directories_.find(event.wd);
+        if (event.len == 0 or find_result == watched_directories_.cend()) { continue; }
+        auto path = (find_result->second / event.name).native();
+        if (watched_files_.find(path) != watched_files_.cend()) {
+            spdlog::trace("Change detected in {}", path);
+            changed.insert(path);
+        }
+    }
+    return true;
+}
+
+std::vector<filesystem::path> file_watcher::wait_for_changes(std::chrono::milliseconds settling_period)
+{
+    std::unordered_set<std::string> changed;
+    constexpr const int no_timeout { -1 };
+    while (changed.empty()) { collect_changes(no_timeout, changed); }
+    while (collect_changes((int) settling_period.count(), changed)) { }
+    return std::vector<filesystem::path>(changed.cbegin(), changed.cend());
+}
@@ -0,0 +1,46 @@
+#ifndef FILE_WATCHER_HPP_
+#define FILE_WATCHER_HPP_
+
+#include <common_types.hpp>
+
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Waits for changes to a set of files, using inotify.
+ *
+ * The directories containing the files are watched, rather than the files themselves,
+ * since many editors save by writing a new file and renaming it over the old one -
+ * which a watch on the old file would not survive.
+ */
+class file_watcher {
+public:
+    file_watcher();
+    file_watcher(const file_watcher&) = delete;
+    ~file_watcher();
+
+    // Replaces the set of watched files
+    void watch(const std::vector<filesystem::path>& files);
+
+    /**
+     * Blocks until at least one of the watched files has changed, then waits until no
+     * further changes arrive for the settling period - so that a save touching several
+     * files, or writing one file in several steps, is reported as a single change.
+     *
+     * @return the changed files
+     */
+    std::vector<filesystem::path> wait_for_changes(std::chrono::milliseconds settling_period);
+
+protected:
+    // Adds the changed watched files among the pending events to @p changed;
+    // returns false if no events arrived before the timeout
+    bool collect_changes(int timeout_in_milliseconds, std::unordered_set<std::string>& changed);
+
+    int inotify_fd_;
+    std::unordered_map<int, filesystem::path> watched_directories_; // by watch descriptor
+    std::unordered_set<std::string> watched_files_;
+};
+
+#endif /* FILE_WATCHER_HPP_ */
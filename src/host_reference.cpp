@@ -0,0 +1,68 @@
+#include "host_reference.hpp"
+
+#include <util/parallel.hpp>
+#include <util/miscellany.hpp>
+
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace host_reference {
+
+namespace {
+
+constexpr const std::size_t bytes_per_chunk { 1 << 20 };
+
+void add_bytes_serially(
+    unsigned char*        destination,
+    const unsigned char*  a,
+    const unsigned char*  b,
+    unsigned char         addend,
+    std::size_t           length)
+{
+    std::size_t i { 0 };
+#if defined(__AVX2__)
+    constexpr const std::size_t width { sizeof(__m256i) };
+    auto addends = _mm256_set1_epi8(static_cast<char>(addend));
+    for(; i + width <= length; i += width) {
+        auto sum = _mm256_add_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_add_epi8(sum, addends));
+    }
+#elif defined(__SSE2__)
+    constexpr const std::size_t width { sizeof(__m128i) };
+    auto addends = _mm_set1_epi8(static_cast<char>(addend));
+    for(; i + width <= length; i += width) {
+        auto sum = _mm_add_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_add_epi8(sum, addends));
+    }
+#endif
+    for(; i < length; i++) {
+        destination[i] = static_cast<unsigned char>(a[i] + b[i] + addend);
+    }
+}
+
+} // namespace
+
+void add_bytes(
+    unsigned char*        destination,
+    const unsigned char*  a,
+    const unsigned char*  b,
+    unsigned char         addend,
+    std::size_t           length,
+    unsigned              num_threads)
+{
+    auto num_chunks = util::div_rounding_up(length, bytes_per_chunk);
+    util::parallel_for(num_chunks, num_threads, [&](std::size_t chunk_index) {
+        auto offset = chunk_index * bytes_per_chunk;
+        auto chunk_length = std::min(bytes_per_chunk, length - offset);
+        add_bytes_serially(destination + offset, a + offset, b + offset, addend, chunk_length);
+    });
+}
+
+} // namespace host_reference
@@ -0,0 +1,24 @@
+#ifndef HOST_REFERENCE_HPP_
+#define HOST_REFERENCE_HPP_
+
+#include <cstddef>
+
+/**
+ * Building blocks for kernel adapters' host-side reference implementations. These are meant
+ * as a fair baseline for the kernels' performance, so they use SIMD instructions where the
+ * build targets them, and run on multiple threads, each taking a cache-sized chunk at a time.
+ */
+namespace host_reference {
+
+// destination[i] = a[i] + b[i] + addend, modulo 256; the destination may be the same as a or b
+void add_bytes(
+    unsigned char*        destination,
+    const unsigned char*  a,
+    const unsigned char*  b,
+    unsigned char         addend,
+    std::size_t           length,
+    unsigned              num_threads);
+
+} // namespace host_reference
+
+#endif /* HOST_REFERENCE_HPP_ */
@@ -3,14 +3,21 @@
 #include "execution_context.hpp"
 #include "kernel_adapter.hpp"
 #include "buffer_io.hpp"
+#include "bundle.hpp"
+#include "file_watcher.hpp"
+#include "source_dependencies.hpp"
+#include "lz4_frame.hpp"
+#include "element_conversion.hpp"
 
 #include <nvrtc-related/build.hpp>
 #include <nvrtc-related/execution.hpp>
+#include <nvrtc-related/output_scan.hpp>
 #include <opencl-related/build.hpp>
 #include <opencl-related/execution.hpp>
 #include <opencl-related/miscellany.hpp>
 
 #include <util/miscellany.hpp>
+#include <util/parallel.hpp>
 #include <util/cxxopts-extra.hpp>
 #include <util/spdlog-extra.hpp>
 
@@ -20,10 +27,26 @@
 #include <spdlog/spdlog.h>
 #include <spdlog/cfg/helpers.h>
 #include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/cfg/env.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <system_error>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <set>
 #include <cerrno>
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <cstdio>
 #include <vector>
@@ -42,10 +65,16 @@ template <typename... Ts>
     exit(EXIT_FAILURE);
 }
 
+poor_mans_span as_span(const host_buffer_type& buffer)
+{
+    return poor_mans_span{ const_cast<byte_type*>(buffer.data()), buffer.size() };
+}
+
 host_buffers_map read_buffers_from_files(
-    const parameter_name_set& buffer_names,
-    const string_map&         filenames,
-    const filesystem::path&   buffer_directory)
+    const parameter_name_set&  buffer_names,
+    const string_map&          filenames,
+    const filesystem::path&    buffer_directory,
+    const element_conversions_t& element_conversions)
 {
     host_buffers_map result;
     std::unordered_map<string, filesystem::path> buffer_paths;
@@ -53,7 +82,25 @@ host_buffers_map read_buffers_from_files(
         auto path = maybe_prepend_base_dir(buffer_directory, filenames.at(name));
         try {
             spdlog::debug("Reading buffer '{}' from {}", name, path.native());
-            host_buffer_type buffer = read_input_file(path);
+            auto conversion_find_result = element_conversions.find(name);
+            bool convert = (conversion_find_result != element_conversions.cend());
+            bool compressed = is_compressed_buffer_file(path);
+            host_buffer_type buffer = (convert and not compressed) ?
+                read_input_file(path, conversion_find_result->second, util::default_num_threads()) :
+                read_input_file(path);
+            if (compressed) {
+                auto compressed_size = buffer.size();
+                buffer = lz4_frame::decompress(as_span(buffer), util::default_num_threads());
+                spdlog::debug("Decompressed buffer '{}': {} bytes into {} bytes", name, compressed_size, buffer.size());
+                if (convert) {
+                    buffer = convert_elements(conversion_find_result->second, as_span(buffer), util::default_num_threads());
+                }
+            }
+            if (convert) {
+                const auto& conversion = conversion_find_result->second;
+                spdlog::debug("Converted the elements of buffer '{}' from {} to {}", name,
+                    element_type_name(conversion.from), element_type_name(conversion.to));
+            }
             spdlog::debug("Have read buffer '{}': {} bytes from {}", name, buffer.size(), path.native());
             result.emplace(name, std::move(buffer));
         }
@@ -73,6 +120,10 @@ cxxopts::Options basic_cmdline_options(const char* program_name)
         ("log-flush-threshold", "Set the threshold level at and above which the log is flushed on each message",
             cxxopts::value<string>()->default_value("info"))
         ("w,write-output", "Write output buffers to files", cxxopts::value<bool>()->default_value("true"))
+        ("map-output-files", "Copy output buffers from the device directly into memory-mapped output files, rather than into host-side buffers which are then written to the files", cxxopts::value<bool>()->default_value("false"))
+        ("sync-output-files", "How to make sure memory-mapped output files have reached storage: none (leave this to the operating system), msync (their contents) or fsync (their contents and metadata)", cxxopts::value<string>()->default_value("none"))
+        ("compress-outputs", "Write output buffers as LZ4-compressed .lz4 files (files named *.lz4 are always compressed)", cxxopts::value<bool>()->default_value("false"))
+        ("convert", "Convert the elements of a buffer between their type in the buffer file and the type the kernel uses - on reading for an input, on writing for an output; specify as BUFFER=FROM:TO or BUFFER=FROM:TO:SCALE, the elements being multiplied by SCALE (can be used repeatedly)", cxxopts::value<std::vector<string>>())
         ("n,num-runs", "Number of times to run the compiled kernel", cxxopts::value<unsigned>()->default_value("1"))
         ("opencl", "Use OpenCL", cxxopts::value<bool>())
         ("cuda", "Use CUDA", cxxopts::value<bool>())
@@ -91,6 +142,11 @@ cxxopts::Options basic_cmdline_options(const char* program_name)
         ("g,grid-dimensions", "Set grid dimensions in blocks; a comma-separated list", cxxopts::value<std::vector<unsigned>>() )
         ("o,overall-grid-dimensions", "Set grid dimensions in threads (OpenCL: global work size); a comma-separated list", cxxopts::value<std::vector<unsigned>>() )
         ("S,dynamic-shared-memory-size", "Force specific amount of dynamic shared memory", cxxopts::value<unsigned>() )
+        ("cooperative", "Launch the kernel cooperatively, guaranteeing all of its blocks are co-resident so they may synchronize with each other; the grid must fit the device at once (CUDA only)", cxxopts::value<bool>()->default_value("false"))
+        ("persistent-grid", "Use a one-dimensional grid of exactly as many blocks as can be resident on the device at once, for persistent kernels (with grid-stride loops, or work queues); the block dimensions are still forced or deduced", cxxopts::value<bool>()->default_value("false"))
+        ("cluster-dimensions", "Launch the grid's blocks in thread-block clusters of these dimensions, in blocks; a comma-separated list, each dividing the grid dimension (CUDA 12.0 and later, compute capability 9.0 and later)", cxxopts::value<std::vector<unsigned>>() )
+        ("l2-persist", "Make (a fraction of) the kernel's accesses to a buffer persisting in the L2 cache (CUDA only, compute capability 8.0 and later); specify as BUFFER, BUFFER=HIT_RATIO or BUFFER=HIT_RATIO:CARVE_OUT, HIT_RATIO being the fraction of accesses which persist (default: 1) and CARVE_OUT the number of bytes of L2 cache set aside for persisting accesses (default: the device's maximum)", cxxopts::value<string>())
+        ("shared-memory-carveout", "The percentage of a multiprocessor's maximum shared memory the kernel should prefer to have configured as shared memory, the rest of it serving as L1 cache (CUDA only; a hint)", cxxopts::value<int>())
         ("W,overwrite", "Overwrite the files for buffer and/or PTX output if they already exists", cxxopts::value<bool>()->default_value("false"))
         ("i,include", "Include a specific file into the kernels' translation unit", cxxopts::value<std::vector<string>>())
         ("I,include-path", "Add a directory to the search paths for header files included by the kernel (can be used repeatedly)", cxxopts::value<std::vector<string>>())
@@ -99,11 +155,25 @@ cxxopts::Options basic_cmdline_options(const char* program_name)
         ("K,kernel-key", "The key identifying the kernel among all registered runnable kernels", cxxopts::value<string>())
         ("L,list-kernels", "List the (keys of the) kernels which may be run with this program")
         ("z,zero-output-buffers", "Set the contents of output(-only) buffers to all-zeros", cxxopts::value<bool>()->default_value("false"))
+        ("generate-inputs", "Generate the contents of input buffers, rather than reading them from files, where the kernel adapter supports this", cxxopts::value<bool>()->default_value("false"))
         ("t,time-execution", "Use CUDA/OpenCL events to time the execution of each run of the kernel", cxxopts::value<bool>()->default_value("false"))
+        ("scan-output", "After each run, scan a floating-point output buffer on the device, reporting its numbers of NaN, infinite and subnormal elements, and its range (CUDA only); specify as BUFFER=TYPE, TYPE being float16, float32 or float64 (can be used repeatedly)", cxxopts::value<std::vector<string>>())
+        ("check-determinism", "Hash the output buffers on the device after each run, and report whether, and in which run, they first differed from those of the first run (CUDA only)", cxxopts::value<bool>()->default_value("false"))
+        ("verify-samples", "After the runs, verify this many randomly-chosen elements of each output buffer, as well as its first and last elements, against the kernel adapter's host-side reference (0 for no verification)", cxxopts::value<unsigned>()->default_value("0"))
+        ("host-reference", "Also run the kernel adapter's host-side reference implementation, on all cores, as many times as the kernel; check the outputs against its results, and report the speedup of the kernel over it", cxxopts::value<bool>()->default_value("false"))
+        ("verify-tolerance", "Maximum relative difference - or absolute difference, for values under 1 in magnitude - between a verified floating-point element and its reference value", cxxopts::value<double>()->default_value("1e-5"))
+        ("stream", "Process a stream of frames rather than a single set of inputs (CUDA only): Each input frame consists of the contents of all input buffers, in parameter order, with the sizes of the buffers read or generated as usual; and each output frame, likewise, of the output buffers", cxxopts::value<bool>()->default_value("false"))
+        ("stream-input", "Source of the input frames when streaming: A path, e.g. of a named pipe, or - for the standard input", cxxopts::value<string>()->default_value("-"))
+        ("stream-output", "Destination of the output frames when streaming: A path, e.g. of a named pipe, or - for the standard output (in which case logging goes to the standard error stream)", cxxopts::value<string>()->default_value("-"))
+        ("watch", "After running the kernel, keep watching its source file and the files it includes; whenever they change, rebuild the kernel and run it again, reusing the device-side buffers, and report the change in execution time (implies --time-execution)", cxxopts::value<bool>()->default_value("false"))
         ("language-standard", "Set the language standard to use for CUDA compilation (options: c++11, c++14, c++17)", cxxopts::value<string>())
         ("input-buffer-dir", "Base location for locating input buffers", cxxopts::value<string>()->default_value( filesystem::current_path().native() ))
         ("output-buffer-dir", "Base location for writing output buffers", cxxopts::value<string>()->default_value( filesystem::current_path().native() ))
         ("kernel-sources-dir", "Base location for locating kernel source files", cxxopts::value<string>()->default_value( filesystem::current_path().native() ))
+        ("pipeline", "Run a sequence of kernels, described in the specified file: One kernel per line, with the command-line options specific to that kernel", cxxopts::value<string>())
+        ("record", "Record everything necessary for replaying the run - sources, definitions, arguments, launch configuration, inputs and the compiled kernel - into a bundle file in the specified directory", cxxopts::value<string>())
+        ("replay", "Replay a run recorded into the specified directory, without recompiling the kernel; only the device, number of runs, timing and output options are taken from the command-line", cxxopts::value<string>())
+        ("bind", "Within a pipeline: Use an output buffer of an earlier kernel as an input buffer, keeping it on the device; specify as INPUT=STAGE:OUTPUT, STAGE being the 1-based index of the earlier kernel in the pipeline (can be used repeatedly)", cxxopts::value<std::vector<string>>())
         ("h,help", "Print usage information")
         ;
     return options;
@@ -316,6 +386,26 @@ void parse_command_line_for_kernel(int argc, char** argv, execution_context_t& c
         }
     }
 
+    auto all_buffer_names = util::union_(
+        buffer_names(ka, parameter_direction_t::input, parameter_direction_t::inout), ka.buffer_names(parameter_direction_t::output));
+    for(const auto& p : context.options.output_scans) {
+        util::contains(ka.buffer_names(parameter_direction_t::output), p.first) or
+        util::contains(ka.buffer_names(parameter_direction_t::inout), p.first) or
+            die("Output scan specified for {}, which is not an output buffer of the kernel", p.first);
+    }
+    for(const auto& p : context.options.element_conversions) {
+        const auto& buffer_name = p.first;
+        util::contains(all_buffer_names, buffer_name)
+            or die("Element conversion specified for {}, which is not a buffer parameter of the kernel", buffer_name);
+        auto input_find_result = context.buffers.filenames.inputs.find(buffer_name);
+        auto output_find_result = context.buffers.filenames.outputs.find(buffer_name);
+        if ((input_find_result != context.buffers.filenames.inputs.cend() and is_shared_buffer_spec(input_find_result->second)) or
+            (output_find_result != context.buffers.filenames.outputs.cend() and is_shared_buffer_spec(output_find_result->second)))
+        {
+            die("Element conversions are not supported for buffers in shared memory, such as {}", buffer_name);
+        }
+    }
+
     if (not context.options.compile_only) {
         parse_scalars(context, ka, parse_result);
     }
@@ -343,6 +433,19 @@ void parse_command_line_for_kernel(int argc, char** argv, execution_context_t& c
     finalize_preprocessor_definitions(context);
 }
 
+void set_scalar_argument(
+    execution_context_t&                               context,
+    const kernel_adapter&                              kernel_adapter,
+    const kernel_adapter::single_parameter_details&    spd,
+    const string&                                      arg_value)
+{
+    spdlog::trace("Parsing argument for scalar parameter '{}' from \"{}\"", spd.name, arg_value);
+    context.scalar_input_arguments.raw[spd.name] = arg_value;
+    context.scalar_input_arguments.typed[spd.name] =
+        kernel_adapter.parse_cmdline_scalar_argument(spd, arg_value);
+    spdlog::trace("Successfully parsed scalar argument {}", spd.name);
+}
+
 // Note: We need the kernel adapter, and can't just be satisfied with the argument details,
 // because the adapter might have overridden the parsing method with something more complex.
 // If we eventually decide that's not a useful ability to have, we can avoid passing the
@@ -360,12 +463,7 @@ void parse_scalars(
             die("Required scalar parameter {} for kernel {} was not specified.\n\n", param_name, kernel_adapter.key());
         }
         // TODO: Consider not parsing anything at this stage, and just marshaling all the scalar arguments together.
-        auto& arg_value = parse_result[param_name].as<string>();
-        spdlog::trace("Parsing argument for scalar parameter '{}' from \"{}\"", param_name, arg_value);
-        context.scalar_input_arguments.raw[param_name] = arg_value;
-        context.scalar_input_arguments.typed[param_name] =
-            kernel_adapter.parse_cmdline_scalar_argument(spd, arg_value);
-        spdlog::trace("Successfully parsed scalar argument {}", param_name);
+        set_scalar_argument(context, kernel_adapter, spd, parse_result[param_name].as<string>());
     }
 }
 
@@ -421,6 +519,52 @@ void print_registered_kernel_keys() {
     }
 }
 
+void apply_logging_options(const cxxopts::ParseResult& parse_result)
+{
+    auto log_level_name = parse_result["log-level"].as<string>();
+    auto log_level = spdlog::level::from_str(log_level_name);
+    if (spdlog::level_is_at_least(spdlog::level::debug)) {
+        spdlog::log(spdlog::level::debug, "Setting log level to {}", log_level_name);
+    }
+    spdlog::set_level(log_level);
+
+    auto log_flush_threshold_name = parse_result["log-flush-threshold"].as<string>();
+    auto log_flush_threshold = spdlog::level::from_str(log_flush_threshold_name);
+    spdlog::debug("Setting log level flush threshold to \"{}\"", log_flush_threshold_name);
+    spdlog::flush_on(log_flush_threshold);
+}
+
+// Parses BUFFER, BUFFER=HIT_RATIO or BUFFER=HIT_RATIO:CARVE_OUT
+l2_access_policy_window_t parse_l2_access_policy_window(const string& spec)
+{
+    l2_access_policy_window_t window;
+    auto equals_pos = spec.find('=');
+    window.buffer_name = spec.substr(0, equals_pos);
+    if (window.buffer_name.empty()) {
+        die("Invalid L2 access policy \"{}\": Expected BUFFER, BUFFER=HIT_RATIO or BUFFER=HIT_RATIO:CARVE_OUT", spec);
+    }
+    if (equals_pos == string::npos) { return window; }
+    auto colon_pos = spec.find(':', equals_pos + 1);
+    try {
+        std::size_t parsed_length;
+        auto hit_ratio_str = spec.substr(equals_pos + 1, colon_pos - equals_pos - 1);
+        window.hit_ratio = std::stof(hit_ratio_str, &parsed_length);
+        if (parsed_length != hit_ratio_str.length()) { throw std::invalid_argument("trailing characters"); }
+        if (colon_pos != string::npos) {
+            auto carve_out_str = spec.substr(colon_pos + 1);
+            window.persisting_l2_size = std::stoull(carve_out_str, &parsed_length);
+            if (parsed_length != carve_out_str.length()) { throw std::invalid_argument("trailing characters"); }
+        }
+    }
+    catch(std::exception& ex) {
+        die("Invalid L2 access policy \"{}\": {}", spec, ex.what());
+    }
+    if (not (window.hit_ratio >= 0.0f and window.hit_ratio <= 1.0f)) {
+        die("Invalid L2 access policy \"{}\": The hit ratio must be between 0 and 1", spec);
+    }
+    return window;
+}
+
 kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char** argv)
 {
     auto program_name = argv[0];
@@ -434,6 +578,18 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
 
     kernel_inspecific_cmdline_options_t parsed_options;
 
+    parsed_options.frame_stream.enabled = parse_result["stream"].as<bool>();
+    if (parsed_options.frame_stream.enabled) {
+        parsed_options.frame_stream.input = parse_result["stream-input"].as<string>();
+        parsed_options.frame_stream.output = parse_result["stream-output"].as<string>();
+        if (parsed_options.frame_stream.output == "-") {
+            // The standard output is reserved for the output frames. (The logger may already
+            // exist, if this is not the first set of options parsed, e.g. with a pipeline.)
+            auto stderr_logger = spdlog::get("stderr");
+            spdlog::set_default_logger(stderr_logger ? stderr_logger : spdlog::stderr_color_mt("stderr"));
+        }
+    }
+
     bool user_asked_for_help = contains(parse_result, "help");
         // Note that we will not immediately provide the help, because if we can figure
         // out what kernel was asked for, we will want to provide help regarding
@@ -464,17 +620,7 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
     // No need to exit (at least not until second parsing), let's
     // go ahead and collect the parsed data
 
-    auto log_level_name = parse_result["log-level"].as<string>();
-    auto log_level = spdlog::level::from_str(log_level_name);
-    if (spdlog::level_is_at_least(spdlog::level::debug)) {
-        spdlog::log(spdlog::level::debug, "Setting log level to {}", log_level_name);
-    }
-    spdlog::set_level(log_level);
-
-    auto log_flush_threshold_name = parse_result["log-flush-threshold"].as<string>();
-    auto log_flush_threshold = spdlog::level::from_str(log_flush_threshold_name);
-    spdlog::debug("Setting log level flush threshold to \"{}\"", log_flush_threshold_name);
-    spdlog::flush_on(log_flush_threshold);
+    apply_logging_options(parse_result);
 
     //---------------------------------------
     // CUDA and OpenCL-related options
@@ -643,6 +789,13 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
     }
 
     parsed_options.write_output_buffers_to_files = parse_result["write-output"].as<bool>();
+    parsed_options.map_output_files = parse_result["map-output-files"].as<bool>();
+    parsed_options.compress_output_files = parse_result["compress-outputs"].as<bool>();
+    auto output_file_sync = parse_result["sync-output-files"].as<string>();
+    if      (output_file_sync == "none")  { parsed_options.output_file_sync = output_file_sync_t::none;  }
+    else if (output_file_sync == "msync") { parsed_options.output_file_sync = output_file_sync_t::msync; }
+    else if (output_file_sync == "fsync") { parsed_options.output_file_sync = output_file_sync_t::fsync; }
+    else die("Invalid output file synchronization method \"{}\": Expected none, msync or fsync", output_file_sync);
     parsed_options.write_ptx_to_file = parse_result["write-ptx"].as<bool>();
     parsed_options.always_print_compilation_log = parse_result["print-compilation-log"].as<bool>();
 
@@ -663,7 +816,21 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
     }
     parsed_options.compile_in_debug_mode = parse_result["debug-mode"].as<bool>();
     parsed_options.zero_output_buffers = parse_result["zero-output-buffers"].as<bool>();
+    parsed_options.generate_inputs = parse_result["generate-inputs"].as<bool>();
     parsed_options.time_with_events = parse_result["time-execution"].as<bool>();
+    parsed_options.num_verification_samples = parse_result["verify-samples"].as<unsigned>();
+    parsed_options.run_host_reference = parse_result["host-reference"].as<bool>();
+    parsed_options.verification_tolerance = parse_result["verify-tolerance"].as<double>();
+    if (parsed_options.verification_tolerance < 0) die("The verification tolerance must be non-negative");
+    parsed_options.watch_sources = parse_result["watch"].as<bool>();
+    if (parsed_options.watch_sources) {
+        if (parsed_options.compile_only) die("Watching the kernel sources requires running the kernel, not just compiling it");
+        parsed_options.time_with_events = true;
+    }
+    if (parsed_options.frame_stream.enabled) {
+        if (not use_cuda) die("Streaming frames is only supported with CUDA");
+        if (parsed_options.watch_sources) die("Streaming frames and watching the kernel sources are mutually exclusive");
+    }
 
     if (parse_result.count("block-dimensions") > 0) {
         auto dims = parse_result["block-dimensions"].as<std::vector<unsigned>>();
@@ -701,6 +868,43 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
             parse_result["dynamic-shared-memory-size"].as<unsigned>();
     }
 
+    if (parse_result["cooperative"].as<bool>()) {
+        if (not use_cuda) die("Cooperative launches are only supported with CUDA");
+        parsed_options.forced_launch_config_components.cooperative = true;
+    }
+    if (parse_result.count("cluster-dimensions") > 0) {
+        if (not use_cuda) die("Thread-block clusters are only supported with CUDA");
+        auto dims = parse_result["cluster-dimensions"].as<std::vector<unsigned>>();
+        if (dims.empty() or dims.size() > 3) {
+            die("Invalid cluster dimensions: Got {} dimensions", dims.size());
+        }
+        while (dims.size() < 3) { dims.push_back(1u); }
+        if (std::find(dims.cbegin(), dims.cend(), 0u) != dims.cend()) {
+            die("Invalid cluster dimensions: Clusters can't be empty");
+        }
+        parsed_options.forced_launch_config_components.cluster_dimensions = { dims[0], dims[1], dims[2] };
+    }
+
+    if (parse_result.count("l2-persist") > 0) {
+        if (not use_cuda) die("L2 cache access policies are only supported with CUDA");
+        parsed_options.forced_launch_config_components.l2_access_policy_window =
+            parse_l2_access_policy_window(parse_result["l2-persist"].as<string>());
+    }
+
+    if (parse_result.count("shared-memory-carveout") > 0) {
+        if (not use_cuda) die("A shared memory carve-out can only be set with CUDA");
+        auto carveout = parse_result["shared-memory-carveout"].as<int>();
+        if (carveout < 0 or carveout > 100) {
+            die("Invalid shared memory carve-out {}: Expected a percentage, between 0 and 100", carveout);
+        }
+        parsed_options.forced_launch_config_components.preferred_shared_memory_carveout = carveout;
+    }
+
+    parsed_options.persistent_grid = parse_result["persistent-grid"].as<bool>();
+    if (parsed_options.persistent_grid and (parse_result.count("grid-dimensions") > 0 or parse_result.count("overall-grid-dimensions") > 0)) {
+        die("A persistent grid is sized to fill the device; grid dimensions can't also be specified");
+    }
+
 //    parsed_options.compare_outputs_against_expected = parse_results["compare-outputs"].as<string>();
 
     if (parse_result.count("define") > 0) {
@@ -728,6 +932,84 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
         }
     }
 
+    if (parse_result.count("bind") > 0) {
+        for(const auto& binding : parse_result["bind"].as<std::vector<string>>()) {
+            auto equals_pos = binding.find('=');
+            auto colon_pos = binding.find(':', equals_pos);
+            if (equals_pos == 0 or equals_pos == string::npos or colon_pos == string::npos or colon_pos + 1 == binding.length()) {
+                die("Invalid input buffer binding \"{}\": Expected INPUT=STAGE:OUTPUT", binding);
+            }
+            auto input_buffer_name = binding.substr(0, equals_pos);
+            std::size_t stage_number = std::strtoul(binding.substr(equals_pos + 1, colon_pos - equals_pos - 1).c_str(), nullptr, 10);
+            if (stage_number == 0) {
+                die("Invalid pipeline stage number in input buffer binding \"{}\"", binding);
+            }
+            auto insertion = parsed_options.input_buffer_bindings.emplace(input_buffer_name,
+                buffer_binding_t{ stage_number - 1, binding.substr(colon_pos + 1) });
+            insertion.second or die("Input buffer {} is bound more than once", input_buffer_name);
+            spdlog::trace("Input buffer {} bound to output buffer {} of pipeline stage {}",
+                input_buffer_name, insertion.first->second.output_buffer_name, stage_number);
+        }
+    }
+
+    parsed_options.check_determinism = parse_result["check-determinism"].as<bool>();
+    if (parsed_options.check_determinism and not use_cuda) die("Checking the determinism of the outputs is only supported with CUDA");
+    if (parse_result.count("scan-output") > 0) {
+        if (not use_cuda) die("Scanning outputs is only supported with CUDA");
+        for(const auto& scan_spec : parse_result["scan-output"].as<std::vector<string>>()) {
+            auto equals_pos = scan_spec.find('=');
+            if (equals_pos == 0 or equals_pos == string::npos) {
+                die("Invalid output scan \"{}\": Expected BUFFER=TYPE", scan_spec);
+            }
+            auto buffer_name = scan_spec.substr(0, equals_pos);
+            element_type_t type;
+            try {
+                type = parse_element_type(scan_spec.substr(equals_pos + 1));
+            }
+            catch(std::exception& ex) {
+                die("Invalid output scan \"{}\": {}", scan_spec, ex.what());
+            }
+            is_floating_point(type) or die("Invalid output scan \"{}\": Only floating-point buffers can be scanned", scan_spec);
+            auto insertion = parsed_options.output_scans.emplace(buffer_name, type);
+            insertion.second or die("Output buffer {} is to be scanned more than once", buffer_name);
+        }
+    }
+
+    if (parse_result.count("convert") > 0) {
+        for(const auto& conversion_spec : parse_result["convert"].as<std::vector<string>>()) {
+            auto equals_pos = conversion_spec.find('=');
+            if (equals_pos == 0 or equals_pos == string::npos) {
+                die("Invalid buffer element conversion \"{}\": Expected BUFFER=FROM:TO or BUFFER=FROM:TO:SCALE", conversion_spec);
+            }
+            auto buffer_name = conversion_spec.substr(0, equals_pos);
+            element_conversion_t conversion;
+            try {
+                conversion = parse_element_conversion(conversion_spec.substr(equals_pos + 1));
+            }
+            catch(std::exception& ex) {
+                die("Invalid buffer element conversion \"{}\": {}", conversion_spec, ex.what());
+            }
+            auto insertion = parsed_options.element_conversions.emplace(buffer_name, conversion);
+            insertion.second or die("More than one element conversion specified for buffer {}", buffer_name);
+            spdlog::trace("Buffer {} elements to be converted from {} to {}, scaled by {}", buffer_name,
+                element_type_name(conversion.from), element_type_name(conversion.to), conversion.scale);
+        }
+    }
+    // Streamed frames don't go through the usual runs, so nothing applied to those applies to them
+    if (parsed_options.frame_stream.enabled) {
+        if (not parsed_options.element_conversions.empty()) die("Buffer element conversions are not supported when streaming frames");
+        if (parsed_options.num_verification_samples > 0 or parsed_options.run_host_reference or parsed_options.check_determinism) {
+            die("Verifying outputs is not supported when streaming frames");
+        }
+        if (not parsed_options.output_scans.empty()) die("Scanning outputs is not supported when streaming frames");
+    }
+
+    if (contains(parse_result, "record")) {
+        parsed_options.record_directory = parse_result["record"].as<string>();
+        filesystem::is_directory(parsed_options.record_directory)
+            or die("No such directory for recording the run: {}", parsed_options.record_directory.native());
+    }
+
     if (not kernel_adapter::can_produce_subclass(string(parsed_options.kernel.key))) {
         die("No kernel adapter is registered for key {}", parsed_options.kernel.key);
     }
@@ -735,33 +1017,19 @@ kernel_inspecific_cmdline_options_t parse_command_line_initially(int argc, char*
     return parsed_options;
 }
 
-/**
- * Writes output buffers, generated by the kernel, to the files specified at the
- * command-line - one file per buffer.
- */
-void write_buffers_to_files(execution_context_t& context)
-{
-    spdlog::info("Writing output buffers to files.");
-    // Unfortunately, decent ranged-for iteration on maps is only possible with C++17
-    for(const auto& pair : context.buffers.host_side.outputs) {
-        const auto& buffer_name = pair.first;
-        const auto& buffer = pair.second;
-        auto write_destination = maybe_prepend_base_dir(
-               context.options.buffer_base_paths.output,
-               context.buffers.filenames.outputs[buffer_name]);
-        write_buffer_to_file(buffer_name, buffer, write_destination, context.options.overwrite_allowed);
-    }
-}
-
 // TODO: Yes, make execution_context_t a proper class... and be less lax with the initialization
-execution_context_t initialize_execution_context(kernel_inspecific_cmdline_options_t parsed_options)
+// When a device context donor is specified, its CUDA context or OpenCL context, device and queue
+// are used rather than new ones being created - so that device-side buffers can be shared with it
+execution_context_t initialize_execution_context(
+    kernel_inspecific_cmdline_options_t parsed_options,
+    const execution_context_t*          device_context_donor = nullptr)
 {
     // Somewhat redundant with later code
     ensure_gpu_device_validity(
         parsed_options.gpu_ecosystem,
         parsed_options.platform_id,
         parsed_options.gpu_device_id,
-        parsed_options.write_ptx_to_file);
+        parsed_options.write_ptx_to_file or not parsed_options.record_directory.empty());
 
     spdlog::debug("Initializing kernel execution context");
 
@@ -769,7 +1037,23 @@ execution_context_t initialize_execution_context(kernel_inspecific_cmdline_optio
     execution_context.options = parsed_options;
     execution_context.ecosystem = parsed_options.gpu_ecosystem;
 
-    if (parsed_options.gpu_ecosystem == execution_ecosystem_t::cuda) {
+    if (device_context_donor != nullptr) {
+        if (device_context_donor->ecosystem != parsed_options.gpu_ecosystem or
+            device_context_donor->options.gpu_device_id != parsed_options.gpu_device_id)
+        {
+            die("All kernels sharing device-side buffers must use the same ecosystem and device");
+        }
+        if (parsed_options.gpu_ecosystem == execution_ecosystem_t::cuda) {
+            // These copies do not own the context and stream
+            execution_context.cuda.context.emplace(device_context_donor->cuda.context.value());
+            execution_context.cuda.context_lifetime = device_context_donor->cuda.context_lifetime;
+            execution_context.cuda.stream.emplace(device_context_donor->cuda.stream.value());
+        }
+        execution_context.opencl.context = device_context_donor->opencl.context;
+        execution_context.opencl.device = device_context_donor->opencl.device;
+        execution_context.opencl.queue = device_context_donor->opencl.queue;
+    }
+    else if (parsed_options.gpu_ecosystem == execution_ecosystem_t::cuda) {
         initialize_execution_context<execution_ecosystem_t::cuda>(execution_context);
     }
     else { // OpenCL
@@ -783,23 +1067,152 @@ execution_context_t initialize_execution_context(kernel_inspecific_cmdline_optio
     return execution_context;
 }
 
+// Registers the pages of a shared buffer as pinned, so that copies to and from the device
+// can use DMA directly; the registration ends when the buffer is unmapped, or with the CUDA
+// context if that goes first
+void pin_shared_buffer(const execution_context_t& context, const string& buffer_name, mapped_shared_buffer& mapping, bool read_only)
+{
+    auto mapped = mapping.span();
+    if (context.ecosystem != execution_ecosystem_t::cuda or mapped.size() == 0) { return; }
+    cuda::context::current::scoped_override_t scoped_context_override{ *context.cuda.context };
+    unsigned flags { 0 };
+#if CUDA_VERSION >= 11010
+    if (read_only) { flags |= CU_MEMHOSTREGISTER_READ_ONLY; }
+#else
+    (void) read_only;
+#endif
+    auto status = cuMemHostRegister(mapped.data(), mapped.size(), flags);
+    if (status != CUDA_SUCCESS) {
+        spdlog::debug("Could not pin the shared memory of buffer '{}' (CUDA error {}); copying it as pageable memory",
+            buffer_name, (int) status);
+        return;
+    }
+    spdlog::debug("Pinned the shared memory of buffer '{}': {} bytes", buffer_name, mapped.size());
+    std::weak_ptr<void> context_lifetime { context.cuda.context_lifetime };
+    cuda::context_t cuda_context { *context.cuda.context }; // not owning the context
+    mapping.set_unmap_hook([context_lifetime, cuda_context](poor_mans_span mapped) {
+        if (context_lifetime.expired()) { return; }
+        cuda::context::current::scoped_override_t scoped_context_override{ cuda_context };
+        cuMemHostUnregister(mapped.data());
+    });
+}
+
+// The shared-memory mapping of an input buffer, if it has one, so that copies to the
+// device use the producer's memory directly
+poor_mans_span host_side_input_source(const execution_context_t& context, const string& buffer_name)
+{
+    auto find_result = context.buffers.shared.inputs.find(buffer_name);
+    return (find_result != context.buffers.shared.inputs.cend()) ?
+        find_result->second->span() : as_span(context.buffers.host_side.inputs.at(buffer_name));
+}
+
+bool output_is_compressed(const execution_context_t& context, const string& buffer_name)
+{
+    const auto& destination = context.buffers.filenames.outputs.at(buffer_name);
+    return not is_shared_buffer_spec(destination) and
+        (context.options.compress_output_files or is_compressed_buffer_file(destination));
+}
+
+// Whether an output buffer is to be copied from the device into a memory mapping of its
+// destination, rather than into its host-side buffer. Compressed or converted outputs can't be.
+bool output_is_mapped(const execution_context_t& context, const string& buffer_name)
+{
+    if (not context.options.write_output_buffers_to_files) { return false; }
+    auto find_result = context.buffers.filenames.outputs.find(buffer_name);
+    return find_result != context.buffers.filenames.outputs.cend() and
+        (is_shared_buffer_spec(find_result->second) or
+         (context.options.map_output_files and not output_is_compressed(context, buffer_name) and
+          not util::contains(context.options.element_conversions, buffer_name)));
+}
+
+std::shared_ptr<mapped_shared_buffer> map_output_destination(
+    const execution_context_t& context,
+    const string&              buffer_name,
+    std::size_t                size)
+{
+    const auto& destination = context.buffers.filenames.outputs.at(buffer_name);
+    std::shared_ptr<mapped_shared_buffer> mapping;
+    if (is_shared_buffer_spec(destination)) {
+        mapping = std::make_shared<mapped_shared_buffer>(destination, for_writing, size);
+    }
+    else {
+        auto path = maybe_prepend_base_dir(context.options.buffer_base_paths.output, destination);
+        verify_path(path, for_writing, context.options.overwrite_allowed);
+        spdlog::debug("Writing output buffer '{}' through a memory mapping of {}", buffer_name, path.native());
+        mapping = std::make_shared<mapped_shared_buffer>(path, size);
+    }
+    pin_shared_buffer(context, buffer_name, *mapping, false);
+    return mapping;
+}
+
+std::size_t device_side_buffer_size(execution_ecosystem_t ecosystem, const device_buffer_type& buffer)
+{
+    if (ecosystem == execution_ecosystem_t::cuda) {
+        return buffer.cuda.size();
+    }
+    size_t size;
+    buffer.opencl.getInfo(CL_MEM_SIZE, &size);
+    return size;
+}
+
 void copy_buffer_to_device(
     const execution_context_t& context,
     const string&              buffer_name,
     const device_buffer_type&  device_side_buffer,
-    const host_buffer_type&    host_side_buffer)
+    poor_mans_span             host_side_buffer,
+    std::size_t                device_side_offset = 0)
 {
     if (context.ecosystem == execution_ecosystem_t::cuda) {
         spdlog::debug("Copying buffer '{}' (size {} bytes): host-side {} -> device-side {}",
             buffer_name, host_side_buffer.size(), (void *) host_side_buffer.data(),
-            (void *) device_side_buffer.cuda.data());
+            (void *) (device_side_buffer.cuda.data() + device_side_offset));
         cuda::context::current::scoped_override_t scoped_context_override{ *context.cuda.context };
-        cuda::memory::copy(device_side_buffer.cuda.data(), host_side_buffer.data(), host_side_buffer.size());
+        cuda::memory::copy(device_side_buffer.cuda.data() + device_side_offset, host_side_buffer.data(), host_side_buffer.size());
     } else { // OpenCL
         const constexpr auto blocking { CL_TRUE };
-        context.opencl.queue.enqueueWriteBuffer(device_side_buffer.opencl, blocking, 0, host_side_buffer.size(),
-            host_side_buffer.data());
+        context.opencl.queue.enqueueWriteBuffer(device_side_buffer.opencl, blocking, device_side_offset,
+            host_side_buffer.size(), host_side_buffer.data());
+    }
+}
+
+// The padding the adapter requires for an input buffer's device-side copy, if any
+optional<kernel_adapter::input_padding_t> input_padding(const execution_context_t& context, const string& buffer_name)
+{
+    const auto& ka = *context.kernel_adapter_;
+    auto paddings = ka.input_buffer_padding(context);
+    auto find_result = paddings.find(buffer_name);
+    if (find_result == paddings.cend() or
+        util::contains(context.buffers.device_side.bound_inputs, buffer_name) or
+        util::contains(ka.buffer_names(parameter_direction_t::inout), buffer_name))
+    {
+        return nullopt;
+    }
+    const auto& padding = find_result->second;
+    (padding.multiple > 0 and padding.element_size > 0 and padding.multiple % padding.element_size == 0)
+        or die("Invalid padding for input buffer '{}': to a multiple of {} bytes, with elements of {} bytes",
+            buffer_name, padding.multiple, padding.element_size);
+    return padding;
+}
+
+std::size_t padded_input_size(const execution_context_t& context, const string& buffer_name, std::size_t size)
+{
+    auto padding = input_padding(context, buffer_name);
+    return padding ? util::round_up(size, padding->multiple) : size;
+}
+
+host_buffer_type input_padding_contents(
+    const kernel_adapter::input_padding_t&  padding,
+    poor_mans_span                          contents,
+    std::size_t                             padding_size)
+{
+    host_buffer_type result(padding_size); // zero-filled
+    if (padding.fill == kernel_adapter::input_padding_t::with_last_element and contents.size() >= padding.element_size) {
+        const auto* last_element = contents.data() + contents.size() - padding.element_size;
+        for(std::size_t pos = 0; pos < padding_size; pos += padding.element_size) {
+            std::memcpy(result.data() + pos, last_element, std::min(padding.element_size, padding_size - pos));
+        }
     }
+    return result;
 }
 
 void copy_buffer_on_device(
@@ -823,17 +1236,24 @@ void copy_input_buffers_to_device(const execution_context_t& context)
     spdlog::debug("Copying inputs to device.");
     for(const auto& input_pair : context.buffers.host_side.inputs) {
         const auto& name = input_pair.first;
-        const auto& host_side_buffer = input_pair.second;
+        if (util::contains(context.buffers.device_side.bound_inputs, name)) { continue; }
         const auto& device_side_buffer = context.buffers.device_side.inputs.at(name);
+        auto host_side_buffer = host_side_input_source(context, name);
         copy_buffer_to_device(context, name, device_side_buffer, host_side_buffer);
-
+        auto padding = input_padding(context, name);
+        if (not padding) { continue; }
+        auto padding_size = device_side_buffer_size(context.ecosystem, device_side_buffer) - host_side_buffer.size();
+        if (padding_size == 0) { continue; }
+        spdlog::debug("Padding the GPU-side copy of '{}' with {} bytes.", name, padding_size);
+        auto padding_contents = input_padding_contents(*padding, host_side_buffer, padding_size);
+        copy_buffer_to_device(context, name, device_side_buffer, as_span(padding_contents), host_side_buffer.size());
     }
 
     spdlog::debug("Copying in-out buffers to a 'pristine' copy on the device (which will not be altered).");
     for(const auto& buffer_name : context.kernel_adapter_->buffer_names(parameter_direction_t::inout)  ) {
-        auto& host_side_buffer = context.buffers.host_side.inputs.at(buffer_name);
+        if (util::contains(context.buffers.device_side.bound_inputs, buffer_name)) { continue; }
         const auto& device_side_buffer = context.buffers.device_side.inputs.at(buffer_name);
-        copy_buffer_to_device(context, buffer_name, device_side_buffer, host_side_buffer);
+        copy_buffer_to_device(context, buffer_name, device_side_buffer, host_side_input_source(context, buffer_name));
     }
 }
 
@@ -842,40 +1262,15 @@ void copy_buffer_to_host(
     //const execution_context_t& context,
     cl::CommandQueue*          opencl_queue,
     const device_buffer_type&  device_side_buffer,
-    host_buffer_type&          host_side_buffer)
+    poor_mans_span             host_side_buffer,
+    std::size_t                device_side_offset = 0)
 {
     if (ecosystem == execution_ecosystem_t::cuda) {
-        cuda::memory::copy(host_side_buffer.data(), device_side_buffer.cuda.data(), host_side_buffer.size());
+        cuda::memory::copy(host_side_buffer.data(), device_side_buffer.cuda.data() + device_side_offset, host_side_buffer.size());
     } else {
         // OpenCL
         const constexpr auto blocking { CL_TRUE };
-        constexpr const auto no_offset { 0 };
-        opencl_queue->enqueueReadBuffer(device_side_buffer.opencl, blocking, no_offset, host_side_buffer.size(), host_side_buffer.data());
-    }
-}
-
-// Note: must take the context as non-const, since it has vector members, and vectors
-// are value-types, not reference-types, i.e. copying into those vectors changes
-// the context.
-void copy_outputs_from_device(execution_context_t& context)
-{
-    spdlog::debug("Copying outputs back to host memory.");
-    for(auto& output_pair : context.buffers.host_side.outputs) {
-        const auto& name = output_pair.first;
-        auto& host_side_buffer = output_pair.second;
-        const auto& device_side_buffer = context.buffers.device_side.outputs.at(name);
-        spdlog::trace("Copying device output buffer to host output buffer for {}", name);
-        copy_buffer_to_host(
-            context.ecosystem,
-            &context.opencl.queue,
-            device_side_buffer,
-            host_side_buffer);
-    }
-    if (context.ecosystem == execution_ecosystem_t::cuda) {
-        context.cuda.context->synchronize();
-    }
-    else {
-        context.opencl.queue.finish();
+        opencl_queue->enqueueReadBuffer(device_side_buffer.opencl, blocking, device_side_offset, host_side_buffer.size(), host_side_buffer.data());
     }
 }
 
@@ -965,11 +1360,19 @@ void zero_output_buffers(execution_context_t& context)
 void create_device_side_buffers(execution_context_t& context)
 {
     spdlog::debug("Creating device buffers.");
-    context.buffers.device_side.inputs = create_device_side_buffers(
-        context.ecosystem,
-        context.cuda.context,
-        context.opencl.context,
-        context.buffers.host_side.inputs);
+    for(const auto& p : context.buffers.host_side.inputs) {
+        const auto& name = p.first;
+        auto find_result = context.buffers.device_side.bound_inputs.find(name);
+        if (find_result != context.buffers.device_side.bound_inputs.cend()) {
+            spdlog::debug("Using an output buffer of an earlier kernel as the GPU-side buffer for '{}'.", name);
+            context.buffers.device_side.inputs.emplace(name, find_result->second);
+            continue;
+        }
+        auto size = padded_input_size(context, name, p.second.size());
+        spdlog::debug("Creating GPU-side buffer for '{}' of size {} bytes.", name, size);
+        context.buffers.device_side.inputs.emplace(name, create_device_side_buffer(
+            name, size, context.ecosystem, context.cuda.context, context.opencl.context, context.buffers.host_side.inputs));
+    }
     spdlog::debug("Input device buffers created.");
     context.buffers.device_side.outputs = create_device_side_buffers(
         context.ecosystem,
@@ -981,6 +1384,20 @@ void create_device_side_buffers(execution_context_t& context)
     spdlog::debug("Output device buffers created.");
 }
 
+void create_scratch_buffers(execution_context_t& context)
+{
+    auto sizes = context.kernel_adapter_->scratch_buffer_sizes(context);
+    if (sizes.empty()) { return; }
+    spdlog::debug("Creating {} device-side scratch buffers.", sizes.size());
+    for(const auto& p : sizes) {
+        const auto& name = p.first;
+        auto size = p.second;
+        spdlog::debug("Creating scratch buffer '{}' of size {} bytes.", name, size);
+        context.buffers.device_side.scratch.emplace(name,
+            create_device_side_buffer(name, size, context.ecosystem, context.cuda.context, context.opencl.context, {}));
+    }
+}
+
 // Note: Will create buffers also for each inout buffers
 void create_host_side_output_buffers(execution_context_t& context)
 {
@@ -1013,6 +1430,22 @@ void create_host_side_output_buffers(execution_context_t& context)
     );
 }
 
+// Kernels may expect a structure of arrays where the buffer file holds an array of records
+void transpose_input_to_planar(execution_context_t& context, const string& buffer_name, const record_layout_t& layout)
+{
+    auto& buffer = context.buffers.host_side.inputs.at(buffer_name);
+    host_buffer_type planar(buffer.size());
+    try {
+        interleaved_to_planar(layout, as_span(buffer), as_span(planar), util::default_num_threads());
+    }
+    catch(std::exception& ex) {
+        die("Failed transposing the records of input buffer '{}' into field arrays: {}", buffer_name, ex.what());
+    }
+    buffer.swap(planar);
+    spdlog::debug("Transposed input buffer '{}' from {} records of {} fields each into field arrays",
+        buffer_name, buffer.size() / layout.record_size(), layout.field_sizes.size());
+}
+
 void read_buffers_from_files(execution_context_t& context)
 {
     spdlog::debug("Reading input buffers.");
@@ -1020,11 +1453,66 @@ void read_buffers_from_files(execution_context_t& context)
         *context.kernel_adapter_,
         parameter_direction_t::input,
         parameter_direction_t::inout);
-    context.buffers.host_side.inputs =
+    for(const auto& bound : context.buffers.device_side.bound_inputs) {
+        buffer_names_to_read_from_files.erase(bound.first);
+    }
+    auto layouts = context.kernel_adapter_->interleaved_buffer_layouts(context);
+    parameter_name_set names_of_read_buffers; // Only those read from files or shared memory; not generated or bound ones
+    for(const auto& name : buffer_names(*context.kernel_adapter_, parameter_direction_t::input, parameter_direction_t::inout)) {
+        const auto& buffer_spec = context.buffers.filenames.inputs.at(name);
+        if (not util::contains(buffer_names_to_read_from_files, name) or not is_shared_buffer_spec(buffer_spec)) { continue; }
+        auto mapping = std::make_shared<mapped_shared_buffer>(buffer_spec, for_reading);
+        auto mapped = mapping->span();
+        spdlog::debug("Using shared buffer {} as input buffer '{}': {} bytes", buffer_spec, name, mapped.size());
+        context.buffers.host_side.inputs.emplace(name, host_buffer_type(mapped.data(), mapped.data() + mapped.size()));
+        if (not util::contains(layouts, name)) {
+            // A transposed input is copied to the device from its host-side buffer instead,
+            // so there's no point in pinning - nor in keeping - its mapping
+            pin_shared_buffer(context, name, *mapping, true);
+            context.buffers.shared.inputs.emplace(name, std::move(mapping));
+        }
+        buffer_names_to_read_from_files.erase(name);
+        names_of_read_buffers.insert(name);
+    }
+    host_buffers_map generated_buffers;
+    if (context.options.generate_inputs) {
+        for(const auto& name : buffer_names_to_read_from_files) {
+            auto generated = context.kernel_adapter_->generate_input_buffer(context, name);
+            if (generated) {
+                spdlog::debug("Generated input buffer '{}': {} bytes", name, generated->size());
+                generated_buffers.emplace(name, std::move(generated.value()));
+            }
+        }
+        for(const auto& generated : generated_buffers) {
+            buffer_names_to_read_from_files.erase(generated.first);
+        }
+    }
+    auto read_buffers =
         read_buffers_from_files(
             buffer_names_to_read_from_files,
             context.buffers.filenames.inputs,
-            context.options.buffer_base_paths.input);
+            context.options.buffer_base_paths.input,
+            context.options.element_conversions);
+    for(auto& read_buffer : read_buffers) {
+        context.buffers.host_side.inputs.emplace(read_buffer.first, std::move(read_buffer.second));
+        names_of_read_buffers.insert(read_buffer.first);
+    }
+    for(const auto& name : names_of_read_buffers) {
+        auto find_result = layouts.find(name);
+        if (find_result != layouts.cend()) {
+            transpose_input_to_planar(context, name, find_result->second);
+        }
+    }
+    for(auto& generated : generated_buffers) {
+        context.buffers.host_side.inputs.emplace(generated.first, std::move(generated.second));
+    }
+    for(const auto& bound : context.buffers.device_side.bound_inputs) {
+        // The contents are only produced on the device, when the pipeline runs; but the adapter
+        // still needs the host-side buffer for its size calculations and checks
+        auto size = device_side_buffer_size(context.ecosystem, bound.second);
+        spdlog::debug("Input buffer '{}' is bound to the output of an earlier kernel: {} bytes", bound.first, size);
+        context.buffers.host_side.inputs.emplace(bound.first, host_buffer_type(size));
+    }
 }
 
 void finalize_kernel_function_name(execution_context_t& context)
@@ -1054,9 +1542,24 @@ void finalize_kernel_function_name(execution_context_t& context)
     }
 }
 
-bool build_kernel(execution_context_t& context)
+// Builds the main kernel function, and any additional ones used by the adapter's launch steps
+// or requested by the caller (e.g. for other kernels sharing this build)
+bool build_kernel(execution_context_t& context, const std::vector<string>& functions_for_other_kernels = {})
 {
     finalize_kernel_function_name(context);
+    auto additional_kernel_functions = context.kernel_adapter_->additional_kernel_functions(context);
+    for(const auto& function_name : functions_for_other_kernels) {
+        if (function_name != context.options.kernel.function_name and
+            not util::contains(additional_kernel_functions, function_name))
+        {
+            additional_kernel_functions.push_back(function_name);
+        }
+    }
+    if (not additional_kernel_functions.empty()) {
+        std::ostringstream oss;
+        oss << additional_kernel_functions;
+        spdlog::debug("Also building the kernel functions: {}", oss.str());
+    }
     const auto& source_file = context.options.kernel.source_file;
     spdlog::debug("Reading the kernel from {}", source_file.native());
     auto kernel_source_buffer = read_file_as_null_terminated_string(source_file);
@@ -1069,6 +1572,7 @@ bool build_kernel(execution_context_t& context)
             source_file.c_str(),
             kernel_source,
             context.options.kernel.function_name.c_str(),
+            additional_kernel_functions,
             context.options.compile_in_debug_mode,
             context.options.generate_line_info,
             context.options.language_standard,
@@ -1082,6 +1586,7 @@ bool build_kernel(execution_context_t& context)
             context.cuda.module = std::move(result.module);
             context.compiled_ptx = std::move(result.ptx);
             context.cuda.mangled_kernel_signature = std::move(result.mangled_signature);
+            context.cuda.mangled_kernel_signatures = std::move(result.mangled_signatures);
         }
     }
     else {
@@ -1090,10 +1595,12 @@ bool build_kernel(execution_context_t& context)
             context.opencl.device,
             context.device_id,
             context.options.kernel.function_name.c_str(),
+            additional_kernel_functions,
             kernel_source,
             context.options.compile_in_debug_mode,
             context.options.generate_line_info,
-            context.options.write_ptx_to_file,
+            context.options.write_ptx_to_file or not context.options.record_directory.empty(),
+                // A recording must include the program binary
             context.finalized_include_dir_paths,
             context.options.preinclude_files,
             context.finalized_preprocessor_definitions.valueless,
@@ -1104,6 +1611,7 @@ bool build_kernel(execution_context_t& context)
             context.opencl.program = std::move(result.program);
             context.compiled_ptx = std::move(result.ptx);
             context.opencl.built_kernel = std::move(result.kernel);
+            context.opencl.built_kernels = std::move(result.kernels);
         }
     }
     if (build_succeeded) {
@@ -1148,7 +1656,14 @@ void verify_input_arguments(execution_context_t& context)
 
     ka.input_sizes_are_valid(context) or die("Inputs are invalid, cannot execute kernel");
 
-    if (not context.kernel_adapter_->extra_validity_checks(context)) {
+    bool passed_extra_checks;
+    try {
+        passed_extra_checks = context.kernel_adapter_->extra_validity_checks(context);
+    }
+    catch(std::exception& ex) {
+        die("Invalid kernel configuration: {}", ex.what());
+    }
+    if (not passed_extra_checks) {
         // TODO: Have the kernel adapter report an error instead of just a boolean;
         // but we don't want it to know about spdlog, so it should probably
         // return a runtime_error (?)
@@ -1183,49 +1698,283 @@ void reset_working_copy_of_inout_buffers(execution_context_t& context)
     context.cuda.context->synchronize();
 }
 
+void report_work_rates(const execution_context_t& context, run_index_t run_index, execution_duration_type duration)
+{
+    if (duration.count() <= 0) { return; }
+    using seconds = std::chrono::duration<double>;
+    auto seconds_elapsed = std::chrono::duration_cast<seconds>(duration).count();
+    for(const auto& work : context.kernel_adapter_->work_per_run(context)) {
+        spdlog::info("Work rate for run {} of kernel {}: {:.3f} {}/s",
+            run_index+1, context.kernel_adapter_->kernel_function_name(), work.amount / seconds_elapsed, work.unit);
+    }
+}
+
 void perform_single_run(execution_context_t& context, run_index_t run_index)
 {
     spdlog::info("Preparing for kernel run {} of {} (1-based).", run_index+1, context.options.num_runs);
-    if (context.options.zero_output_buffers) {
+    if (context.options.zero_output_buffers or context.kernel_adapter_->requires_zeroed_outputs(context)) {
         zero_output_buffers(context);
     }
     reset_working_copy_of_inout_buffers(context);
 
-    if (context.ecosystem == execution_ecosystem_t::cuda) {
-        launch_time_and_sync_cuda_kernel(context, run_index);
-    }
-    else {
+    auto duration = (context.ecosystem == execution_ecosystem_t::cuda) ?
+        launch_time_and_sync_cuda_kernel(context, run_index) :
         launch_time_and_sync_opencl_kernel(context, run_index);
-    }
 
     spdlog::debug("Kernel execution run complete.");
+    if (duration) {
+        context.run_durations.push_back(*duration);
+        report_work_rates(context, run_index, *duration);
+    }
+    scan_floating_point_outputs(context, run_index);
+    check_output_determinism(context, run_index);
 }
 
 void finalize_kernel_arguments(execution_context_t& context)
 {
+    context.launch_steps = context.kernel_adapter_->launch_steps(context);
+    if (not context.launch_steps.empty()) {
+        spdlog::debug("Kernel adapter has marshaled the arguments for each of its {} launch steps.", context.launch_steps.size());
+        return;
+    }
     spdlog::debug("Marshaling kernel arguments.");
     context.finalized_arguments = context.kernel_adapter_->marshal_kernel_arguments(context);
 }
 
+// A cooperative launch fails unless all of the grid's blocks can be resident at once; we check this
+// ahead of time, so as to report the limit rather than just the driver's error
+void validate_cooperative_launch(
+    const execution_context_t&                 context,
+    const optional_launch_config_components_t& components,
+    const std::string&                         kernel_function = {})
+{
+    if (not components.cooperative.value_or(false)) { return; }
+    if (context.ecosystem != execution_ecosystem_t::cuda) {
+        die("Cooperative launches are only supported with CUDA");
+    }
+    if (not context.cuda.context->device().get_attribute(CU_DEVICE_ATTRIBUTE_COOPERATIVE_LAUNCH)) {
+        die("GPU device {} does not support cooperative launches", context.options.gpu_device_id);
+    }
+    const auto& gd = components.grid_dimensions.value();
+    const auto& bd = components.block_dimensions.value();
+    auto num_blocks = gd[0] * gd[1] * gd[2];
+    auto block_size = bd[0] * bd[1] * bd[2];
+    auto dynamic_shared_memory_size = components.dynamic_shared_memory_size.value_or(0);
+    auto max_blocks = max_co_resident_blocks(context, block_size, dynamic_shared_memory_size, kernel_function);
+    if (num_blocks > max_blocks) {
+        die("A cooperative launch{} of {} blocks of {} threads, using {} bytes of dynamic shared memory each, "
+            "exceeds the maximum of {} co-resident blocks on GPU device {}",
+            kernel_function.empty() ? "" : " of kernel function " + kernel_function,
+            num_blocks, block_size, dynamic_shared_memory_size, max_blocks, context.options.gpu_device_id);
+    }
+    spdlog::debug("Cooperative launch of {} blocks, out of at most {} co-resident ones", num_blocks, max_blocks);
+}
+
+// Checks the launch attributes beyond the basic configuration against the capabilities of the
+// device, and applies those which aren't passed with each launch: the kernel function's preferred
+// shared memory carve-out, and the part of the L2 cache set aside for persisting accesses
+void prepare_launch_attributes(
+    execution_context_t&                 context,
+    optional_launch_config_components_t& components,
+    const string&                        kernel_function = {})
+{
+    if (not components.has_extended_launch_attributes() and not components.preferred_shared_memory_carveout) { return; }
+    if (context.ecosystem != execution_ecosystem_t::cuda) {
+        die("CUDA launch attributes can't be set for an OpenCL kernel");
+    }
+    const auto& function_name = kernel_function.empty() ? context.options.kernel.function_name : kernel_function;
+    auto device_id = context.options.gpu_device_id;
+    auto device = context.cuda.context->device();
+    cuda::context::current::scoped_override_t context_for_this_scope(*context.cuda.context);
+    auto kernel = built_cuda_kernel(context, kernel_function);
+    auto check = [&](CUresult status, const char* action) {
+        if (status != CUDA_SUCCESS) {
+            die("Failed {} for kernel function {}: CUDA driver error {}", action, function_name, (int) status);
+        }
+    };
+
+    if (components.preferred_shared_memory_carveout) {
+        auto carveout = components.preferred_shared_memory_carveout.value();
+        if (device.get_attribute(CU_DEVICE_ATTRIBUTE_COMPUTE_CAPABILITY_MAJOR) < 7) {
+            spdlog::warn("GPU device {} has a fixed split between L1 cache and shared memory; ignoring the preferred shared memory carve-out",
+                device_id);
+        }
+        else {
+            check(cuFuncSetAttribute(kernel.handle(), CU_FUNC_ATTRIBUTE_PREFERRED_SHARED_MEMORY_CARVEOUT, carveout),
+                "setting the preferred shared memory carve-out");
+            int static_shared_memory_size;
+            check(cuFuncGetAttribute(&static_shared_memory_size, CU_FUNC_ATTRIBUTE_SHARED_SIZE_BYTES, kernel.handle()),
+                "obtaining the static shared memory size");
+            auto shared_memory_per_block = (std::size_t) static_shared_memory_size + components.dynamic_shared_memory_size.value_or(0);
+            auto preferred_shared_memory = (std::size_t) device.get_attribute(CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_MULTIPROCESSOR) * carveout / 100;
+            if (shared_memory_per_block > preferred_shared_memory) {
+                spdlog::warn("Kernel function {} uses {} bytes of shared memory per block, more than the preferred carve-out of {}% ({} bytes); "
+                    "the driver will use a larger carve-out", function_name, shared_memory_per_block, carveout, preferred_shared_memory);
+            }
+            spdlog::info("Launch configuration: Preferred shared memory carve-out: {}%", carveout);
+        }
+    }
+    if (not components.has_extended_launch_attributes()) { return; }
+#if CUDA_VERSION >= 12000
+    if (components.cluster_dimensions) {
+        if (not device.get_attribute(CU_DEVICE_ATTRIBUTE_CLUSTER_LAUNCH)) {
+            die("GPU device {} does not support thread-block clusters", device_id);
+        }
+        const auto& cd = components.cluster_dimensions.value();
+        const auto& gd = components.grid_dimensions.value();
+        if (gd[0] % cd[0] != 0 or gd[1] % cd[1] != 0 or gd[2] % cd[2] != 0) {
+            die("The cluster dimensions, {} x {} x {} blocks, don't divide the grid dimensions, {} x {} x {} blocks",
+                cd[0], cd[1], cd[2], gd[0], gd[1], gd[2]);
+        }
+        auto cluster_size = cd[0] * cd[1] * cd[2];
+        constexpr const std::size_t max_portable_cluster_size { 8 };
+        if (cluster_size > max_portable_cluster_size) {
+            check(cuFuncSetAttribute(kernel.handle(), CU_FUNC_ATTRIBUTE_NON_PORTABLE_CLUSTER_SIZE_ALLOWED, 1),
+                "allowing non-portable cluster sizes");
+        }
+        CUlaunchAttribute cluster_attribute {};
+        cluster_attribute.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+        cluster_attribute.value.clusterDim.x = (unsigned) cd[0];
+        cluster_attribute.value.clusterDim.y = (unsigned) cd[1];
+        cluster_attribute.value.clusterDim.z = (unsigned) cd[2];
+        const auto& bd = components.block_dimensions.value();
+        CUlaunchConfig config {};
+        config.gridDimX = (unsigned) gd[0];
+        config.gridDimY = (unsigned) gd[1];
+        config.gridDimZ = (unsigned) gd[2];
+        config.blockDimX = (unsigned) bd[0];
+        config.blockDimY = (unsigned) bd[1];
+        config.blockDimZ = (unsigned) bd[2];
+        config.sharedMemBytes = (unsigned) components.dynamic_shared_memory_size.value_or(0);
+        config.attrs = &cluster_attribute;
+        config.numAttrs = 1;
+        int max_cluster_size;
+        check(cuOccupancyMaxPotentialClusterSize(&max_cluster_size, kernel.handle(), &config),
+            "determining the maximum cluster size");
+        if (cluster_size > (std::size_t) max_cluster_size) {
+            die("Clusters of {} blocks exceed the maximum cluster size of kernel function {} on GPU device {}, with this launch configuration: {} blocks",
+                cluster_size, function_name, device_id, max_cluster_size);
+        }
+        spdlog::info("Launch configuration: Cluster dimensions: {:>9} x {:>5} x {:>5} blocks", cd[0], cd[1], cd[2]);
+    }
+    if (components.l2_access_policy_window) {
+        auto& window = components.l2_access_policy_window.value();
+        auto buffer = find_device_side_buffer(context, window.buffer_name);
+        if (buffer == nullptr) {
+            die("L2 access policy window specified for {}, which is not a buffer of kernel {}", window.buffer_name, context.options.kernel.key);
+        }
+        auto max_persisting_l2_size = (std::size_t) device.get_attribute(CU_DEVICE_ATTRIBUTE_MAX_PERSISTING_L2_CACHE_SIZE);
+        if (max_persisting_l2_size == 0) {
+            die("GPU device {} does not support persisting L2 cache accesses", device_id);
+        }
+        auto persisting_l2_size = window.persisting_l2_size.value_or(max_persisting_l2_size);
+        if (persisting_l2_size > max_persisting_l2_size) {
+            die("The L2 cache carve-out for persisting accesses, {} bytes, exceeds the maximum of {} bytes on GPU device {}",
+                persisting_l2_size, max_persisting_l2_size, device_id);
+        }
+        check(cuCtxSetLimit(CU_LIMIT_PERSISTING_L2_CACHE_SIZE, persisting_l2_size), "setting the L2 cache carve-out for persisting accesses");
+        auto max_window_size = (std::size_t) device.get_attribute(CU_DEVICE_ATTRIBUTE_MAX_ACCESS_POLICY_WINDOW_SIZE);
+        window.num_bytes = std::min(buffer->cuda.size(), max_window_size);
+        if (window.num_bytes.value() < buffer->cuda.size()) {
+            spdlog::warn("The L2 access policy window only covers the first {} bytes of the {} bytes of buffer {} - the maximum window size of GPU device {}",
+                window.num_bytes.value(), buffer->cuda.size(), window.buffer_name, device_id);
+        }
+        spdlog::info("Launch configuration: L2 access policy window: {} bytes of buffer {}, hit ratio {}, persisting L2 carve-out of {} bytes",
+            window.num_bytes.value(), window.buffer_name, window.hit_ratio, persisting_l2_size);
+    }
+#else
+    die("Thread-block clusters and L2 access policy windows require CUDA 12.0 or later");
+#endif
+}
+
 void configure_launch(execution_context_t& context)
 {
+    if (not context.launch_steps.empty()) {
+        const auto& forced = context.options.forced_launch_config_components;
+        if (context.options.persistent_grid or forced.cooperative or forced.has_extended_launch_attributes() or
+            forced.preferred_shared_memory_carveout)
+        {
+            die("The launch configurations of kernel {}'s launch steps are determined by its adapter; "
+                "they can't be made persistent or cooperative, nor given launch attributes, from the command-line",
+                context.options.kernel.key);
+        }
+        for(auto& step : context.launch_steps) {
+            step.launch_config_components.deduce_missing();
+            validate_cooperative_launch(context, step.launch_config_components, step.kernel_function);
+            prepare_launch_attributes(context, step.launch_config_components, step.kernel_function);
+            step.launch_config = realize_launch_config(step.launch_config_components, context.ecosystem);
+        }
+        spdlog::info("Each run consists of {} kernel launches, with launch configurations determined by the kernel adapter",
+            context.launch_steps.size());
+        return;
+    }
     spdlog::debug("Creating a launch configuration.");
-    auto lc_components = context.kernel_adapter_->make_launch_config(context);
+    const auto& forced = context.options.forced_launch_config_components;
+    optional_launch_config_components_t lc_components;
+    if (context.options.persistent_grid and forced.block_dimensions) {
+        // The grid is about to be set, so the adapter needn't deduce anything
+        lc_components = forced;
+        if (not lc_components.dynamic_shared_memory_size) { lc_components.dynamic_shared_memory_size = 0; }
+    }
+    else {
+        lc_components = context.kernel_adapter_->make_launch_config(context);
+    }
+    if (forced.cooperative) { lc_components.cooperative = forced.cooperative; }
+    if (forced.cluster_dimensions) { lc_components.cluster_dimensions = forced.cluster_dimensions; }
+    if (forced.l2_access_policy_window) { lc_components.l2_access_policy_window = forced.l2_access_policy_window; }
+    if (forced.preferred_shared_memory_carveout) {
+        lc_components.preferred_shared_memory_carveout = forced.preferred_shared_memory_carveout;
+    }
+    if (context.options.persistent_grid) {
+        set_persistent_grid(lc_components, context);
+    }
     lc_components.deduce_missing();
+    validate_cooperative_launch(context, lc_components);
     context.kernel_launch_configuration = realize_launch_config(lc_components, context.ecosystem);
+    context.kernel_launch_config_components = lc_components;
 
     auto gd = lc_components.grid_dimensions.value();
     auto bd = lc_components.block_dimensions.value();
     auto ogd = lc_components.overall_grid_dimensions.value();
 
     spdlog::info("Launch configuration: Block dimensions:   {:>9} x {:>5} x {:>5} threads", bd[0],bd[1], bd[2]);
-    spdlog::info("Launch configuration: Grid dimensions:    {:>9} x {:>5} x {:>5} blocks ", gd[0], gd[1], gd[2]);
+    spdlog::info("Launch configuration: Grid dimensions:    {:>9} x {:>5} x {:>5} blocks {}", gd[0], gd[1], gd[2],
+        context.options.persistent_grid ? "(persistent: filling the device)" : "");
     spdlog::info("                                          -----------------------------------");
     spdlog::info("Launch configuration: Overall dimensions: {:>9} x {:>5} x {:>5} threads", ogd[0], ogd[1], ogd[2]);
     if (context.ecosystem == execution_ecosystem_t::cuda) {
         spdlog::info("Launch configuration: Dynamic shared memory:  {} bytes", lc_components.dynamic_shared_memory_size.value_or(0));
+        if (lc_components.cooperative.value_or(false)) {
+            spdlog::info("Launch configuration: Cooperative launch");
+        }
     }
     spdlog::debug("Overall dimensions cover full blocks? {}", lc_components.full_blocks());
+    prepare_launch_attributes(context, context.kernel_launch_config_components);
+}
+
+// A rebuilt kernel may use more registers or shared memory, so fewer of its blocks may be
+// co-resident; and its function attributes are lost. The rest of the launch configuration
+// is kept as it was.
+void reconfigure_launch_for_rebuilt_kernel(execution_context_t& context)
+{
+    if (not context.launch_steps.empty()) {
+        for(auto& step : context.launch_steps) {
+            validate_cooperative_launch(context, step.launch_config_components, step.kernel_function);
+            prepare_launch_attributes(context, step.launch_config_components, step.kernel_function);
+        }
+        return;
+    }
+    auto& lc_components = context.kernel_launch_config_components;
+    if (context.options.persistent_grid) {
+        set_persistent_grid(lc_components, context);
+        lc_components.deduce_missing();
+        context.kernel_launch_configuration = realize_launch_config(lc_components, context.ecosystem);
+        const auto& gd = lc_components.grid_dimensions.value();
+        spdlog::info("Launch configuration: Grid dimensions:    {:>9} x {:>5} x {:>5} blocks (persistent: filling the device)",
+            gd[0], gd[1], gd[2]);
+    }
+    validate_cooperative_launch(context, lc_components);
+    prepare_launch_attributes(context, lc_components);
 }
 
 void maybe_print_and_write_log(bool compilation_succeeded, execution_context_t& context)
@@ -1274,44 +2023,1300 @@ void maybe_write_intermediate_representation(execution_context_t& context)
         spdlog::level::info);
 }
 
-int main(int argc, char** argv)
+execution_context_t parse_command_line(
+    int                        argc,
+    char**                     argv,
+    const execution_context_t* device_context_donor = nullptr)
 {
-    spdlog::set_level(spdlog::level::info);
-    spdlog::cfg::load_env_levels(); // support setting the logging verbosity with an environment variable
-
     auto kernel_inspecific_cmdline_options = parse_command_line_initially(argc, argv);
 
-    execution_context_t context = initialize_execution_context(kernel_inspecific_cmdline_options);
+    execution_context_t context = initialize_execution_context(kernel_inspecific_cmdline_options, device_context_donor);
     parse_command_line_for_kernel(argc, argv, context);
+    finalize_kernel_function_name(context);
+    return context;
+}
 
-    auto build_succeeded = build_kernel(context);
-    auto log = context.compilation_log.value();
+void build_kernel_and_report(execution_context_t& context, const std::vector<string>& functions_for_other_kernels = {})
+{
+    auto build_succeeded = build_kernel(context, functions_for_other_kernels);
     maybe_print_and_write_log(build_succeeded, context);
     build_succeeded or die();
 
     maybe_write_intermediate_representation(context);
+}
 
-    if (context.options.compile_only) { return EXIT_SUCCESS; }
+// Whether a single build of the kernel source can serve both contexts
+bool builds_are_interchangeable(const execution_context_t& lhs, const execution_context_t& rhs)
+{
+    return
+        lhs.ecosystem == rhs.ecosystem and
+        lhs.options.kernel.source_file == rhs.options.kernel.source_file and
+        lhs.finalized_preprocessor_definitions.valueless == rhs.finalized_preprocessor_definitions.valueless and
+        lhs.finalized_preprocessor_definitions.valued == rhs.finalized_preprocessor_definitions.valued and
+        lhs.finalized_include_dir_paths == rhs.finalized_include_dir_paths and
+        lhs.options.preinclude_files == rhs.options.preinclude_files and
+        lhs.options.language_standard == rhs.options.language_standard and
+        lhs.options.compile_in_debug_mode == rhs.options.compile_in_debug_mode and
+        lhs.options.generate_line_info == rhs.options.generate_line_info and
+        lhs.options.write_ptx_to_file == rhs.options.write_ptx_to_file;
+}
 
-    read_buffers_from_files(context);
-    // TODO: Consider verifying before reading the buffers, but obtaining the sizes
-    // for the verification
-    verify_input_arguments(context);
-    create_host_side_output_buffers(context);
-    create_device_side_buffers(context);
-    generate_additional_scalar_arguments(context);
-    copy_input_buffers_to_device(context);
+// Takes the built program of another context, which must have included all of the kernel
+// functions this context uses
+void use_build_of(execution_context_t& context, const execution_context_t& builder)
+{
+    context.compilation_log = builder.compilation_log;
+    context.compiled_ptx = builder.compiled_ptx;
+    const auto& function_name = context.options.kernel.function_name;
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        context.cuda.module.emplace(builder.cuda.module.value()); // does not own the module
+        context.cuda.mangled_kernel_signatures = builder.cuda.mangled_kernel_signatures;
+        context.cuda.mangled_kernel_signature = context.cuda.mangled_kernel_signatures.at(function_name);
+    }
+    else {
+        // Kernel objects hold their arguments, so they are not shared; but creating them is cheap
+        context.opencl.program = builder.opencl.program;
+        context.opencl.built_kernel = cl::Kernel(context.opencl.program, function_name.c_str());
+        context.opencl.built_kernels.emplace(function_name, context.opencl.built_kernel);
+        for(const auto& name : context.kernel_adapter_->additional_kernel_functions(context)) {
+            context.opencl.built_kernels.emplace(name, cl::Kernel(context.opencl.program, name.c_str()));
+        }
+    }
+    maybe_write_intermediate_representation(context);
+}
+
+// Kernels in a pipeline which can share a build are all built together, by the first of them
+void build_pipeline_kernels(std::vector<execution_context_t>& stages)
+{
+    auto num_stages = stages.size();
+    std::vector<std::size_t> builder_indices(num_stages);
+    for(std::size_t i = 0; i < num_stages; i++) {
+        builder_indices[i] = i;
+        for(std::size_t j = 0; j < i; j++) {
+            if (builder_indices[j] == j and builds_are_interchangeable(stages[j], stages[i])) {
+                builder_indices[i] = j;
+                break;
+            }
+        }
+    }
+    for(std::size_t i = 0; i < num_stages; i++) {
+        if (builder_indices[i] != i) {
+            spdlog::info("Pipeline stage {} uses the kernel build of stage {}.", i+1, builder_indices[i]+1);
+            use_build_of(stages[i], stages[builder_indices[i]]);
+            continue;
+        }
+        std::vector<string> functions_for_other_kernels;
+        for(std::size_t k = i + 1; k < num_stages; k++) {
+            if (builder_indices[k] != i) { continue; }
+            functions_for_other_kernels.push_back(stages[k].options.kernel.function_name);
+            auto additional = stages[k].kernel_adapter_->additional_kernel_functions(stages[k]);
+            functions_for_other_kernels.insert(functions_for_other_kernels.end(), additional.cbegin(), additional.cend());
+        }
+        build_kernel_and_report(stages[i], functions_for_other_kernels);
+    }
+}
+
+// Outputs which are copied into mappings of their destinations don't need host-side buffers -
+// which may be large - once these have served to size the device-side buffers
+void release_host_side_buffers_of_mapped_outputs(execution_context_t& context)
+{
+    auto layouts = context.kernel_adapter_->interleaved_buffer_layouts(context);
+    for(auto& p : context.buffers.host_side.outputs) {
+        // ... except for those which are transposed on their way into the mapping
+        if (output_is_mapped(context, p.first) and not util::contains(layouts, p.first)) {
+            host_buffer_type{}.swap(p.second);
+        }
+    }
+}
+
+// Expects the host-side input buffers to have already been obtained
+void prepare_for_runs(execution_context_t& context)
+{
+    // TODO: Consider verifying before reading the buffers, but obtaining the sizes
+    // for the verification
+    verify_input_arguments(context);
+    create_host_side_output_buffers(context);
+    create_device_side_buffers(context);
+    release_host_side_buffers_of_mapped_outputs(context);
+    generate_additional_scalar_arguments(context);
+    create_scratch_buffers(context);
+    copy_input_buffers_to_device(context);
 
     finalize_kernel_arguments(context);
     configure_launch(context);
+}
+
+// For options which replace the usual single-kernel flow altogether
+optional<filesystem::path> get_path_option(int argc, char** argv, const char* option_name)
+{
+    cxxopts::Options options = basic_cmdline_options(argv[0]);
+    options.allow_unrecognised_options();
+    auto parse_result = non_consumptive_parse(options, argc, argv);
+    if (not contains(parse_result, option_name)) { return nullopt; }
+    return filesystem::path{ parse_result[option_name].as<string>() };
+}
+
+// Splits a line of a pipeline file into command-line arguments, at whitespace
+// which isn't quoted (with either single or double quotes)
+std::vector<string> split_into_arguments(const string& line)
+{
+    std::vector<string> arguments;
+    string current;
+    bool in_argument { false };
+    char quote { '\0' };
+    for(char c : line) {
+        if (quote != '\0') {
+            if (c == quote) { quote = '\0'; } else { current += c; }
+            continue;
+        }
+        if (c == '"' or c == '\'') {
+            quote = c;
+            in_argument = true;
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (in_argument) {
+                arguments.push_back(std::move(current));
+                current.clear();
+                in_argument = false;
+            }
+            continue;
+        }
+        current += c;
+        in_argument = true;
+    }
+    if (quote != '\0') {
+        throw std::invalid_argument("Unterminated quoted argument in pipeline line: " + line);
+    }
+    if (in_argument) { arguments.push_back(std::move(current)); }
+    return arguments;
+}
+
+// Each non-empty line which is not a comment (beginning with '#') holds the arguments of one
+// pipeline stage
+std::vector<std::vector<string>> read_pipeline_stage_arguments(const filesystem::path& pipeline_spec_file)
+{
+    verify_input_path(pipeline_spec_file);
+    std::ifstream file { pipeline_spec_file.native() };
+    std::vector<std::vector<string>> stage_arguments;
+    string line;
+    while (std::getline(file, line)) {
+        auto arguments = split_into_arguments(line);
+        if (arguments.empty() or arguments.front().front() == '#') { continue; }
+        stage_arguments.emplace_back(std::move(arguments));
+    }
+    return stage_arguments;
+}
+
+void bind_inputs_to_earlier_outputs(
+    execution_context_t&                    stage,
+    std::size_t                             stage_index,
+    const std::vector<execution_context_t>& earlier_stages)
+{
+    auto input_buffer_names = buffer_names(*stage.kernel_adapter_, parameter_direction_t::input, parameter_direction_t::inout);
+    for(const auto& p : stage.options.input_buffer_bindings) {
+        const auto& input_buffer_name = p.first;
+        const auto& binding = p.second;
+        util::contains(input_buffer_names, input_buffer_name)
+            or die("Pipeline stage {} has no input buffer named {}", stage_index+1, input_buffer_name);
+        (binding.stage_index < stage_index)
+            or die("Pipeline stage {} can only bind input buffers to outputs of earlier stages, not of stage {}",
+                stage_index+1, binding.stage_index+1);
+        const auto& producer_outputs = earlier_stages[binding.stage_index].buffers.device_side.outputs;
+        auto find_result = producer_outputs.find(binding.output_buffer_name);
+        (find_result != producer_outputs.cend())
+            or die("Pipeline stage {} has no output buffer named {}", binding.stage_index+1, binding.output_buffer_name);
+        spdlog::debug("Binding input buffer {} of pipeline stage {} to output buffer {} of stage {}",
+            input_buffer_name, stage_index+1, binding.output_buffer_name, binding.stage_index+1);
+        stage.buffers.device_side.bound_inputs.emplace(input_buffer_name, find_result->second);
+    }
+}
+
+void ensure_distinct_output_destinations(const std::vector<execution_context_t>& stages)
+{
+    std::unordered_set<string> destinations;
+    for(const auto& stage : stages) {
+        if (not stage.options.write_output_buffers_to_files) { continue; }
+        for(const auto& p : stage.buffers.filenames.outputs) {
+            auto destination = maybe_prepend_base_dir(stage.options.buffer_base_paths.output, p.second).native();
+            destinations.insert(destination).second
+                or die("More than one kernel in the pipeline would write an output buffer to {}", destination);
+        }
+    }
+}
+
+// Large enough for the per-chunk overhead to be negligible; small enough for writing to
+// start soon after copying does
+constexpr const std::size_t output_write_chunk_size { 16 * 1024 * 1024 };
+
+/**
+ * Copies the output buffers from the device and writes them to the files specified at the
+ * command-line - one file per buffer. Buffers are copied in chunks, each handed to a writer
+ * thread as soon as it has arrived, so that the files are written while later chunks and
+ * buffers are still being copied, rather than only after all copying is done. Outputs mapped
+ * to their destinations are copied directly into the mappings, and need no writing.
+ *
+ * @note must take the context as non-const, since the host-side output buffers, which are
+ * copied into, are held by value
+ */
+void write_outputs(execution_context_t& context)
+{
+    if (not context.options.write_output_buffers_to_files) { return; }
+    spdlog::info("Copying output buffers from the device and writing them to files.");
+    std::deque<host_buffer_type> transformed_outputs; // Transposed, converted or compressed; must outlive the writer's use of them
+    asynchronous_file_writer writer;
+    auto layouts = context.kernel_adapter_->interleaved_buffer_layouts(context);
+    // Unfortunately, decent ranged-for iteration on maps is only possible with C++17
+    for(auto& output_pair : context.buffers.host_side.outputs) {
+        const auto& name = output_pair.first;
+        const auto& device_side_buffer = context.buffers.device_side.outputs.at(name);
+        auto host_side_buffer = as_span(output_pair.second);
+        auto layout_find_result = layouts.find(name);
+        const record_layout_t* layout = (layout_find_result == layouts.cend()) ? nullptr : &layout_find_result->second;
+        if (output_is_mapped(context, name)) {
+            auto& mapping = context.buffers.shared.outputs[name];
+            if (not mapping) {
+                mapping = map_output_destination(context, name, device_side_buffer_size(context.ecosystem, device_side_buffer));
+            }
+            if (layout != nullptr) {
+                spdlog::trace("Transposing device output buffer '{}' into the mapping of {}", name, mapping->spec());
+                copy_buffer_to_host(context.ecosystem, &context.opencl.queue, device_side_buffer, host_side_buffer);
+                planar_to_interleaved(*layout, host_side_buffer, mapping->span(), util::default_num_threads());
+                continue;
+            }
+            spdlog::trace("Copying device output buffer directly into the mapping of {}", mapping->spec());
+            copy_buffer_to_host(context.ecosystem, &context.opencl.queue, device_side_buffer, mapping->span());
+            continue;
+        }
+        auto destination = maybe_prepend_base_dir(
+               context.options.buffer_base_paths.output,
+               context.buffers.filenames.outputs[name]);
+        auto conversion_find_result = context.options.element_conversions.find(name);
+        optional<element_conversion_t> conversion;
+        if (conversion_find_result != context.options.element_conversions.cend()) {
+            // An in-out buffer is written back in the type it was read in
+            conversion = util::contains(context.kernel_adapter_->buffer_names(parameter_direction_t::inout), name) ?
+                conversion_find_result->second.inverse() : conversion_find_result->second;
+        }
+        bool compress = output_is_compressed(context, name);
+        if (compress or layout != nullptr) {
+            // Transposition and compression need the whole buffer; but they still overlap
+            // the writing of earlier buffers
+            copy_buffer_to_host(context.ecosystem, &context.opencl.queue, device_side_buffer, host_side_buffer);
+            auto data = host_side_buffer;
+            if (layout != nullptr) {
+                transformed_outputs.emplace_back(data.size());
+                planar_to_interleaved(*layout, data, as_span(transformed_outputs.back()), util::default_num_threads());
+                data = as_span(transformed_outputs.back());
+            }
+            if (conversion) {
+                transformed_outputs.push_back(convert_elements(conversion.value(), data, util::default_num_threads()));
+                data = as_span(transformed_outputs.back());
+            }
+            if (compress) {
+                if (not is_compressed_buffer_file(destination)) { destination = destination.native() + ".lz4"; }
+                transformed_outputs.push_back(lz4_frame::compress(data, util::default_num_threads()));
+                spdlog::debug("Compressed output buffer '{}': {} bytes into {} bytes", name,
+                    data.size(), transformed_outputs.back().size());
+                data = as_span(transformed_outputs.back());
+            }
+            writer.open(name, destination, context.options.overwrite_allowed);
+            writer.append(data);
+            writer.close();
+            continue;
+        }
+        poor_mans_span converted { nullptr, 0 };
+        if (conversion) {
+            transformed_outputs.emplace_back(conversion->converted_size(host_side_buffer.size()));
+            converted = as_span(transformed_outputs.back());
+        }
+        writer.open(name, destination, context.options.overwrite_allowed);
+        for(std::size_t offset = 0; offset < host_side_buffer.size(); offset += output_write_chunk_size) {
+            poor_mans_span chunk { host_side_buffer.data() + offset,
+                std::min(output_write_chunk_size, host_side_buffer.size() - offset) };
+            spdlog::trace("Copying bytes {}..{} of device output buffer '{}' to the host", offset, offset + chunk.size(), name);
+            copy_buffer_to_host(context.ecosystem, &context.opencl.queue, device_side_buffer, chunk, offset);
+            if (conversion) {
+                // The chunk size is a multiple of any element size, so chunks convert independently
+                poor_mans_span converted_chunk { converted.data() + conversion->converted_size(offset),
+                    conversion->converted_size(chunk.size()) };
+                convert_elements(conversion.value(), chunk, converted_chunk, util::default_num_threads());
+                chunk = converted_chunk;
+            }
+            writer.append(chunk);
+        }
+        writer.close();
+    }
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        context.cuda.context->synchronize();
+    }
+    else {
+        context.opencl.queue.finish();
+    }
+    if (context.options.output_file_sync != output_file_sync_t::none) {
+        for(const auto& p : context.buffers.shared.outputs) {
+            p.second->sync(context.options.output_file_sync == output_file_sync_t::fsync);
+        }
+    }
+    writer.finish();
+}
+
+// Positions to verify within an output buffer of the given number of elements: its first and
+// last few elements, which kernels are most likely to get wrong, and a random sample of the rest
+std::vector<std::size_t> verification_positions(std::size_t num_elements, std::size_t num_samples)
+{
+    constexpr const std::size_t num_boundary_elements { 2 };
+    std::set<std::size_t> positions;
+    if (num_elements == 0) { return {}; }
+    for(std::size_t i = 0; i < std::min(num_boundary_elements, num_elements); i++) {
+        positions.insert(i);
+        positions.insert(num_elements - 1 - i);
+    }
+    auto num_positions = std::min(num_elements, positions.size() + num_samples);
+    std::mt19937_64 generator { std::random_device{}() };
+    std::uniform_int_distribution<std::size_t> distribution { 0, num_elements - 1 };
+    while (positions.size() < num_positions) {
+        positions.insert(distribution(generator));
+    }
+    return { positions.cbegin(), positions.cend() };
+}
+
+// Copies the elements at the given positions of a device-side buffer into consecutive
+// host-side elements. The copies are all enqueued before waiting once for them to complete,
+// rather than each of them blocking in turn.
+void gather_elements_to_host(
+    execution_context_t&            context,
+    const device_buffer_type&       device_side_buffer,
+    const std::vector<std::size_t>& positions,
+    std::size_t                     elem_size,
+    byte_type*                      gathered)
+{
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        auto& stream = context.cuda.stream.value();
+        for(std::size_t i = 0; i < positions.size(); i++) {
+            stream.enqueue.copy(gathered + i * elem_size,
+                device_side_buffer.cuda.data() + positions[i] * elem_size, elem_size);
+        }
+        stream.synchronize();
+    } else {
+        const constexpr auto blocking { CL_FALSE };
+        for(std::size_t i = 0; i < positions.size(); i++) {
+            context.opencl.queue.enqueueReadBuffer(device_side_buffer.opencl, blocking,
+                positions[i] * elem_size, elem_size, gathered + i * elem_size);
+        }
+        context.opencl.queue.finish();
+    }
+}
+
+double element_value(element_type_t type, const byte_type* element)
+{
+    double value;
+    convert_elements(element_conversion_t{ type, element_type_t::float64 },
+        poor_mans_span{ const_cast<byte_type*>(element), element_size(type) },
+        poor_mans_span{ reinterpret_cast<byte_type*>(&value), sizeof(value) }, 1);
+    return value;
+}
+
+bool values_match(double actual, double expected, double tolerance)
+{
+    if (std::isnan(expected) or std::isnan(actual)) {
+        return std::isnan(expected) and std::isnan(actual);
+    }
+    return (actual == expected) or std::abs(actual - expected) <= tolerance * std::max(1.0, std::abs(expected));
+}
+
+bool elements_match(element_type_t type, const byte_type* actual, const byte_type* expected, double tolerance)
+{
+    if (not is_floating_point(type)) {
+        return std::memcmp(actual, expected, element_size(type)) == 0;
+    }
+    return values_match(element_value(type, actual), element_value(type, expected), tolerance);
+}
+
+/**
+ * Verifies a sample of the elements of each output buffer which the kernel adapter has a
+ * host-side reference for. Only the sampled elements are copied from the device, and their
+ * reference values are computed in parallel - so this takes milliseconds even for huge
+ * outputs.
+ *
+ * @return true if all sampled elements matched their reference values
+ */
+bool verify_output_samples(execution_context_t& context)
+{
+    if (context.options.num_verification_samples == 0) { return true; }
+    if (not context.buffers.device_side.bound_inputs.empty()) {
+        spdlog::warn("Not verifying the outputs of kernel {}, as some of its inputs only exist on the device",
+            context.options.kernel.key);
+        return true;
+    }
+    auto references = context.kernel_adapter_->output_element_references(context);
+    if (references.empty()) {
+        spdlog::warn("Kernel {} has no host-side reference for verifying its outputs", context.options.kernel.key);
+        return true;
+    }
+    constexpr const std::size_t max_mismatches_to_report { 10 };
+    bool all_matched { true };
+    for(const auto& output_pair : context.buffers.device_side.outputs) {
+        const auto& name = output_pair.first;
+        auto reference_find_result = references.find(name);
+        if (reference_find_result == references.cend()) {
+            spdlog::debug("No host-side reference for output buffer '{}'; not verifying it", name);
+            continue;
+        }
+        const auto& reference = reference_find_result->second;
+        auto elem_size = element_size(reference.element_type);
+        auto num_elements = device_side_buffer_size(context.ecosystem, output_pair.second) / elem_size;
+        auto positions = verification_positions(num_elements, context.options.num_verification_samples);
+        auto tolerance = std::max(context.options.verification_tolerance, reference.min_tolerance);
+        host_buffer_type actual(positions.size() * elem_size);
+        host_buffer_type expected(positions.size() * elem_size);
+        gather_elements_to_host(context, output_pair.second, positions, elem_size, actual.data());
+        util::parallel_for(positions.size(), util::default_num_threads(), [&](std::size_t i) {
+            reference.compute(positions[i], expected.data() + i * elem_size);
+        });
+        std::size_t num_mismatches { 0 };
+        for(std::size_t i = 0; i < positions.size(); i++) {
+            const auto* actual_element = actual.data() + i * elem_size;
+            const auto* expected_element = expected.data() + i * elem_size;
+            if (elements_match(reference.element_type, actual_element, expected_element, tolerance)) {
+                continue;
+            }
+            if (num_mismatches++ < max_mismatches_to_report) {
+                spdlog::error("Element {} of output buffer '{}' is {}, rather than {}", positions[i], name,
+                    element_value(reference.element_type, actual_element),
+                    element_value(reference.element_type, expected_element));
+            }
+        }
+        if (num_mismatches > 0) {
+            spdlog::error("{} of {} verified elements of output buffer '{}' do not match the reference",
+                num_mismatches, positions.size(), name);
+            all_matched = false;
+        }
+        else {
+            spdlog::info("All {} verified elements of output buffer '{}' match the reference", positions.size(), name);
+        }
+    }
+    return all_matched;
+}
+
+execution_duration_type mean_run_duration(const execution_context_t& context)
+{
+    execution_duration_type total { 0 };
+    for(const auto& duration : context.run_durations) { total += duration; }
+    return context.run_durations.empty() ? total : total / (double) context.run_durations.size();
+}
+
+// Compares an output buffer on the device against its host-side reference values, in chunks
+// @return the number of mismatching elements
+std::size_t compare_with_reference(
+    execution_context_t&      context,
+    const string&             buffer_name,
+    const device_buffer_type& device_side_buffer,
+    element_type_t            element_type,
+    const host_buffer_type&   expected)
+{
+    auto elem_size = element_size(element_type);
+    auto chunk_size = output_write_chunk_size / elem_size * elem_size;
+    auto num_threads = util::default_num_threads();
+    const element_conversion_t to_double { element_type, element_type_t::float64 };
+    host_buffer_type actual(std::min(chunk_size, expected.size()));
+    std::size_t num_mismatches { 0 };
+    for(std::size_t offset = 0; offset < expected.size(); offset += chunk_size) {
+        poor_mans_span actual_chunk { actual.data(), std::min(chunk_size, expected.size() - offset) };
+        poor_mans_span expected_chunk { const_cast<byte_type*>(expected.data()) + offset, actual_chunk.size() };
+        copy_buffer_to_host(context.ecosystem, &context.opencl.queue, device_side_buffer, actual_chunk, offset);
+        if (std::memcmp(actual_chunk.data(), expected_chunk.data(), actual_chunk.size()) == 0) { continue; }
+        auto num_elements = actual_chunk.size() / elem_size;
+        auto report = [&](std::size_t i, double actual_value, double expected_value) {
+            if (num_mismatches++ == 0) {
+                spdlog::error("Element {} of output buffer '{}' is {}, rather than {} (per the host reference)",
+                    offset / elem_size + i, buffer_name, actual_value, expected_value);
+            }
+        };
+        if (is_floating_point(element_type)) {
+            auto actual_values = convert_elements(to_double, actual_chunk, num_threads);
+            auto expected_values = convert_elements(to_double, expected_chunk, num_threads);
+            const auto* actual_doubles = reinterpret_cast<const double*>(actual_values.data());
+            const auto* expected_doubles = reinterpret_cast<const double*>(expected_values.data());
+            for(std::size_t i = 0; i < num_elements; i++) {
+                if (not values_match(actual_doubles[i], expected_doubles[i], context.options.verification_tolerance)) {
+                    report(i, actual_doubles[i], expected_doubles[i]);
+                }
+            }
+            continue;
+        }
+        for(std::size_t i = 0; i < num_elements; i++) {
+            const auto* actual_element = actual_chunk.data() + i * elem_size;
+            const auto* expected_element = expected_chunk.data() + i * elem_size;
+            if (std::memcmp(actual_element, expected_element, elem_size) != 0) {
+                report(i, element_value(element_type, actual_element), element_value(element_type, expected_element));
+            }
+        }
+    }
+    return num_mismatches;
+}
+
+/**
+ * Runs the kernel adapter's full host-side reference implementation as many times as the
+ * kernel was run, reports the kernel's speedup over it, and checks the outputs against
+ * its results.
+ *
+ * @return true if all outputs the reference computes matched it
+ */
+bool run_host_reference(execution_context_t& context)
+{
+    if (not context.options.run_host_reference) { return true; }
+    if (not context.buffers.device_side.bound_inputs.empty()) {
+        spdlog::warn("Not running a host reference for kernel {}, as some of its inputs only exist on the device",
+            context.options.kernel.key);
+        return true;
+    }
+    auto reference = context.kernel_adapter_->host_reference(context);
+    if (not reference) {
+        spdlog::warn("Kernel {} has no host-side reference implementation", context.options.kernel.key);
+        return true;
+    }
+    host_buffers_map expected;
+    for(const auto& p : reference->output_element_types) {
+        const auto& name = p.first;
+        util::contains(context.buffers.device_side.outputs, name)
+            or die("The host reference of kernel {} computes '{}', which is not an output buffer", context.options.kernel.key, name);
+        auto size = device_side_buffer_size(context.ecosystem, context.buffers.device_side.outputs.at(name));
+        expected.emplace(name, host_buffer_type(size)); // Zeroing it also faults its pages in, outside the timed runs
+    }
+    auto num_threads = util::default_num_threads();
+    auto num_runs = std::max<std::size_t>(context.options.num_runs, 1);
+    execution_duration_type total_duration { 0 };
+    for(std::size_t ri = 0; ri < num_runs; ri++) {
+        auto start = std::chrono::steady_clock::now();
+        reference->compute(expected, num_threads);
+        total_duration += std::chrono::steady_clock::now() - start;
+    }
+    auto mean_host_duration = total_duration / (double) num_runs;
+    spdlog::info("Mean run time of the host reference implementation, on {} threads: {:.0f} nsec",
+        num_threads, mean_host_duration.count());
+    if (context.run_durations.empty()) {
+        spdlog::info("Time the kernel's execution (--time-execution) to compare it with the host reference");
+    }
+    else {
+        auto mean_device_duration = mean_run_duration(context);
+        spdlog::info("Speedup of the kernel over the host reference: {:.2f}x",
+            mean_host_duration.count() / mean_device_duration.count());
+    }
+
+    bool all_matched { true };
+    for(const auto& p : reference->output_element_types) {
+        const auto& name = p.first;
+        auto num_mismatches = compare_with_reference(
+            context, name, context.buffers.device_side.outputs.at(name), p.second, expected.at(name));
+        if (num_mismatches > 0) {
+            spdlog::error("{} of {} elements of output buffer '{}' do not match the host reference",
+                num_mismatches, expected.at(name).size() / element_size(p.second), name);
+            all_matched = false;
+        }
+        else {
+            spdlog::info("Output buffer '{}' matches the host reference", name);
+        }
+    }
+    return all_matched;
+}
+
+// A pipeline is a sequence of kernels, each with its own arguments (in addition to those
+// common to all kernels), run one after the other in every run. Output buffers of a kernel
+// may be bound to input buffers of later kernels, in which case they are passed on device-side.
+// @return true if all outputs verified against a reference matched it
+bool run_pipeline(int argc, char** argv, const filesystem::path& pipeline_spec_file)
+{
+    auto stage_arguments = read_pipeline_stage_arguments(pipeline_spec_file);
+    if (stage_arguments.empty()) {
+        die("No kernels specified in pipeline file {}", pipeline_spec_file.native());
+    }
+    std::vector<string> common_arguments;
+    for(int i = 1; i < argc; i++) {
+        string argument { argv[i] };
+        if (argument == "--pipeline") { i++; continue; }
+        if (argument.compare(0, std::strlen("--pipeline="), "--pipeline=") == 0) { continue; }
+        common_arguments.push_back(std::move(argument));
+    }
+
+    auto num_stages = stage_arguments.size();
+    std::vector<execution_context_t> stages;
+    stages.reserve(num_stages);
+        // Contexts are not moved once they're set up, as their marshalled arguments point into them
+    for(std::size_t stage_index = 0; stage_index < num_stages; stage_index++) {
+        spdlog::info("Parsing the options of pipeline stage {} of {}.", stage_index+1, num_stages);
+        std::vector<string> arguments { argv[0] };
+        arguments.insert(arguments.end(), common_arguments.cbegin(), common_arguments.cend());
+        arguments.insert(arguments.end(), stage_arguments[stage_index].cbegin(), stage_arguments[stage_index].cend());
+        std::vector<char*> stage_argv;
+        for(auto& argument : arguments) { stage_argv.push_back(&argument[0]); }
+        stages.emplace_back(parse_command_line(
+            (int) stage_argv.size(), stage_argv.data(), stages.empty() ? nullptr : &stages.front()));
+        stages.back().options.record_directory.empty()
+            or die("Recording runs is not supported for pipelines");
+        not stages.back().options.watch_sources
+            or die("Watching kernel sources is not supported for pipelines");
+        not stages.back().options.frame_stream.enabled
+            or die("Streaming frames is not supported for pipelines");
+    }
+    build_pipeline_kernels(stages);
+    for(std::size_t stage_index = 0; stage_index < num_stages; stage_index++) {
+        auto& stage = stages[stage_index];
+        if (stage.options.compile_only) { continue; }
+        bind_inputs_to_earlier_outputs(stage, stage_index, stages);
+        read_buffers_from_files(stage);
+        prepare_for_runs(stage);
+    }
+    bool all_verified { true };
+    if (not std::any_of(stages.cbegin(), stages.cend(), [](const auto& stage) { return stage.options.compile_only; })) {
+        ensure_distinct_output_destinations(stages);
+
+        auto num_runs = stages.front().options.num_runs;
+        bool all_stages_timed = std::all_of(stages.cbegin(), stages.cend(),
+            [](const auto& stage) { return stage.options.time_with_events; });
+        for(run_index_t ri = 0; ri < num_runs; ri++) {
+            execution_duration_type pipeline_duration { 0 };
+            for(auto& stage : stages) {
+                perform_single_run(stage, ri);
+                if (all_stages_timed) { pipeline_duration += stage.run_durations.back(); }
+            }
+            if (all_stages_timed) {
+                spdlog::info("Event-measured time of run {} of the {}-kernel pipeline: {:.0f} nsec",
+                    ri+1, num_stages, pipeline_duration.count());
+            }
+        }
+        for(auto& stage : stages) {
+            all_verified = verify_output_samples(stage) and all_verified;
+            all_verified = run_host_reference(stage) and all_verified;
+            write_outputs(stage);
+        }
+    }
+    // The later stages only hold non-owning references to the device context of the first one
+    while (not stages.empty()) { stages.pop_back(); }
+    return all_verified;
+}
+
+// Rebuilds and reruns the kernel whenever its sources change, until interrupted. Everything
+// other than the build - the device-side buffers, the arguments and the launch configuration -
+// is kept, so a change to the definitions' effect on buffer sizes or the launch is not picked up.
+void watch_sources_and_rerun(execution_context_t& context)
+{
+    constexpr const std::chrono::milliseconds settling_period { 200 };
+    file_watcher watcher;
+    auto previous_mean_duration = mean_run_duration(context);
+    unsigned version { 1 };
+    while (true) {
+        auto watched_files = find_included_files(context.options.kernel.source_file,
+            context.finalized_include_dir_paths, context.options.preinclude_files);
+        watched_files.push_back(context.options.kernel.source_file);
+        watcher.watch(watched_files);
+            // Re-watched every time, since the changes may have altered the set of included files
+        spdlog::info("Watching {} source files for changes (interrupt to stop).", watched_files.size());
+
+        auto changed_files = watcher.wait_for_changes(settling_period);
+        for(const auto& file : changed_files) {
+            spdlog::info("Kernel source file changed: {}", file.native());
+        }
+        auto build_succeeded = build_kernel(context);
+        maybe_print_and_write_log(build_succeeded, context);
+        if (not build_succeeded) {
+            spdlog::error("Keeping the previous build of kernel {}", context.options.kernel.key);
+            continue;
+        }
+        version++;
+        reconfigure_launch_for_rebuilt_kernel(context);
+        if (context.options.overwrite_allowed) {
+            maybe_write_intermediate_representation(context);
+        }
+
+        context.run_durations.clear();
+        for(run_index_t ri = 0; ri < context.options.num_runs; ri++) {
+            perform_single_run(context, ri);
+        }
+        auto mean_duration = mean_run_duration(context);
+        spdlog::info("Mean run time of version {} of the kernel: {:.0f} nsec (previous version: {:.0f} nsec; change: {:+.2f}%)",
+            version, mean_duration.count(), previous_mean_duration.count(),
+            100.0 * (mean_duration.count() - previous_mean_duration.count()) / previous_mean_duration.count());
+        previous_mean_duration = mean_duration;
+
+        verify_output_samples(context);
+        if (context.options.overwrite_allowed) {
+            write_outputs(context);
+        }
+        else if (context.options.write_output_buffers_to_files) {
+            spdlog::warn("Not writing the outputs of the rebuilt kernel, since overwriting output files is not allowed");
+        }
+    }
+}
+
+// A buffer's part of each frame in a stream
+struct frame_part_t {
+    string buffer_name;
+    std::size_t offset, size;
+};
+
+// One of the sets of buffers, on both sides, through which the frames of a stream cycle
+struct frame_slot_t {
+    device_buffers_map device_side_inputs, device_side_outputs;
+    poor_mans_span host_side_input, host_side_output; // pinned, so that copies can be asynchronous
+    cuda::event_t uploaded, processed, downloaded;
+};
+
+struct latency_percentiles_t {
+    double median, p90, p99, max;
+};
+
+latency_percentiles_t percentiles_of(std::vector<double> values)
+{
+    if (values.empty()) { return { 0, 0, 0, 0 }; }
+    std::sort(values.begin(), values.end());
+    auto at_percentile = [&](double percentile) {
+        return values[std::min(values.size() - 1, (std::size_t) (percentile / 100.0 * (double) values.size()))];
+    };
+    return { at_percentile(50), at_percentile(90), at_percentile(99), values.back() };
+}
+
+int open_frame_stream(const string& path, bool for_writing, bool overwrite_allowed)
+{
+    constexpr const char* standard_stream { "-" };
+    if (path == standard_stream) { return for_writing ? STDOUT_FILENO : STDIN_FILENO; }
+    if (for_writing and filesystem::is_regular_file(path) and not overwrite_allowed) {
+        die("Writing the output frames would overwrite an existing file: {}", path);
+    }
+    int fd = for_writing ? ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "opening frame stream " + path);
+    }
+    return fd;
+}
+
+// Reads frames of input one after the other, processing each and writing out the corresponding
+// output frame. Frames cycle through three sets of buffers, so that uploading a frame, processing
+// the previous one and downloading the one before that can all overlap; the output frames are
+// written by a separate thread, so that frames needn't wait for the input of later ones.
+void run_frame_stream(execution_context_t& context)
+{
+    constexpr const std::size_t num_slots { 3 };
+    using clock = std::chrono::steady_clock;
+    const auto& ka = *context.kernel_adapter_;
+    auto& cuda_context = *context.cuda.context;
+    cuda::context::current::scoped_override_t scoped_context_override{ cuda_context };
+
+    std::vector<frame_part_t> input_parts, output_parts;
+    std::size_t input_frame_size { 0 }, output_frame_size { 0 };
+    for(const auto& spd : ka.buffer_details()) {
+        if (is_input(spd.direction)) {
+            auto size = context.buffers.host_side.inputs.at(spd.name).size();
+            input_parts.push_back(frame_part_t{ spd.name, input_frame_size, size });
+            input_frame_size += size;
+        }
+        if (is_output(spd.direction)) {
+            auto size = device_side_buffer_size(context.ecosystem, context.buffers.device_side.outputs.at(spd.name));
+            output_parts.push_back(frame_part_t{ spd.name, output_frame_size, size });
+            output_frame_size += size;
+        }
+    }
+    (input_frame_size > 0) or die("Kernel {} has no input buffers to stream", context.options.kernel.key);
+    spdlog::info("Streaming frames of {} bytes of input and {} bytes of output.", input_frame_size, output_frame_size);
+
+    auto make_event = [&]() { return cuda_context.create_event(cuda::event::sync_by_blocking); };
+    std::vector<frame_slot_t> slots;
+    for(std::size_t i = 0; i < num_slots; i++) {
+        frame_slot_t slot { {}, {}, {}, {}, make_event(), make_event(), make_event() };
+        auto allocate_pinned = [](std::size_t size) {
+            auto region = cuda::memory::host::allocate(size);
+            return poor_mans_span{ static_cast<byte_type*>(region.data()), size };
+        };
+        slot.host_side_input = allocate_pinned(input_frame_size);
+        slot.host_side_output = allocate_pinned(output_frame_size);
+        // The first slot uses the buffers which were set up for the usual runs; for in-out buffers,
+        // the frame's input goes straight into the working copy, which the kernel uses
+        for(const auto& part : input_parts) {
+            if (util::contains(context.buffers.device_side.outputs, part.buffer_name)) { continue; }
+            if (i == 0) {
+                slot.device_side_inputs.emplace(part.buffer_name, context.buffers.device_side.inputs.at(part.buffer_name));
+                continue;
+            }
+            // Each frame only overwrites the unpadded part of an input, so the padding is filled once
+            auto padding = input_padding(context, part.buffer_name);
+            (not padding or padding->fill == kernel_adapter::input_padding_t::with_zeros)
+                or die("Padding input buffer '{}' with its last element is not supported when streaming frames", part.buffer_name);
+            auto buffer = create_device_side_buffer(part.buffer_name, padded_input_size(context, part.buffer_name, part.size),
+                context.ecosystem, context.cuda.context, nullopt, {});
+            if (padding) { cuda::memory::zero(buffer.cuda.data(), buffer.cuda.size()); }
+            slot.device_side_inputs.emplace(part.buffer_name, std::move(buffer));
+        }
+        for(const auto& part : output_parts) {
+            slot.device_side_outputs.emplace(part.buffer_name, (i == 0) ?
+                context.buffers.device_side.outputs.at(part.buffer_name) :
+                create_device_side_buffer(part.buffer_name, part.size, context.ecosystem, context.cuda.context, nullopt, {}));
+        }
+        slots.emplace_back(std::move(slot));
+    }
+    auto input_device_buffer = [&](frame_slot_t& slot, const string& name) -> device_buffer_type& {
+        auto find_result = slot.device_side_inputs.find(name);
+        return (find_result != slot.device_side_inputs.end()) ? find_result->second : slot.device_side_outputs.at(name);
+    };
+
+    auto upload_stream = cuda_context.create_stream(cuda::stream::async);
+    auto download_stream = cuda_context.create_stream(cuda::stream::async);
+    auto& processing_stream = context.cuda.stream.value();
+    auto kernels = get_cuda_run_kernels(context);
+    bool zero_outputs = context.options.zero_output_buffers or ka.requires_zeroed_outputs(context);
+    auto output_only_buffers = ka.buffer_names(parameter_direction_t::out);
+
+    int input_fd = open_frame_stream(context.options.frame_stream.input, false, false);
+    int output_fd = open_frame_stream(context.options.frame_stream.output, true, context.options.overwrite_allowed);
+
+    struct in_flight_frame_t {
+        std::size_t slot_index;
+        clock::time_point arrival;
+    };
+    std::mutex mutex;
+    std::condition_variable state_changed;
+    std::deque<in_flight_frame_t> in_flight;
+    std::size_t num_frames_written { 0 };
+    bool input_ended { false };
+    std::vector<double> latencies; // in microseconds
+    clock::time_point last_write_time;
+
+    std::thread writer([&]() {
+        cuda::context::current::scoped_override_t writer_context_override{ cuda_context };
+        while (true) {
+            in_flight_frame_t frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                state_changed.wait(lock, [&]() { return input_ended or not in_flight.empty(); });
+                if (in_flight.empty()) { return; }
+                frame = in_flight.front();
+            }
+            auto& slot = slots[frame.slot_index];
+            slot.downloaded.synchronize();
+            write_fully(output_fd, slot.host_side_output);
+            last_write_time = clock::now();
+            latencies.push_back(std::chrono::duration<double, std::micro>(last_write_time - frame.arrival).count());
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                in_flight.pop_front();
+                num_frames_written++;
+            }
+            state_changed.notify_all();
+        }
+    });
+
+    clock::time_point first_arrival;
+    std::size_t frame_index { 0 };
+    for(; ; frame_index++) {
+        auto slot_index = frame_index % num_slots;
+        auto& slot = slots[slot_index];
+        {
+            // The slot's output must have been written out before it is reused
+            std::unique_lock<std::mutex> lock(mutex);
+            state_changed.wait(lock, [&]() { return num_frames_written + num_slots > frame_index; });
+        }
+        slot.uploaded.synchronize();
+        auto num_read = read_fully(input_fd, slot.host_side_input);
+        if (num_read == 0) { break; }
+        if (num_read < input_frame_size) {
+            spdlog::warn("Ignoring the incomplete final frame of the stream ({} of {} bytes)", num_read, input_frame_size);
+            break;
+        }
+        auto arrival = clock::now();
+        if (frame_index == 0) { first_arrival = arrival; }
+        spdlog::debug("Read frame {} of the stream", frame_index+1);
+
+        // The device-side input buffers are free once the slot's previous frame has been processed
+        upload_stream.enqueue.wait(slot.processed);
+        for(const auto& part : input_parts) {
+            upload_stream.enqueue.copy(input_device_buffer(slot, part.buffer_name).cuda.data(),
+                slot.host_side_input.data() + part.offset, part.size);
+        }
+        upload_stream.enqueue.event(slot.uploaded);
+
+        // ... and the device-side output buffers, once its output has been downloaded
+        processing_stream.enqueue.wait(slot.uploaded);
+        processing_stream.enqueue.wait(slot.downloaded);
+        for(const auto& part : output_parts) {
+            auto& buffer = slot.device_side_outputs.at(part.buffer_name);
+            if (zero_outputs and util::contains(output_only_buffers, part.buffer_name)) {
+                processing_stream.enqueue.memzero(buffer.cuda.data(), buffer.cuda.size());
+            }
+            // The marshalled arguments point into the context's buffer maps, so this switches
+            // the kernel over to the slot's buffers
+            context.buffers.device_side.outputs.at(part.buffer_name).cuda = buffer.cuda;
+        }
+        for(const auto& p : slot.device_side_inputs) {
+            context.buffers.device_side.inputs.at(p.first).cuda = p.second.cuda;
+        }
+        enqueue_cuda_kernel_launches(context, kernels, processing_stream);
+        processing_stream.enqueue.event(slot.processed);
+
+        download_stream.enqueue.wait(slot.processed);
+        for(const auto& part : output_parts) {
+            download_stream.enqueue.copy(slot.host_side_output.data() + part.offset,
+                slot.device_side_outputs.at(part.buffer_name).cuda.data(), part.size);
+        }
+        download_stream.enqueue.event(slot.downloaded);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight.push_back(in_flight_frame_t{ slot_index, arrival });
+        }
+        state_changed.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        input_ended = true;
+    }
+    state_changed.notify_all();
+    writer.join();
+    cuda_context.synchronize();
+
+    // Leave the context as it was set up, with the first slot's buffers
+    for(const auto& p : slots.front().device_side_inputs) {
+        context.buffers.device_side.inputs.at(p.first).cuda = p.second.cuda;
+    }
+    for(const auto& p : slots.front().device_side_outputs) {
+        context.buffers.device_side.outputs.at(p.first).cuda = p.second.cuda;
+    }
+    for(std::size_t i = 0; i < num_slots; i++) {
+        cuda::memory::host::free(slots[i].host_side_input.data());
+        cuda::memory::host::free(slots[i].host_side_output.data());
+        if (i == 0) { continue; }
+        for(const auto& p : slots[i].device_side_inputs) { cuda::memory::device::free(p.second.cuda.data()); }
+        for(const auto& p : slots[i].device_side_outputs) { cuda::memory::device::free(p.second.cuda.data()); }
+    }
+    if (input_fd != STDIN_FILENO) { ::close(input_fd); }
+    if (output_fd != STDOUT_FILENO) { ::close(output_fd); }
+
+    if (frame_index == 0) {
+        spdlog::warn("No frames were streamed");
+        return;
+    }
+    auto elapsed = std::chrono::duration<double>(last_write_time - first_arrival).count();
+    auto latency = percentiles_of(latencies);
+    spdlog::info("Streamed {} frames in {:.3f} sec: {:.1f} frames/sec", frame_index, elapsed,
+        (elapsed > 0) ? frame_index / elapsed : 0.0);
+    spdlog::info("Frame latency (usec): median {:.1f}, 90th percentile {:.1f}, 99th percentile {:.1f}, maximum {:.1f}",
+        latency.median, latency.p90, latency.p99, latency.max);
+}
+
+constexpr const char* recording_bundle_filename { "recording.bundle" };
+
+string as_string(const host_buffer_type& buffer)
+{
+    return string(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+}
+
+void record_launch_config_components(bundle::writer& recording, const optional_launch_config_components_t& components)
+{
+    auto add_dimensions = [&](const char* name, const optional<std::array<std::size_t, 3>>& dims) {
+        if (not dims) { return; }
+        recording.add(string("launch/") + name,
+            string(reinterpret_cast<const char*>(dims.value().data()), sizeof(dims.value())));
+    };
+    add_dimensions("block_dimensions", components.block_dimensions);
+    add_dimensions("grid_dimensions", components.grid_dimensions);
+    add_dimensions("overall_grid_dimensions", components.overall_grid_dimensions);
+    if (components.dynamic_shared_memory_size) {
+        uint64_t size = components.dynamic_shared_memory_size.value();
+        recording.add("launch/dynamic_shared_memory_size", string(reinterpret_cast<const char*>(&size), sizeof(size)));
+    }
+    add_dimensions("cluster_dimensions", components.cluster_dimensions);
+    if (components.cooperative.value_or(false)) {
+        recording.add("launch/cooperative", string("1"));
+    }
+    if (components.preferred_shared_memory_carveout) {
+        int32_t carveout = components.preferred_shared_memory_carveout.value();
+        recording.add("launch/preferred_shared_memory_carveout", string(reinterpret_cast<const char*>(&carveout), sizeof(carveout)));
+    }
+    if (components.l2_access_policy_window) {
+        const auto& window = components.l2_access_policy_window.value();
+        recording.add("launch/l2_access_policy_window/buffer_name", window.buffer_name);
+        recording.add("launch/l2_access_policy_window/hit_ratio",
+            string(reinterpret_cast<const char*>(&window.hit_ratio), sizeof(window.hit_ratio)));
+        if (window.persisting_l2_size) {
+            uint64_t size = window.persisting_l2_size.value();
+            recording.add("launch/l2_access_policy_window/persisting_l2_size", string(reinterpret_cast<const char*>(&size), sizeof(size)));
+        }
+    }
+}
+
+optional_launch_config_components_t recorded_launch_config_components(const bundle::reader& recording)
+{
+    optional_launch_config_components_t components;
+    auto get_dimensions = [&](const char* name, optional<std::array<std::size_t, 3>>& dims) {
+        auto entry_name = string("launch/") + name;
+        if (not recording.contains(entry_name)) { return; }
+        std::array<std::size_t, 3> recorded_dims;
+        std::memcpy(recorded_dims.data(), recording.at(entry_name).data(), sizeof(recorded_dims));
+        dims = recorded_dims;
+    };
+    get_dimensions("block_dimensions", components.block_dimensions);
+    get_dimensions("grid_dimensions", components.grid_dimensions);
+    get_dimensions("overall_grid_dimensions", components.overall_grid_dimensions);
+    if (recording.contains("launch/dynamic_shared_memory_size")) {
+        uint64_t size;
+        std::memcpy(&size, recording.at("launch/dynamic_shared_memory_size").data(), sizeof(size));
+        components.dynamic_shared_memory_size = (unsigned) size;
+    }
+    get_dimensions("cluster_dimensions", components.cluster_dimensions);
+    if (recording.contains("launch/cooperative")) {
+        components.cooperative = true;
+    }
+    if (recording.contains("launch/preferred_shared_memory_carveout")) {
+        int32_t carveout;
+        std::memcpy(&carveout, recording.at("launch/preferred_shared_memory_carveout").data(), sizeof(carveout));
+        components.preferred_shared_memory_carveout = carveout;
+    }
+    if (recording.contains("launch/l2_access_policy_window/buffer_name")) {
+        l2_access_policy_window_t window;
+        window.buffer_name = recording.string_at("launch/l2_access_policy_window/buffer_name");
+        std::memcpy(&window.hit_ratio, recording.at("launch/l2_access_policy_window/hit_ratio").data(), sizeof(window.hit_ratio));
+        if (recording.contains("launch/l2_access_policy_window/persisting_l2_size")) {
+            uint64_t size;
+            std::memcpy(&size, recording.at("launch/l2_access_policy_window/persisting_l2_size").data(), sizeof(size));
+            window.persisting_l2_size = size;
+        }
+        components.l2_access_policy_window = window;
+    }
+    return components;
+}
+
+// Writes everything a replay needs into a single bundle; the sources and headers are not
+// used by the replay itself, but are there for examining the recorded kernel
+void record_run(const execution_context_t& context)
+{
+    spdlog::info("Recording the run into {}", context.options.record_directory.native());
+    bundle::writer recording;
+    const auto& kernel = context.options.kernel;
+    recording.add("kernel/key", kernel.key);
+    recording.add("kernel/function", kernel.function_name);
+    recording.add("kernel/ecosystem", ecosystem_name(context.ecosystem));
+    recording.add("kernel/source_path", kernel.source_file.native());
+    recording.add("kernel/source", as_string(read_input_file(kernel.source_file)));
+    for(const auto& header : find_included_files(
+        kernel.source_file, context.finalized_include_dir_paths, context.options.preinclude_files))
+    {
+        recording.add("headers/" + header.native(), as_string(read_input_file(header)));
+    }
+
+    string valueless_definitions;
+    for(const auto& term : context.finalized_preprocessor_definitions.valueless) {
+        valueless_definitions += term + '\n';
+    }
+    recording.add("definitions/valueless", valueless_definitions);
+    for(const auto& def : context.finalized_preprocessor_definitions.valued) {
+        recording.add("definitions/valued/" + def.first, def.second);
+    }
+    for(const auto& scalar : context.scalar_input_arguments.raw) {
+        recording.add("scalars/" + scalar.first, scalar.second);
+    }
+    if (context.options.zero_output_buffers) {
+        recording.add("options/zero_output_buffers", string{});
+    }
+    // The inputs are recorded as the kernel sees them, i.e. already converted; but the outputs'
+    // conversions - and the inverse conversions of in-out buffers - are still to be applied
+    auto input_only_buffers = context.kernel_adapter_->buffer_names(parameter_direction_t::input);
+    for(const auto& p : context.options.element_conversions) {
+        if (util::contains(input_only_buffers, p.first)) { continue; }
+        recording.add("conversions/" + p.first, string(reinterpret_cast<const char*>(&p.second), sizeof(p.second)));
+    }
+    // Multi-launch adapters determine their launch configurations themselves,
+    // so only what was forced on them is recorded
+    record_launch_config_components(recording, context.launch_steps.empty() ?
+        context.kernel_launch_config_components : context.options.forced_launch_config_components);
+    for(const auto& input : context.buffers.host_side.inputs) {
+        recording.add("inputs/" + input.first, as_span(input.second));
+    }
+
+    recording.add("ir", context.compiled_ptx.value());
+    for(const auto& mangled : context.cuda.mangled_kernel_signatures) {
+        recording.add("ir/mangled/" + mangled.first, mangled.second);
+    }
+    recording.write(context.options.record_directory / recording_bundle_filename, context.options.overwrite_allowed);
+}
+
+// Only the options which don't affect what the kernel computes are taken from the
+// command-line; everything else is as recorded
+kernel_inspecific_cmdline_options_t parse_command_line_for_replay(
+    int                    argc,
+    char**                 argv,
+    const bundle::reader&  recording)
+{
+    cxxopts::Options options = basic_cmdline_options(argv[0]);
+    options.allow_unrecognised_options();
+    auto parse_result = non_consumptive_parse(options, argc, argv);
+    apply_logging_options(parse_result);
+
+    kernel_inspecific_cmdline_options_t parsed_options {};
+    parsed_options.kernel.key = recording.string_at("kernel/key");
+    parsed_options.kernel.function_name = recording.string_at("kernel/function");
+    parsed_options.kernel.source_file = recording.string_at("kernel/source_path");
+    auto ecosystem = recording.string_at("kernel/ecosystem");
+    if (ecosystem == ecosystem_name(execution_ecosystem_t::cuda)) {
+        parsed_options.gpu_ecosystem = execution_ecosystem_t::cuda;
+    }
+    else if (ecosystem == ecosystem_name(execution_ecosystem_t::opencl)) {
+        parsed_options.gpu_ecosystem = execution_ecosystem_t::opencl;
+        parsed_options.platform_id = contains(parse_result, "platform-id") ?
+            parse_result["platform-id"].as<unsigned>() : 0;
+    }
+    else die("Unsupported execution ecosystem in the recording: {}", ecosystem);
+    kernel_adapter::can_produce_subclass(parsed_options.kernel.key)
+        or die("No kernel adapter is registered for the recorded kernel key {}", parsed_options.kernel.key);
+
+    parsed_options.gpu_device_id = parse_result["device"].as<int>();
+    if (parsed_options.gpu_device_id < 0) die("Please specify a non-negative device index");
+    parsed_options.num_runs = parse_result["num-runs"].as<unsigned>();
+    parsed_options.time_with_events = parse_result["time-execution"].as<bool>();
+    parsed_options.num_verification_samples = parse_result["verify-samples"].as<unsigned>();
+    parsed_options.run_host_reference = parse_result["host-reference"].as<bool>();
+    parsed_options.verification_tolerance = parse_result["verify-tolerance"].as<double>();
+    if (parsed_options.verification_tolerance < 0) die("The verification tolerance must be non-negative");
+    parsed_options.write_output_buffers_to_files = parse_result["write-output"].as<bool>();
+    parsed_options.overwrite_allowed = parse_result["overwrite"].as<bool>();
+    parsed_options.buffer_base_paths.output = parse_result["output-buffer-dir"].as<string>();
+    filesystem::is_directory(parsed_options.buffer_base_paths.output)
+        or die("{} is not a directory.", parsed_options.buffer_base_paths.output.native());
+
+    parsed_options.zero_output_buffers = recording.contains("options/zero_output_buffers");
+    for(const auto& buffer_name : recording.names_with_prefix("conversions/")) {
+        element_conversion_t conversion;
+        std::memcpy(&conversion, recording.at("conversions/" + buffer_name).data(), sizeof(conversion));
+        parsed_options.element_conversions.emplace(buffer_name, conversion);
+    }
+    parsed_options.forced_launch_config_components = recorded_launch_config_components(recording);
+    return parsed_options;
+}
+
+// Loads the recorded compiled kernel, rather than building it from source
+void load_recorded_kernel(execution_context_t& context, const bundle::reader& recording)
+{
+    const auto& function_name = context.options.kernel.function_name;
+    context.compiled_ptx = recording.string_at("ir");
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        context.cuda.module = cuda::module::create(*context.cuda.context, context.compiled_ptx.value());
+        for(const auto& name : recording.names_with_prefix("ir/mangled/")) {
+            context.cuda.mangled_kernel_signatures.emplace(name, recording.string_at("ir/mangled/" + name));
+        }
+        context.cuda.mangled_kernel_signature = context.cuda.mangled_kernel_signatures.at(function_name);
+    }
+    else {
+        auto binary = recording.at("ir");
+        std::vector<cl::Device> devices { context.opencl.device };
+        cl::Program::Binaries binaries { { binary.data(), binary.size() } };
+        context.opencl.program = cl::Program(context.opencl.context, devices, binaries);
+        context.opencl.program.build(devices);
+        context.opencl.built_kernel = cl::Kernel(context.opencl.program, function_name.c_str());
+        context.opencl.built_kernels.emplace(function_name, context.opencl.built_kernel);
+        for(const auto& name : context.kernel_adapter_->additional_kernel_functions(context)) {
+            context.opencl.built_kernels.emplace(name, cl::Kernel(context.opencl.program, name.c_str()));
+        }
+    }
+    spdlog::info("Loaded the recorded kernel {}.", context.options.kernel.key);
+}
+
+void load_recorded_arguments(execution_context_t& context, const bundle::reader& recording)
+{
+    std::istringstream valueless_definitions { recording.string_at("definitions/valueless") };
+    string term;
+    while (std::getline(valueless_definitions, term)) {
+        context.finalized_preprocessor_definitions.valueless.insert(term);
+    }
+    for(const auto& term : recording.names_with_prefix("definitions/valued/")) {
+        context.finalized_preprocessor_definitions.valued.emplace(term, recording.string_at("definitions/valued/" + term));
+    }
+
+    const auto& ka = *context.kernel_adapter_;
+    for(const auto& spd : ka.scalar_parameter_details()) {
+        auto entry_name = string("scalars/") + spd.name;
+        if (recording.contains(entry_name)) {
+            set_scalar_argument(context, ka, spd, recording.string_at(entry_name));
+        }
+    }
+    for(const auto& name : recording.names_with_prefix("inputs/")) {
+        auto data = recording.at("inputs/" + name);
+        context.buffers.host_side.inputs.emplace(name, host_buffer_type(data.data(), data.data() + data.size()));
+    }
+    if (context.options.write_output_buffers_to_files) {
+        for(const auto& buffer_name : buffer_names(ka, parameter_direction_t::output, parameter_direction_t::inout)) {
+            auto output_filename = buffer_name + ".out";
+            auto destination = maybe_prepend_base_dir(context.options.buffer_base_paths.output, output_filename);
+            (context.options.overwrite_allowed or not filesystem::exists(destination))
+                or die("Writing the contents of output buffer {} would overwrite an existing file: {}",
+                    buffer_name, destination.native());
+            context.buffers.filenames.outputs[buffer_name] = output_filename;
+        }
+    }
+}
+
+// @return true if all outputs verified against a reference matched it
+bool replay_recorded_run(int argc, char** argv, const filesystem::path& record_directory)
+{
+    bundle::reader recording { record_directory / recording_bundle_filename };
+    auto options = parse_command_line_for_replay(argc, argv, recording);
+    execution_context_t context = initialize_execution_context(options);
+    load_recorded_arguments(context, recording);
+    load_recorded_kernel(context, recording);
+    prepare_for_runs(context);
 
     for(run_index_t ri = 0; ri < context.options.num_runs; ri++) {
         perform_single_run(context, ri);
     }
-    if (context.options.write_output_buffers_to_files) {
-        copy_outputs_from_device(context);
-        write_buffers_to_files(context);
+    auto outputs_verified = verify_output_samples(context);
+    outputs_verified = run_host_reference(context) and outputs_verified;
+    write_outputs(context);
+    return outputs_verified;
+}
+
+int main(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::info);
+    spdlog::cfg::load_env_levels(); // support setting the logging verbosity with an environment variable
+
+    auto record_directory = get_path_option(argc, argv, "replay");
+    if (record_directory) {
+        auto outputs_verified = replay_recorded_run(argc, argv, record_directory.value());
+        spdlog::info("All done.");
+        return outputs_verified ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    auto pipeline_spec_file = get_path_option(argc, argv, "pipeline");
+    if (pipeline_spec_file) {
+        auto outputs_verified = run_pipeline(argc, argv, pipeline_spec_file.value());
+        spdlog::info("All done.");
+        return outputs_verified ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    execution_context_t context = parse_command_line(argc, argv);
+    build_kernel_and_report(context);
+    context.options.input_buffer_bindings.empty()
+        or die("Input buffers can only be bound to the outputs of other kernels in a pipeline");
+
+    if (context.options.compile_only) { return EXIT_SUCCESS; }
+
+    read_buffers_from_files(context);
+    prepare_for_runs(context);
+    if (not context.options.record_directory.empty()) {
+        record_run(context);
+    }
+    if (context.options.frame_stream.enabled) {
+        // The buffers which were read or generated only serve to determine the frame layout
+        run_frame_stream(context);
+        spdlog::info("All done.");
+        return EXIT_SUCCESS;
+    }
+
+    for(run_index_t ri = 0; ri < context.options.num_runs; ri++) {
+        perform_single_run(context, ri);
+    }
+    auto outputs_verified = verify_output_samples(context);
+    outputs_verified = run_host_reference(context) and outputs_verified;
+    write_outputs(context);
+    if (context.options.watch_sources) {
+        watch_sources_and_rerun(context);
     }
 
     spdlog::info("All done.");
+    return outputs_verified ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -3,6 +3,8 @@
 
 #include "execution_context.hpp"
 #include "parsers.hpp"
+#include "record_layout.hpp"
+#include "element_types.hpp"
 
 #include <util/miscellany.hpp>
 #include <util/functional.hpp>
@@ -16,6 +18,8 @@
 
 #include <common_types.hpp>
 
+#include <functional>
+
 // A convenience overload for specific kernel adapters to be able
 // to complain about dimensions_t's they get.
 inline std::ostream& operator<<(std::ostream& os, cuda::grid::dimensions_t dims)
@@ -185,6 +189,120 @@ public:
     virtual bool extra_validity_checks(const execution_context_t&) const { return true; }
     virtual bool input_sizes_are_valid(const execution_context_t&) const { return true; }
 
+    // An amount of work performed by a single run of the kernel, e.g. 2.5 GFLOP or 0.4 GB;
+    // when runs are timed, the runner reports the corresponding rates (e.g. GFLOP/s).
+    struct work_quantity {
+        const char* unit;
+        double amount;
+    };
+
+    virtual std::vector<work_quantity> work_per_run(const execution_context_t&) const { return {}; }
+
+    /**
+     * Produces the contents of an input buffer without reading it from a file - when
+     * the user asks for this (--generate-inputs). Called after the scalar arguments
+     * have been parsed and the preprocessor definitions finalized.
+     *
+     * @return the buffer contents, or nullopt if this adapter can't generate this buffer
+     */
+    virtual optional<host_buffer_type> generate_input_buffer(const execution_context_t&, const std::string& /* buffer_name */) const
+    {
+        return nullopt;
+    }
+
+    /**
+     * Buffers whose files hold arrays of records, while the kernel uses a structure of arrays
+     * (see @ref record_layout_t); the runner transposes inputs after reading them, and outputs
+     * before writing them. Field sizes are those of the kernel's elements, i.e. after any
+     * element conversion of an input, and before that of an output. Called once the scalar
+     * arguments specified on the command-line have been parsed.
+     */
+    virtual record_layouts_t interleaved_buffer_layouts(const execution_context_t&) const { return {}; }
+
+    struct input_padding_t {
+        enum fill_t { with_zeros, with_last_element };
+        std::size_t multiple;          // in bytes, e.g. the size of the kernel's vector loads
+        fill_t fill { with_zeros };
+        std::size_t element_size { 1 }; // replicated when filling with the last element
+    };
+
+    /**
+     * Input buffers whose device-side copies the kernel needs padded - to a multiple of its
+     * vector width, say, so that it can skip handling a partial last vector. The host-side
+     * buffers, and hence the sizes the adapter's other methods see, are not padded. Only
+     * applies to input (not in-out) buffers which the runner copies to the device itself.
+     */
+    virtual std::unordered_map<std::string, input_padding_t> input_buffer_padding(const execution_context_t&) const
+    {
+        return {};
+    }
+
+    // Computes a single element of an output buffer - as the kernel leaves it on the device,
+    // i.e. before any transposition or element conversion - from the host-side inputs
+    struct output_element_reference_t {
+        element_type_t element_type;
+        std::function<void(std::size_t element_index, byte_type* element)> compute;
+        double min_tolerance { 0 };
+            // Overrides a lower --verify-tolerance, where the kernel and the reference legitimately
+            // differ by more than that - e.g. by rounding intermediate results differently
+    };
+
+    /**
+     * Host-side references for output buffers, against which the runner verifies a sample of
+     * their elements (--verify-samples), rather than having to compute all of them on the host.
+     * The references are called concurrently, after the runs; they must only read the context.
+     */
+    virtual std::unordered_map<std::string, output_element_reference_t> output_element_references(const execution_context_t&) const
+    {
+        return {};
+    }
+
+    // A complete implementation of the kernel on the host, filling (some of) the output buffers
+    // - pre-allocated with their device-side sizes - from the host-side inputs
+    struct host_reference_t {
+        std::unordered_map<std::string, element_type_t> output_element_types; // of the outputs it computes
+        std::function<void(host_buffers_map& outputs, unsigned num_threads)> compute;
+    };
+
+    /**
+     * A host-side reference implementation, against which the runner checks the outputs in
+     * full, and which it times, to report the kernel's speedup over the host (--host-reference).
+     * For that comparison to be meaningful, it should be as well-optimized as the kernel:
+     * vectorized, and using all of the threads it is given.
+     */
+    virtual optional<host_reference_t> host_reference(const execution_context_t&) const { return nullopt; }
+
+    // Kernels which accumulate into their outputs need them zeroed before every run
+    virtual bool requires_zeroed_outputs(const execution_context_t&) const { return false; }
+
+    /**
+     * Device-side buffers which the kernel(s) need, but which are neither read from nor
+     * written to the host - e.g. for intermediate results. Called after all scalar
+     * arguments (including the generated ones) are available.
+     */
+    virtual buffer_sizes scratch_buffer_sizes(const execution_context_t&) const { return {}; }
+
+    /**
+     * For kernels requiring multiple launches per run: The sequence of launches to make,
+     * each with its own launch configuration and arguments. An adapter returning
+     * a non-empty sequence does not have its arguments marshalled using
+     * @ref parameter_details, nor is @ref deduce_launch_config used; its parameter
+     * details only determine which buffers and scalars the runner prepares.
+     *
+     * @note Called once, after all buffers have been created, so the steps'
+     * arguments may point into the context.
+     */
+    virtual std::vector<kernel_launch_step> launch_steps(const execution_context_t&) const { return {}; }
+
+    /**
+     * Kernel functions in the same source, other than @ref kernel_function_name, which
+     * launch steps of this adapter use; they are all built together with the main kernel
+     * function. For CUDA, these may be name expressions of function template
+     * instantiations, e.g. "scatter<true>". Called once the preprocessor definitions
+     * have been finalized.
+     */
+    virtual std::vector<std::string> additional_kernel_functions(const execution_context_t&) const { return {}; }
+
 public:
 
     /**
@@ -269,6 +387,20 @@ static void register_in_factory()
 //    append the final nullptr?
 // 2. Consider placing the argument_ptrs_and_maybe_sizes vector in the test context; not sure why
 //    it should be outside of it.
+inline void push_back_buffer(
+    marshalled_arguments_type& argument_ptrs_and_maybe_sizes,
+    const execution_context_t& context,
+    const device_buffer_type& buffer)
+{
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        argument_ptrs_and_maybe_sizes.pointers.push_back(& buffer.cuda.data());
+    }
+    else {
+        argument_ptrs_and_maybe_sizes.pointers.push_back(& buffer.opencl);
+        argument_ptrs_and_maybe_sizes.sizes.push_back(sizeof(cl::Buffer));
+    }
+}
+
 inline void push_back_buffer(
     marshalled_arguments_type& argument_ptrs_and_maybe_sizes,
     const execution_context_t& context,
@@ -279,12 +411,32 @@ inline void push_back_buffer(
         context.buffers.device_side.inputs:
         context.buffers.device_side.outputs;
         // Note: We use outputs here for inout buffers as well.
-    if (context.ecosystem == execution_ecosystem_t::cuda) {
-        argument_ptrs_and_maybe_sizes.pointers.push_back(& buffer_map.at(buffer_parameter_name).cuda.data());
+    push_back_buffer(argument_ptrs_and_maybe_sizes, context, buffer_map.at(buffer_parameter_name));
+}
+
+// For arguments of a single launch step (e.g. a pass index), which are not held by the context
+template <typename Scalar>
+inline void push_back_owned_scalar(
+    kernel_launch_step& step,
+    const execution_context_t& context,
+    Scalar value)
+{
+    auto owned = std::make_shared<const Scalar>(value);
+    step.arguments.pointers.push_back(owned.get());
+    if (context.ecosystem == execution_ecosystem_t::opencl) {
+        step.arguments.sizes.push_back(sizeof(Scalar));
     }
-    else {
-        argument_ptrs_and_maybe_sizes.pointers.push_back(& buffer_map.at(buffer_parameter_name).opencl);
-        argument_ptrs_and_maybe_sizes.sizes.push_back(sizeof(cl::Buffer));
+    step.owned_argument_values.emplace_back(std::move(owned));
+}
+
+inline void terminate_arguments(
+    marshalled_arguments_type& argument_ptrs_and_maybe_sizes,
+    const execution_context_t& context)
+{
+    if (context.ecosystem == execution_ecosystem_t::cuda) {
+        argument_ptrs_and_maybe_sizes.pointers.push_back(nullptr);
+        // cuLaunchKernels uses a termination by NULL rather than a length parameter.
+        // Note: Remember that sizes is unused in this case
     }
 }
 
@@ -300,6 +452,23 @@ inline void push_back_scalar(
     }
 }
 
+// The value of a preprocessor definition for which the kernel source has a default - which the
+// adapter must repeat, for when the term isn't defined
+inline unsigned defined_or_default(
+    const preprocessor_value_definitions_t& valued_definitions,
+    const char*                             term,
+    unsigned                                default_value)
+{
+    auto find_result = valued_definitions.find(term);
+    return (find_result == valued_definitions.cend()) ?
+        default_value : util::from_string<unsigned>(find_result->second);
+}
+
+inline unsigned defined_or_default(const execution_context_t& context, const char* term, unsigned default_value)
+{
+    return defined_or_default(context.finalized_preprocessor_definitions.valued, term, default_value);
+}
+
 } // namespace kernel_adapters
 
 template <typename Scalar>
@@ -325,11 +494,7 @@ inline marshalled_arguments_type kernel_adapter::marshal_kernel_arguments(const
         }
     }
 
-    if (context.ecosystem == execution_ecosystem_t::cuda) {
-        argument_ptrs_and_maybe_sizes.pointers.push_back(nullptr);
-        // cuLaunchKernels uses a termination by NULL rather than a length parameter.
-        // Note: Remember that sizes is unused in this case
-    }
+    kernel_adapters::terminate_arguments(argument_ptrs_and_maybe_sizes, context);
     return argument_ptrs_and_maybe_sizes;
 }
 
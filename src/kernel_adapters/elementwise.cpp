@@ -0,0 +1,10 @@
+#include "elementwise.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<elementwise_unary>();
+    register_in_factory<elementwise_binary>();
+}
+
+} // namespace kernel_adapters
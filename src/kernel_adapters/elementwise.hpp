@@ -0,0 +1,185 @@
+#ifndef ELEMENTWISE_KERNEL_ADAPTERS_HPP_
+#define ELEMENTWISE_KERNEL_ADAPTERS_HPP_
+
+#include "kernel_adapter.hpp"
+#include "element_types.hpp"
+
+namespace kernel_adapters {
+
+/**
+ * Common functionality for the adapters of the generic element-wise map kernels,
+ * which are written using `kernels/include/elementwise.cuh`. Such kernels take
+ * their function body and buffer element types as preprocessor definitions,
+ * so that new element-wise kernels can be run without writing a new adapter.
+ */
+class elementwise_map : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using length_type = size_t;
+
+protected:
+    // Must match the default in the kernel sources
+    static constexpr const element_type_t default_element_type { element_type_t::float32 };
+    static constexpr const std::size_t default_block_size { 256 };
+    static constexpr const std::size_t max_vectorized_access_size { 16 }; // Must match elementwise.cuh
+
+    static element_type_t defined_element_type(
+        const preprocessor_value_definitions_t& valued_definitions,
+        const char* defined_term)
+    {
+        return ::defined_element_type(valued_definitions, defined_term, default_element_type);
+    }
+
+    static element_type_t defined_element_type(const execution_context_t& context, const char* defined_term)
+    {
+        return defined_element_type(context.finalized_preprocessor_definitions.valued, defined_term);
+    }
+
+    static std::size_t size_by_x_length(
+        const host_buffers_map& input_buffers,
+        const scalar_arguments_map&,
+        const preprocessor_definitions_t&,
+        const preprocessor_value_definitions_t& valued_definitions,
+        const optional_launch_config_components_t&)
+    {
+        auto num_elements = input_buffers.at("x").size() / element_size(defined_element_type(valued_definitions, "X_TYPE"));
+        return num_elements * element_size(defined_element_type(valued_definitions, "RESULT_TYPE"));
+    }
+
+    struct input_buffer_and_type_term {
+        const char* buffer_name;
+        const char* element_type_term;
+    };
+
+    virtual std::vector<input_buffer_and_type_term> inputs() const = 0;
+
+    length_type num_elements(const execution_context_t& context) const
+    {
+        return context.buffers.host_side.inputs.at("x").size() / element_size(defined_element_type(context, "X_TYPE"));
+    }
+
+    // Matches elementwise::vector_width() in the kernel-side framework
+    unsigned vector_width(const execution_context_t& context) const
+    {
+        auto max_element_size = element_size(defined_element_type(context, "RESULT_TYPE"));
+        for(const auto& input : inputs()) {
+            max_element_size = std::max(max_element_size, element_size(defined_element_type(context, input.element_type_term)));
+        }
+        unsigned width { 1 };
+        while (width * 2 * max_element_size <= max_vectorized_access_size) { width *= 2; }
+        return width;
+    }
+
+public:
+    scalar_arguments_map generate_additional_scalar_arguments(execution_context_t& context) const override
+    {
+        scalar_arguments_map generated;
+        generated["length"] = any(num_elements(context));
+        return generated;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        auto length = num_elements(context);
+        for(const auto& input : inputs()) {
+            const auto& buffer = context.buffers.host_side.inputs.at(input.buffer_name);
+            auto elem_size = element_size(defined_element_type(context, input.element_type_term));
+            if (buffer.size() % elem_size != 0) { return false; }
+            if (buffer.size() / elem_size != length) { return false; }
+        }
+        if (context.scalar_input_arguments.typed.find("length") !=
+            context.scalar_input_arguments.typed.cend())
+        {
+            if (get_scalar_argument<length_type>(context, "length") != length) { return false; }
+        }
+        return true;
+    }
+
+    // Since the kernels use grid-stride loops, we size the grid to fill the device -
+    // and not beyond the point where each thread has at least one vectorized access to make
+    optional_launch_config_components_t deduce_launch_config(const execution_context_t& context) const override
+    {
+        auto result = context.options.forced_launch_config_components;
+        if (not result.block_dimensions) {
+            result.set_block_dims(default_block_size, 1, 1);
+        }
+        if (not result.dynamic_shared_memory_size) {
+            result.dynamic_shared_memory_size = 0;
+        }
+        if (not result.grid_dimensions and not result.overall_grid_dimensions) {
+            auto block_size = result.block_dimensions.value()[0];
+            auto length = any_cast<length_type>(context.scalar_input_arguments.typed.at("length"));
+            auto num_vectorized_accesses = util::div_rounding_up(length, vector_width(context));
+            std::size_t blocks_covering_input = std::max<std::size_t>(1, util::div_rounding_up(num_vectorized_accesses, block_size));
+            result.set_grid_dims(std::min(blocks_covering_input, blocks_filling_device(context, block_size)), 1, 1);
+        }
+        return result;
+    }
+};
+
+class elementwise_unary final : public elementwise_map {
+public:
+    KA_KERNEL_FUNCTION_NAME("elementwiseUnary")
+    KA_KERNEL_KEY("bundled_with_runner/elementwise_unary")
+
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("result", output, "Results of applying the operation to each element of x", size_by_x_length),
+            buffer_details("x", input, "The operand sequence"),
+            scalar_details<length_type>("length", "Length of each of x and the result", isnt_required),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "ELEMENTWISE_OP", "An expression in terms of x, to compute each element of the result", is_required },
+            { "RESULT_TYPE", "The result element type (default: float)", isnt_required },
+            { "X_TYPE", "The operand element type (default: float)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+protected:
+    std::vector<input_buffer_and_type_term> inputs() const override { return { { "x", "X_TYPE" } }; }
+};
+
+class elementwise_binary final : public elementwise_map {
+public:
+    KA_KERNEL_FUNCTION_NAME("elementwiseBinary")
+    KA_KERNEL_KEY("bundled_with_runner/elementwise_binary")
+
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("result", output, "Results of applying the operation to each pair of elements of x and y", size_by_x_length),
+            buffer_details("x", input, "The first operand sequence"),
+            buffer_details("y", input, "The second operand sequence"),
+            scalar_details<length_type>("length", "Length of each of x, y and the result", isnt_required),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "ELEMENTWISE_OP", "An expression in terms of x and y, to compute each element of the result", is_required },
+            { "RESULT_TYPE", "The result element type (default: float)", isnt_required },
+            { "X_TYPE", "The first operand element type (default: float)", isnt_required },
+            { "Y_TYPE", "The second operand element type (default: float)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+protected:
+    std::vector<input_buffer_and_type_term> inputs() const override
+    {
+        return { { "x", "X_TYPE" }, { "y", "Y_TYPE" } };
+    }
+};
+
+} // namespace kernel_adapters
+
+#endif /* ELEMENTWISE_KERNEL_ADAPTERS_HPP_ */
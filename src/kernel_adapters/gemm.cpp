@@ -0,0 +1,9 @@
+#include "gemm.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<gemm>();
+}
+
+} // namespace kernel_adapters
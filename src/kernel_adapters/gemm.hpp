@@ -0,0 +1,192 @@
+#ifndef GEMM_KERNEL_ADAPTER_HPP_
+#define GEMM_KERNEL_ADAPTER_HPP_
+
+#include "kernel_adapter.hpp"
+#include "element_conversion.hpp"
+
+#include <cstring>
+
+namespace kernel_adapters {
+
+class gemm final : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using dimension_type = unsigned;
+
+    KA_KERNEL_FUNCTION_NAME("gemm")
+    KA_KERNEL_KEY("bundled_with_runner/gemm")
+
+protected:
+    struct tiling_t {
+        dimension_type m, n, k, thread_m, thread_n;
+    };
+
+    // These must match the defaults in the kernel sources
+    enum : dimension_type {
+        default_tile_m = 64,
+        default_tile_n = 64,
+        default_tile_k = 8,
+        default_thread_tile_m = 4,
+        default_thread_tile_n = 4,
+    };
+
+    static std::size_t element_size(const preprocessor_definitions_t& valueless_definitions)
+    {
+        constexpr const std::size_t half_size { 2 };
+        return util::contains(valueless_definitions, "HALF_PRECISION") ? half_size : sizeof(float);
+    }
+
+    static tiling_t tiling(const execution_context_t& context)
+    {
+        const auto& defs = context.finalized_preprocessor_definitions.valued;
+        return {
+            defined_or_default(defs, "TILE_M", default_tile_m),
+            defined_or_default(defs, "TILE_N", default_tile_n),
+            defined_or_default(defs, "TILE_K", default_tile_k),
+            defined_or_default(defs, "THREAD_TILE_M", default_thread_tile_m),
+            defined_or_default(defs, "THREAD_TILE_N", default_thread_tile_n),
+        };
+    }
+
+    static std::size_t c_size(
+        const host_buffers_map&,
+        const scalar_arguments_map& scalars,
+        const preprocessor_definitions_t& valueless_definitions,
+        const preprocessor_value_definitions_t&,
+        const optional_launch_config_components_t&)
+    {
+        return std::size_t{any_cast<dimension_type>(scalars.at("m"))} *
+            any_cast<dimension_type>(scalars.at("n")) * element_size(valueless_definitions);
+    }
+
+public:
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("C", output, "The m x n product matrix, in row-major layout", c_size),
+            buffer_details("A", input, "The m x k left-hand-side matrix, in row-major layout"),
+            buffer_details("B", input, "The k x n right-hand-side matrix, in row-major layout"),
+            scalar_details<dimension_type>("m", "Number of rows of A and of C"),
+            scalar_details<dimension_type>("n", "Number of columns of B and of C"),
+            scalar_details<dimension_type>("k", "Number of columns of A and rows of B"),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "HALF_PRECISION", "Use half-precision rather than single-precision matrix elements", isnt_required },
+            { "TILE_M", "Number of rows of C computed by each block (default: 64)", isnt_required },
+            { "TILE_N", "Number of columns of C computed by each block (default: 64)", isnt_required },
+            { "TILE_K", "Width of the A and B slabs staged in shared memory (default: 8)", isnt_required },
+            { "THREAD_TILE_M", "Number of rows of C computed by each thread (default: 4)", isnt_required },
+            { "THREAD_TILE_N", "Number of columns of C computed by each thread (default: 4)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        std::size_t m = get_scalar_argument<dimension_type>(context, "m");
+        std::size_t n = get_scalar_argument<dimension_type>(context, "n");
+        std::size_t k = get_scalar_argument<dimension_type>(context, "k");
+        auto elem_size = element_size(context.finalized_preprocessor_definitions.valueless);
+        return
+            context.buffers.host_side.inputs.at("A").size() == m * k * elem_size and
+            context.buffers.host_side.inputs.at("B").size() == k * n * elem_size;
+    }
+
+    // The kernel double-buffers its A and B slabs in shared memory, as single-precision
+    // elements regardless of HALF_PRECISION
+    static std::size_t shared_memory_size(const tiling_t& t)
+    {
+        constexpr const std::size_t num_slab_buffers { 2 };
+        return num_slab_buffers * t.k * (std::size_t{t.m} + t.n) * sizeof(float);
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        auto t = tiling(context);
+        bool tiling_is_valid =
+            t.thread_m > 0 and t.thread_n > 0 and t.k > 0 and
+            t.m % t.thread_m == 0 and t.n % t.thread_n == 0 and
+            (t.m / t.thread_m) * (t.n / t.thread_n) <= 1024;
+        if (not tiling_is_valid) { return false; }
+        auto max_shared_memory = max_shared_memory_per_block(context);
+        if (shared_memory_size(t) > max_shared_memory) {
+            throw std::invalid_argument("A " + std::to_string(t.m) + " x " + std::to_string(t.n) + " x "
+                + std::to_string(t.k) + " GEMM tiling needs " + std::to_string(shared_memory_size(t))
+                + " bytes of shared memory per block, but the device only allows "
+                + std::to_string(max_shared_memory));
+        }
+        return true;
+    }
+
+    // The launch configuration is entirely determined by the tiling; so, unlike for most kernels,
+    // forcing any part of it is more likely to break the kernel than to tune it.
+    optional_launch_config_components_t deduce_launch_config(const execution_context_t& context) const override
+    {
+        auto t = tiling(context);
+        auto m = get_scalar_argument<dimension_type>(context, "m");
+        auto n = get_scalar_argument<dimension_type>(context, "n");
+        optional_launch_config_components_t result;
+        result.set_block_dims(t.n / t.thread_n, t.m / t.thread_m, 1);
+        result.set_grid_dims(util::div_rounding_up(n, t.n), util::div_rounding_up(m, t.m), 1);
+        result.dynamic_shared_memory_size = 0;
+        return result;
+    }
+
+    // Each element of C is a dot product of a row of A and a column of B, accumulated in double precision.
+    // The kernel accumulates in single precision, so half-precision results may be an ulp apart.
+    std::unordered_map<std::string, output_element_reference_t> output_element_references(const execution_context_t& context) const override
+    {
+        std::size_t n = get_scalar_argument<dimension_type>(context, "n");
+        std::size_t k = get_scalar_argument<dimension_type>(context, "k");
+        bool half_precision = util::contains(context.finalized_preprocessor_definitions.valueless, "HALF_PRECISION");
+        const auto* a = context.buffers.host_side.inputs.at("A").data();
+        const auto* b = context.buffers.host_side.inputs.at("B").data();
+        auto element = [half_precision](const byte_type* matrix, std::size_t index) -> double {
+            if (half_precision) {
+                std::uint16_t half;
+                std::memcpy(&half, matrix + index * sizeof(half), sizeof(half));
+                return float16_to_float32(half);
+            }
+            float single;
+            std::memcpy(&single, matrix + index * sizeof(single), sizeof(single));
+            return single;
+        };
+        auto compute = [=](std::size_t index, byte_type* result) {
+            auto row = index / n;
+            auto column = index % n;
+            double sum { 0 };
+            for(std::size_t i = 0; i < k; i++) {
+                sum += element(a, row * k + i) * element(b, i * n + column);
+            }
+            if (half_precision) {
+                auto half = float32_to_float16(static_cast<float>(sum));
+                std::memcpy(result, &half, sizeof(half));
+            }
+            else {
+                auto single = static_cast<float>(sum);
+                std::memcpy(result, &single, sizeof(single));
+            }
+        };
+        constexpr const double half_precision_tolerance { 1e-3 }; // about one ulp, relative
+        return { { "C", { half_precision ? element_type_t::float16 : element_type_t::float32, compute,
+            half_precision ? half_precision_tolerance : 0 } } };
+    }
+
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        double m = get_scalar_argument<dimension_type>(context, "m");
+        double n = get_scalar_argument<dimension_type>(context, "n");
+        double k = get_scalar_argument<dimension_type>(context, "k");
+        constexpr const double flops_per_multiply_add { 2 };
+        return { { "GFLOP", flops_per_multiply_add * m * n * k / 1e9 } };
+    }
+};
+
+} // namespace kernel_adapters
+
+#endif /* GEMM_KERNEL_ADAPTER_HPP_ */
@@ -0,0 +1,9 @@
+#include "histogram.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<histogram>();
+}
+
+} // namespace kernel_adapters
@@ -0,0 +1,171 @@
+#ifndef HISTOGRAM_KERNEL_ADAPTER_HPP_
+#define HISTOGRAM_KERNEL_ADAPTER_HPP_
+
+#include "kernel_adapter.hpp"
+
+#include <random>
+#include <cstring>
+#include <climits>
+
+namespace kernel_adapters {
+
+class histogram final : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using length_type = size_t;
+    using counter_type = std::uint32_t;
+
+    KA_KERNEL_FUNCTION_NAME("histogram")
+    KA_KERNEL_KEY("bundled_with_runner/histogram")
+
+protected:
+    // These must match the defaults in the kernel sources
+    enum : unsigned {
+        default_key_bits = 8,
+        max_default_num_bins = 4096,
+        default_block_size = 256,
+    };
+
+    static unsigned key_bits(const preprocessor_value_definitions_t& valued_definitions)
+    {
+        return defined_or_default(valued_definitions, "KEY_BITS", default_key_bits);
+    }
+
+    static std::size_t num_bins(const preprocessor_value_definitions_t& valued_definitions)
+    {
+        auto find_result = valued_definitions.find("NUM_BINS");
+        if (find_result != valued_definitions.cend()) {
+            return util::from_string<std::size_t>(find_result->second);
+        }
+        return std::min<std::size_t>(std::size_t{1} << key_bits(valued_definitions), max_default_num_bins);
+    }
+
+    static std::size_t key_size(const preprocessor_value_definitions_t& valued_definitions)
+    {
+        return key_bits(valued_definitions) / CHAR_BIT;
+    }
+
+    static std::size_t bin_counts_size(
+        const host_buffers_map&,
+        const scalar_arguments_map&,
+        const preprocessor_definitions_t&,
+        const preprocessor_value_definitions_t& valued_definitions,
+        const optional_launch_config_components_t&)
+    {
+        return num_bins(valued_definitions) * sizeof(counter_type);
+    }
+
+    length_type num_keys(const execution_context_t& context) const
+    {
+        return context.buffers.host_side.inputs.at("keys").size() /
+            key_size(context.finalized_preprocessor_definitions.valued);
+    }
+
+public:
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("bin_counts", output, "The number of keys falling into each bin (32-bit unsigned counters)", bin_counts_size),
+            buffer_details("keys", input, "The keys to histogram (8 or 16 bits each)"),
+            scalar_details<length_type>("num_keys", "Number of keys; required when generating the keys", isnt_required),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "KEY_BITS", "Width of each key: 8 or 16 (default: 8)", isnt_required },
+            { "NUM_BINS", "Number of bins, a power of 2 no larger than 2^KEY_BITS (default: 2^KEY_BITS, but at most 4096)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    // Generated keys are uniformly distributed over the key range, with a fixed seed
+    // for repeatability; this is the least contended case.
+    optional<host_buffer_type> generate_input_buffer(const execution_context_t& context, const std::string& buffer_name) const override
+    {
+        if (buffer_name != "keys") { return nullopt; }
+        if (context.scalar_input_arguments.typed.find("num_keys") == context.scalar_input_arguments.typed.cend()) {
+            throw std::invalid_argument("The number of keys must be specified in order to generate them");
+        }
+        auto num_keys_ = get_scalar_argument<length_type>(context, "num_keys");
+        const auto& defs = context.finalized_preprocessor_definitions.valued;
+        auto key_size_ = key_size(defs);
+        host_buffer_type keys(num_keys_ * key_size_);
+        std::mt19937 generator;
+        std::uniform_int_distribution<std::uint32_t> distribution(0, (std::uint32_t{1} << key_bits(defs)) - 1);
+        for(length_type i = 0; i < num_keys_; i++) {
+            auto key = distribution(generator);
+            if (key_size_ == 1) {
+                keys[i] = static_cast<byte_type>(key);
+            }
+            else {
+                auto wide_key = static_cast<std::uint16_t>(key);
+                std::memcpy(keys.data() + i * key_size_, &wide_key, key_size_);
+            }
+        }
+        return keys;
+    }
+
+    bool requires_zeroed_outputs(const execution_context_t&) const override { return true; }
+
+    scalar_arguments_map generate_additional_scalar_arguments(execution_context_t& context) const override
+    {
+        scalar_arguments_map generated;
+        generated["num_keys"] = any(num_keys(context));
+        return generated;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        const auto& keys = context.buffers.host_side.inputs.at("keys");
+        if (keys.size() % key_size(context.finalized_preprocessor_definitions.valued) != 0) { return false; }
+        if (context.scalar_input_arguments.typed.find("num_keys") !=
+            context.scalar_input_arguments.typed.cend())
+        {
+            if (get_scalar_argument<length_type>(context, "num_keys") != num_keys(context)) { return false; }
+        }
+        return true;
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        const auto& defs = context.finalized_preprocessor_definitions.valued;
+        auto key_bits_ = key_bits(defs);
+        auto num_bins_ = num_bins(defs);
+        return
+            (key_bits_ == 8 or key_bits_ == 16) and
+            num_bins_ > 0 and (num_bins_ & (num_bins_ - 1)) == 0 and
+            num_bins_ <= (std::size_t{1} << key_bits_);
+    }
+
+    // The kernel uses a grid-stride loop; we fill the device, unless the keys are too few
+    optional_launch_config_components_t deduce_launch_config(const execution_context_t& context) const override
+    {
+        auto result = context.options.forced_launch_config_components;
+        if (not result.block_dimensions) {
+            result.set_block_dims(default_block_size, 1, 1);
+        }
+        if (not result.dynamic_shared_memory_size) {
+            result.dynamic_shared_memory_size = 0;
+        }
+        if (not result.grid_dimensions and not result.overall_grid_dimensions) {
+            auto block_size = result.block_dimensions.value()[0];
+            auto length = any_cast<length_type>(context.scalar_input_arguments.typed.at("num_keys"));
+            std::size_t blocks_covering_input = std::max<std::size_t>(1, util::div_rounding_up(length, block_size));
+            result.set_grid_dims(std::min(blocks_covering_input, blocks_filling_device(context, block_size)), 1, 1);
+        }
+        return result;
+    }
+
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        constexpr const double keys_per_gigakey { 1e9 };
+        return { { "Gkeys", num_keys(context) / keys_per_gigakey } };
+    }
+};
+
+} // namespace kernel_adapters
+
+#endif /* HISTOGRAM_KERNEL_ADAPTER_HPP_ */
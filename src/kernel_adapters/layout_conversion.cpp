@@ -0,0 +1,11 @@
+#include "layout_conversion.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<transpose>();
+    register_in_factory<aos_to_soa>();
+    register_in_factory<soa_to_aos>();
+}
+
+} // namespace kernel_adapters
@@ -0,0 +1,241 @@
+#ifndef LAYOUT_CONVERSION_KERNEL_ADAPTERS_HPP_
+#define LAYOUT_CONVERSION_KERNEL_ADAPTERS_HPP_
+
+#include "kernel_adapter.hpp"
+#include "element_types.hpp"
+
+namespace kernel_adapters {
+
+namespace detail {
+
+// Must match the defaults in the kernel sources
+constexpr const element_type_t default_layout_element_type { element_type_t::float32 };
+
+inline std::size_t layout_element_size(const preprocessor_value_definitions_t& valued_definitions)
+{
+    return element_size(defined_element_type(valued_definitions, "ELEMENT_TYPE", default_layout_element_type));
+}
+
+inline std::size_t same_size_as_single_input(
+    const host_buffers_map& input_buffers,
+    const scalar_arguments_map&,
+    const preprocessor_definitions_t&,
+    const preprocessor_value_definitions_t&,
+    const optional_launch_config_components_t&)
+{
+    return input_buffers.cbegin()->second.size();
+}
+
+// Layout conversions read and write every element exactly once
+inline std::vector<kernel_adapter::work_quantity> bytes_copied(const execution_context_t& context)
+{
+    const auto& input = context.buffers.host_side.inputs.cbegin()->second;
+    constexpr const double bytes_per_gigabyte { 1e9 };
+    return { { "GB", 2.0 * input.size() / bytes_per_gigabyte } };
+}
+
+} // namespace detail
+
+class transpose final : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using dimension_type = unsigned;
+
+    KA_KERNEL_FUNCTION_NAME("transpose")
+    KA_KERNEL_KEY("bundled_with_runner/transpose")
+
+protected:
+    // These must match the defaults in the kernel source
+    enum : unsigned {
+        default_tile_dim = 32,
+        default_block_rows = 8,
+    };
+
+    static unsigned tile_dim(const execution_context_t& context)
+    {
+        return defined_or_default(context, "TILE_DIM", default_tile_dim);
+    }
+
+    static unsigned block_rows(const execution_context_t& context)
+    {
+        return defined_or_default(context, "BLOCK_ROWS", default_block_rows);
+    }
+
+public:
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("transposed", output, "The cols x rows transposed matrix, in row-major layout", detail::same_size_as_single_input),
+            buffer_details("matrix", input, "The rows x cols matrix to transpose, in row-major layout"),
+            scalar_details<dimension_type>("rows", "Number of rows of the input matrix"),
+            scalar_details<dimension_type>("cols", "Number of columns of the input matrix"),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "ELEMENT_TYPE", "The matrix element type (default: float)", isnt_required },
+            { "TILE_DIM", "Side of the square tile transposed by each block (default: 32)", isnt_required },
+            { "BLOCK_ROWS", "Number of tile rows covered by a block at once; must divide TILE_DIM (default: 8)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        std::size_t rows = get_scalar_argument<dimension_type>(context, "rows");
+        std::size_t cols = get_scalar_argument<dimension_type>(context, "cols");
+        auto elem_size = detail::layout_element_size(context.finalized_preprocessor_definitions.valued);
+        return context.buffers.host_side.inputs.at("matrix").size() == rows * cols * elem_size;
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        return block_rows(context) > 0 and tile_dim(context) % block_rows(context) == 0;
+    }
+
+    // The launch configuration is determined by the tiling
+    optional_launch_config_components_t deduce_launch_config(const execution_context_t& context) const override
+    {
+        auto rows = get_scalar_argument<dimension_type>(context, "rows");
+        auto cols = get_scalar_argument<dimension_type>(context, "cols");
+        auto tile_dim_ = tile_dim(context);
+        optional_launch_config_components_t result;
+        result.set_block_dims(tile_dim_, block_rows(context), 1);
+        result.set_grid_dims(util::div_rounding_up(cols, tile_dim_), util::div_rounding_up(rows, tile_dim_), 1);
+        result.dynamic_shared_memory_size = 0;
+        return result;
+    }
+
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        return detail::bytes_copied(context);
+    }
+};
+
+/**
+ * Common functionality for the adapters of the kernels converting between
+ * an array of records and an array per record component
+ */
+class record_layout_conversion : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using length_type = size_t;
+
+protected:
+    // Must match the default in include/record_layout.cuh
+    enum : unsigned { default_block_size = 256 };
+
+    static unsigned num_components(const execution_context_t& context)
+    {
+        return util::from_string<unsigned>(context.finalized_preprocessor_definitions.valued.at("NUM_COMPONENTS"));
+    }
+
+    static unsigned block_size(const execution_context_t& context)
+    {
+        return defined_or_default(context, "BLOCK_SIZE", default_block_size);
+    }
+
+    length_type num_records(const execution_context_t& context) const
+    {
+        const auto& input = context.buffers.host_side.inputs.cbegin()->second;
+        auto record_size = num_components(context) * detail::layout_element_size(context.finalized_preprocessor_definitions.valued);
+        return input.size() / record_size;
+    }
+
+public:
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "NUM_COMPONENTS", "Number of components per record: 2, 3 or 4", is_required },
+            { "ELEMENT_TYPE", "The type of each record component (default: float)", isnt_required },
+            { "BLOCK_SIZE", "Number of threads per block, and of records staged in shared memory at once (default: 256)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    scalar_arguments_map generate_additional_scalar_arguments(execution_context_t& context) const override
+    {
+        scalar_arguments_map generated;
+        generated["num_records"] = any(num_records(context));
+        return generated;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        const auto& input = context.buffers.host_side.inputs.cbegin()->second;
+        auto record_size = num_components(context) * detail::layout_element_size(context.finalized_preprocessor_definitions.valued);
+        if (input.size() % record_size != 0) { return false; }
+        if (context.scalar_input_arguments.typed.find("num_records") !=
+            context.scalar_input_arguments.typed.cend())
+        {
+            if (get_scalar_argument<length_type>(context, "num_records") != num_records(context)) { return false; }
+        }
+        return true;
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        auto num_components_ = num_components(context);
+        return num_components_ >= 2 and num_components_ <= 4;
+    }
+
+    // The block size is fixed by the kernel's shared memory staging; the grid is sized
+    // to fill the device, or to cover the input if that takes fewer blocks.
+    optional_launch_config_components_t deduce_launch_config(const execution_context_t& context) const override
+    {
+        auto result = context.options.forced_launch_config_components;
+        auto block_size_ = block_size(context);
+        result.set_block_dims(block_size_, 1, 1);
+        result.dynamic_shared_memory_size = 0;
+        if (not result.grid_dimensions and not result.overall_grid_dimensions) {
+            auto length = any_cast<length_type>(context.scalar_input_arguments.typed.at("num_records"));
+            std::size_t blocks_covering_input = std::max<std::size_t>(1, util::div_rounding_up(length, block_size_));
+            result.set_grid_dims(std::min(blocks_covering_input, blocks_filling_device(context, block_size_)), 1, 1);
+        }
+        return result;
+    }
+
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        return detail::bytes_copied(context);
+    }
+};
+
+class aos_to_soa final : public record_layout_conversion {
+public:
+    KA_KERNEL_FUNCTION_NAME("aosToSoa")
+    KA_KERNEL_KEY("bundled_with_runner/aos_to_soa")
+
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("soa", output, "The record components, one array per component", detail::same_size_as_single_input),
+            buffer_details("aos", input, "The array of records"),
+            scalar_details<length_type>("num_records", "Number of records", isnt_required),
+        };
+        return pd;
+    }
+};
+
+class soa_to_aos final : public record_layout_conversion {
+public:
+    KA_KERNEL_FUNCTION_NAME("soaToAos")
+    KA_KERNEL_KEY("bundled_with_runner/soa_to_aos")
+
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("aos", output, "The array of records", detail::same_size_as_single_input),
+            buffer_details("soa", input, "The record components, one array per component"),
+            scalar_details<length_type>("num_records", "Number of records", isnt_required),
+        };
+        return pd;
+    }
+};
+
+} // namespace kernel_adapters
+
+#endif /* LAYOUT_CONVERSION_KERNEL_ADAPTERS_HPP_ */
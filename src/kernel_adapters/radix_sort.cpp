@@ -0,0 +1,10 @@
+#include "radix_sort.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<radix_sort>();
+    register_in_factory<radix_sort_pairs>();
+}
+
+} // namespace kernel_adapters
@@ -0,0 +1,283 @@
+#ifndef RADIX_SORT_KERNEL_ADAPTERS_HPP_
+#define RADIX_SORT_KERNEL_ADAPTERS_HPP_
+
+#include "kernel_adapter.hpp"
+
+#include <random>
+#include <cstring>
+#include <numeric>
+#include <limits>
+#include <climits>
+
+namespace kernel_adapters {
+
+/**
+ * Common functionality for the adapters of the LSD radix sort kernels, which
+ * need three launches (histogram, scan, scatter) per digit - see
+ * `kernels/radix_sort.cu`. The passes alternate between the output buffers
+ * and same-size scratch buffers; the number of passes is even, so the last
+ * one writes the output buffers, and the inputs are never altered.
+ */
+class lsd_radix_sort : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using length_type = size_t;
+    using value_type = std::uint32_t;
+    using count_type = std::uint32_t;
+
+protected:
+    // These must match the kernel source
+    enum : unsigned {
+        default_key_bits = 32,
+        default_block_size = 256,
+        default_keys_per_thread = 8,
+        digit_bits = 4,
+        radix = 1 << digit_bits,
+    };
+    virtual bool sorts_pairs() const = 0;
+
+    static constexpr const char* scan_kernel_function { "radixSortScan" };
+    const char* scatter_kernel_function() const
+    {
+        return sorts_pairs() ? "radixSortScatter<true>" : "radixSortScatter<false>";
+    }
+
+    static unsigned key_bits(const execution_context_t& context) { return defined_or_default(context, "KEY_BITS", default_key_bits); }
+    static unsigned block_size(const execution_context_t& context) { return defined_or_default(context, "BLOCK_SIZE", default_block_size); }
+    static std::size_t key_size(const execution_context_t& context) { return key_bits(context) / CHAR_BIT; }
+
+    static std::size_t tile_length(const execution_context_t& context)
+    {
+        return std::size_t{block_size(context)} * defined_or_default(context, "KEYS_PER_THREAD", default_keys_per_thread);
+    }
+
+    static length_type num_keys(const execution_context_t& context)
+    {
+        return context.buffers.host_side.inputs.at("keys").size() / key_size(context);
+    }
+
+    static std::size_t num_tiles(const execution_context_t& context)
+    {
+        return util::div_rounding_up(num_keys(context), tile_length(context));
+    }
+
+    static std::size_t same_size_as_keys(
+        const host_buffers_map& input_buffers,
+        const scalar_arguments_map&,
+        const preprocessor_definitions_t&,
+        const preprocessor_value_definitions_t&,
+        const optional_launch_config_components_t&)
+    {
+        return input_buffers.at("keys").size();
+    }
+
+    static std::size_t same_size_as_values(
+        const host_buffers_map& input_buffers,
+        const scalar_arguments_map&,
+        const preprocessor_definitions_t&,
+        const preprocessor_value_definitions_t&,
+        const optional_launch_config_components_t&)
+    {
+        return input_buffers.at("values").size();
+    }
+
+public:
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "KEY_BITS", "Width of each key: 32 or 64 (default: 32)", isnt_required },
+            { "BLOCK_SIZE", "Threads per block; a multiple of 32, at most 1024 (default: 256)", isnt_required },
+            { "KEYS_PER_THREAD", "Length of the tile of keys handled by each block, in multiples of the block size (default: 8)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    // Generated keys are uniformly distributed over the whole key range; generated
+    // values are the keys' original positions. A fixed seed is used, for repeatability.
+    optional<host_buffer_type> generate_input_buffer(const execution_context_t& context, const std::string& buffer_name) const override
+    {
+        if (context.scalar_input_arguments.typed.find("num_keys") == context.scalar_input_arguments.typed.cend()) {
+            throw std::invalid_argument("The number of keys must be specified in order to generate the inputs");
+        }
+        auto num_keys_ = get_scalar_argument<length_type>(context, "num_keys");
+        if (buffer_name == "keys") {
+            auto key_size_ = key_size(context);
+            host_buffer_type keys(num_keys_ * key_size_);
+            std::mt19937_64 generator;
+            for(length_type i = 0; i < num_keys_; i++) {
+                auto key = generator();
+                // Little-endian: The first key_size_ bytes are the low bits
+                std::memcpy(keys.data() + i * key_size_, &key, key_size_);
+            }
+            return keys;
+        }
+        if (buffer_name == "values") {
+            std::vector<value_type> positions(num_keys_);
+            std::iota(positions.begin(), positions.end(), value_type{0});
+            host_buffer_type values(num_keys_ * sizeof(value_type));
+            std::memcpy(values.data(), positions.data(), values.size());
+            return values;
+        }
+        return nullopt;
+    }
+
+    scalar_arguments_map generate_additional_scalar_arguments(execution_context_t& context) const override
+    {
+        scalar_arguments_map generated;
+        generated["num_keys"] = any(num_keys(context));
+        return generated;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        const auto& keys = context.buffers.host_side.inputs.at("keys");
+        if (keys.size() % key_size(context) != 0) { return false; }
+        if (sorts_pairs() and context.buffers.host_side.inputs.at("values").size() != num_keys(context) * sizeof(value_type)) {
+            return false;
+        }
+        if (context.scalar_input_arguments.typed.find("num_keys") !=
+            context.scalar_input_arguments.typed.cend())
+        {
+            if (get_scalar_argument<length_type>(context, "num_keys") != num_keys(context)) { return false; }
+        }
+        return num_keys(context) <= std::numeric_limits<count_type>::max();
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        auto key_bits_ = key_bits(context);
+        auto block_size_ = block_size(context);
+        return
+            (key_bits_ == 32 or key_bits_ == 64) and
+            block_size_ % 32 == 0 and block_size_ >= radix and block_size_ <= 1024 and
+            tile_length(context) > 0;
+    }
+
+    std::vector<std::string> additional_kernel_functions(const execution_context_t&) const override
+    {
+        return { scan_kernel_function, scatter_kernel_function() };
+    }
+
+    buffer_sizes scratch_buffer_sizes(const execution_context_t& context) const override
+    {
+        buffer_sizes sizes;
+        sizes["alternate_keys"] = context.buffers.host_side.inputs.at("keys").size();
+        if (sorts_pairs()) {
+            sizes["alternate_values"] = context.buffers.host_side.inputs.at("values").size();
+        }
+        sizes["digit_counts"] = std::max<std::size_t>(1, num_tiles(context)) * radix * sizeof(count_type);
+        return sizes;
+    }
+
+    std::vector<kernel_launch_step> launch_steps(const execution_context_t& context) const override
+    {
+        const auto& device_buffers = context.buffers.device_side;
+        struct buffer_pair { const device_buffer_type* keys; const device_buffer_type* values; };
+        auto values_or_null = [&](const device_buffers_map& map, const char* name) {
+            return sorts_pairs() ? &map.at(name) : nullptr;
+        };
+        const buffer_pair input     { &device_buffers.inputs.at("keys"),          values_or_null(device_buffers.inputs,  "values") };
+        const buffer_pair alternate { &device_buffers.scratch.at("alternate_keys"), values_or_null(device_buffers.scratch, "alternate_values") };
+        const buffer_pair output    { &device_buffers.outputs.at("sorted_keys"),  values_or_null(device_buffers.outputs, "sorted_values") };
+        const auto& digit_counts = device_buffers.scratch.at("digit_counts");
+
+        auto push_back_values_buffer = [&](kernel_launch_step& step, const device_buffer_type* buffer) {
+            if (buffer != nullptr) { push_back_buffer(step.arguments, context, *buffer); }
+            else { push_back_owned_scalar<const void*>(step, context, nullptr); }
+        };
+
+        auto num_tiles_ = std::max<std::size_t>(1, num_tiles(context));
+        auto make_step = [&](const char* kernel_function, std::size_t grid_length) {
+            kernel_launch_step step;
+            step.kernel_function = kernel_function;
+            step.launch_config_components.set_block_dims(block_size(context), 1, 1);
+            step.launch_config_components.set_grid_dims(grid_length, 1, 1);
+            step.launch_config_components.dynamic_shared_memory_size = 0;
+            return step;
+        };
+
+        std::vector<kernel_launch_step> steps;
+        auto num_passes = key_bits(context) / digit_bits;
+        for(unsigned pass = 0; pass < num_passes; pass++) {
+            const auto& source = (pass == 0) ? input : (pass % 2 == 0) ? output : alternate;
+            const auto& destination = (pass % 2 == 0) ? alternate : output;
+            unsigned shift = pass * digit_bits;
+
+            auto histogram = make_step("", num_tiles_); // the main kernel function
+            push_back_buffer(histogram.arguments, context, digit_counts);
+            push_back_buffer(histogram.arguments, context, *source.keys);
+            push_back_scalar<length_type>(histogram.arguments, context, "num_keys");
+            push_back_owned_scalar<unsigned>(histogram, context, shift);
+            terminate_arguments(histogram.arguments, context);
+            steps.emplace_back(std::move(histogram));
+
+            auto scan = make_step(scan_kernel_function, 1);
+            push_back_buffer(scan.arguments, context, digit_counts);
+            push_back_scalar<length_type>(scan.arguments, context, "num_keys");
+            terminate_arguments(scan.arguments, context);
+            steps.emplace_back(std::move(scan));
+
+            auto scatter = make_step(scatter_kernel_function(), num_tiles_);
+            push_back_buffer(scatter.arguments, context, *destination.keys);
+            push_back_buffer(scatter.arguments, context, *source.keys);
+            push_back_values_buffer(scatter, destination.values);
+            push_back_values_buffer(scatter, source.values);
+            push_back_buffer(scatter.arguments, context, digit_counts);
+            push_back_scalar<length_type>(scatter.arguments, context, "num_keys");
+            push_back_owned_scalar<unsigned>(scatter, context, shift);
+            terminate_arguments(scatter.arguments, context);
+            steps.emplace_back(std::move(scatter));
+        }
+        return steps;
+    }
+
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        constexpr const double keys_per_megakey { 1e6 };
+        return { { "Mkeys", num_keys(context) / keys_per_megakey } };
+    }
+};
+
+class radix_sort final : public lsd_radix_sort {
+public:
+    KA_KERNEL_FUNCTION_NAME("radixSortHistogram")
+    KA_KERNEL_KEY("bundled_with_runner/radix_sort")
+
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("sorted_keys", output, "The keys, in ascending order", same_size_as_keys),
+            buffer_details("keys", input, "The unsigned keys to sort (32 or 64 bits each)"),
+            scalar_details<length_type>("num_keys", "Number of keys; required when generating the keys", isnt_required),
+        };
+        return pd;
+    }
+
+protected:
+    bool sorts_pairs() const override { return false; }
+};
+
+class radix_sort_pairs final : public lsd_radix_sort {
+public:
+    KA_KERNEL_FUNCTION_NAME("radixSortHistogram")
+    KA_KERNEL_KEY("bundled_with_runner/radix_sort_pairs")
+
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("sorted_keys", output, "The keys, in ascending order", same_size_as_keys),
+            buffer_details("sorted_values", output, "The values, ordered by their keys (stably)", same_size_as_values),
+            buffer_details("keys", input, "The unsigned keys to sort by (32 or 64 bits each)"),
+            buffer_details("values", input, "The 32-bit values accompanying the keys"),
+            scalar_details<length_type>("num_keys", "Number of keys; required when generating the inputs", isnt_required),
+        };
+        return pd;
+    }
+
+protected:
+    bool sorts_pairs() const override { return true; }
+};
+
+} // namespace kernel_adapters
+
+#endif /* RADIX_SORT_KERNEL_ADAPTERS_HPP_ */
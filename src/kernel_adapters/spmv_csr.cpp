@@ -0,0 +1,9 @@
+#include "spmv_csr.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<spmv_csr>();
+}
+
+} // namespace kernel_adapters
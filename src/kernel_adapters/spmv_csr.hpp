@@ -0,0 +1,178 @@
+#ifndef SPMV_CSR_KERNEL_ADAPTER_HPP_
+#define SPMV_CSR_KERNEL_ADAPTER_HPP_
+
+#include "kernel_adapter.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace kernel_adapters {
+
+class spmv_csr final : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using index_type = std::uint32_t;
+
+    KA_KERNEL_FUNCTION_NAME("spmvCsr")
+    KA_KERNEL_KEY("bundled_with_runner/spmv_csr")
+
+protected:
+    enum class variant_t { scalar_rows, vector_rows, merge_path };
+
+    // These must match the defaults in the kernel source
+    enum : unsigned {
+        default_vector_width = 32,
+        default_items_per_thread = 7,
+        default_block_size = 256,
+    };
+
+    static variant_t variant(const execution_context_t& context)
+    {
+        const auto& valued_definitions = context.finalized_preprocessor_definitions.valued;
+        auto find_result = valued_definitions.find("SPMV_VARIANT");
+        if (find_result == valued_definitions.cend()) { return variant_t::scalar_rows; }
+        const auto& name = find_result->second;
+        if (name == "scalar_rows") { return variant_t::scalar_rows; }
+        if (name == "vector_rows") { return variant_t::vector_rows; }
+        if (name == "merge_path")  { return variant_t::merge_path;  }
+        throw std::invalid_argument("Unsupported SpMV variant: \"" + name + "\"");
+    }
+
+    static std::size_t y_size(
+        const host_buffers_map& input_buffers,
+        const scalar_arguments_map&,
+        const preprocessor_definitions_t&,
+        const preprocessor_value_definitions_t&,
+        const optional_launch_config_components_t&)
+    {
+        auto num_rows = input_buffers.at("row_offsets").size() / sizeof(index_type) - 1;
+        return num_rows * sizeof(float);
+    }
+
+    static std::size_t num_rows(const execution_context_t& context)
+    {
+        return context.buffers.host_side.inputs.at("row_offsets").size() / sizeof(index_type) - 1;
+    }
+
+    static std::size_t num_nonzeros(const execution_context_t& context)
+    {
+        return context.buffers.host_side.inputs.at("values").size() / sizeof(float);
+    }
+
+public:
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("y", output, "The product vector, with one element per matrix row", y_size),
+            buffer_details("row_offsets", input, "Positions of the first non-zero of each row, followed by the number of non-zeros (32-bit unsigned)"),
+            buffer_details("column_indices", input, "Column index of each non-zero (32-bit unsigned)"),
+            buffer_details("values", input, "The non-zero matrix elements (float)"),
+            buffer_details("x", input, "The vector to multiply, with one element per matrix column (float)"),
+            scalar_details<index_type>("num_rows", "Number of matrix rows", isnt_required),
+            scalar_details<index_type>("num_nonzeros", "Number of non-zero matrix elements", isnt_required),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "SPMV_VARIANT", "Work distribution: scalar_rows, vector_rows or merge_path (default: scalar_rows)", isnt_required },
+            { "VECTOR_WIDTH", "Threads per row for vector_rows; a power of 2, at most 32 (default: 32)", isnt_required },
+            { "ITEMS_PER_THREAD", "Row ends plus non-zeros handled by each thread, for merge_path (default: 7)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    // The merge-path variant accumulates rows spanning threads into y
+    bool requires_zeroed_outputs(const execution_context_t& context) const override
+    {
+        return variant(context) == variant_t::merge_path;
+    }
+
+    scalar_arguments_map generate_additional_scalar_arguments(execution_context_t& context) const override
+    {
+        scalar_arguments_map generated;
+        generated["num_rows"] = any(static_cast<index_type>(num_rows(context)));
+        generated["num_nonzeros"] = any(static_cast<index_type>(num_nonzeros(context)));
+        return generated;
+    }
+
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        const auto& inputs = context.buffers.host_side.inputs;
+        const auto& row_offsets = inputs.at("row_offsets");
+        if (row_offsets.size() < sizeof(index_type) or row_offsets.size() % sizeof(index_type) != 0) { return false; }
+        if (inputs.at("values").size() % sizeof(float) != 0) { return false; }
+        if (inputs.at("column_indices").size() != num_nonzeros(context) * sizeof(index_type)) { return false; }
+        if (inputs.at("x").size() % sizeof(float) != 0) { return false; }
+        index_type last_offset;
+        std::memcpy(&last_offset, row_offsets.data() + row_offsets.size() - sizeof(index_type), sizeof(index_type));
+        if (last_offset != num_nonzeros(context)) { return false; }
+        const auto& scalars = context.scalar_input_arguments.typed;
+        if (scalars.find("num_rows") != scalars.cend() and
+            get_scalar_argument<index_type>(context, "num_rows") != num_rows(context)) { return false; }
+        if (scalars.find("num_nonzeros") != scalars.cend() and
+            get_scalar_argument<index_type>(context, "num_nonzeros") != num_nonzeros(context)) { return false; }
+        return num_rows(context) + num_nonzeros(context) <= std::numeric_limits<index_type>::max();
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        variant(context); // throws for an unsupported variant
+        auto vector_width = defined_or_default(context, "VECTOR_WIDTH", default_vector_width);
+        return
+            vector_width > 0 and vector_width <= 32 and (vector_width & (vector_width - 1)) == 0 and
+            defined_or_default(context, "ITEMS_PER_THREAD", default_items_per_thread) > 0;
+    }
+
+    optional_launch_config_components_t deduce_launch_config(const execution_context_t& context) const override
+    {
+        auto result = context.options.forced_launch_config_components;
+        if (not result.block_dimensions) {
+            result.set_block_dims(default_block_size, 1, 1);
+        }
+        if (not result.dynamic_shared_memory_size) {
+            result.dynamic_shared_memory_size = 0;
+        }
+        if (result.grid_dimensions or result.overall_grid_dimensions) {
+            return result;
+        }
+        auto block_size = result.block_dimensions.value()[0];
+        auto threads_needed = [&]() -> std::size_t {
+            switch(variant(context)) {
+            case variant_t::scalar_rows: return num_rows(context);
+            case variant_t::vector_rows: return num_rows(context) * defined_or_default(context, "VECTOR_WIDTH", default_vector_width);
+            case variant_t::merge_path:
+            default:
+                return util::div_rounding_up(num_rows(context) + num_nonzeros(context),
+                    defined_or_default(context, "ITEMS_PER_THREAD", default_items_per_thread));
+            }
+        }();
+        std::size_t num_blocks = std::max<std::size_t>(1, util::div_rounding_up(threads_needed, block_size));
+        if (variant(context) != variant_t::merge_path) {
+            // These use grid-stride loops
+            num_blocks = std::min(num_blocks, blocks_filling_device(context, block_size));
+        }
+        result.set_grid_dims(num_blocks, 1, 1);
+        return result;
+    }
+
+    // The minimum traffic: Every input element read once, and y written once
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        const auto& inputs = context.buffers.host_side.inputs;
+        double bytes =
+            inputs.at("row_offsets").size() + inputs.at("column_indices").size() +
+            inputs.at("values").size() + inputs.at("x").size() + num_rows(context) * sizeof(float);
+        constexpr const double flops_per_nonzero { 2 };
+        return {
+            { "GB", bytes / 1e9 },
+            { "GFLOP", flops_per_nonzero * num_nonzeros(context) / 1e9 },
+        };
+    }
+};
+
+} // namespace kernel_adapters
+
+#endif /* SPMV_CSR_KERNEL_ADAPTER_HPP_ */
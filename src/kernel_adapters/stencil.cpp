@@ -0,0 +1,9 @@
+#include "stencil.hpp"
+
+namespace kernel_adapters {
+
+static_block {
+    register_in_factory<stencil>();
+}
+
+} // namespace kernel_adapters
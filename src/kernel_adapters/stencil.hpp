@@ -0,0 +1,174 @@
+#ifndef STENCIL_KERNEL_ADAPTER_HPP_
+#define STENCIL_KERNEL_ADAPTER_HPP_
+
+#include "kernel_adapter.hpp"
+
+namespace kernel_adapters {
+
+/**
+ * Runs one or more time steps of the bundled stencil kernel. Each time step is a
+ * separate launch; they alternate between the result buffer and a scratch buffer,
+ * arranged so that the last one writes the result buffer. The first time step
+ * reads the input grid, so the input remains intact across runs.
+ */
+class stencil final : public kernel_adapter {
+public:
+    using parent = kernel_adapter;
+    using dimension_type = unsigned;
+
+    KA_KERNEL_FUNCTION_NAME("stencil")
+    KA_KERNEL_KEY("bundled_with_runner/stencil")
+
+protected:
+    // These must match the defaults in the kernel sources
+    enum : unsigned {
+        default_stencil_points = 5,
+        default_block_x = 32,
+        default_block_y = 8,
+        default_cells_per_thread = 8,
+    };
+
+    static unsigned stencil_points(const execution_context_t& context)
+    {
+        return defined_or_default(context, "STENCIL_POINTS", default_stencil_points);
+    }
+
+    static bool is_2d(const execution_context_t& context) { return stencil_points(context) == 5; }
+
+    // Note: May be called before the defaults are filled in
+    static unsigned time_steps(const execution_context_t& context)
+    {
+        const auto& scalars = context.scalar_input_arguments.typed;
+        if (scalars.find("time_steps") == scalars.cend()) { return 1; }
+        return get_scalar_argument<unsigned>(context, "time_steps");
+    }
+
+    static std::size_t same_size_as_grid(
+        const host_buffers_map& input_buffers,
+        const scalar_arguments_map&,
+        const preprocessor_definitions_t&,
+        const preprocessor_value_definitions_t&,
+        const optional_launch_config_components_t&)
+    {
+        return input_buffers.at("grid").size();
+    }
+
+    std::size_t num_cells(const execution_context_t& context) const
+    {
+        return std::size_t{get_scalar_argument<dimension_type>(context, "nx")} *
+            get_scalar_argument<dimension_type>(context, "ny") *
+            get_scalar_argument<dimension_type>(context, "nz");
+    }
+
+public:
+    const parameter_details_type& parameter_details() const override
+    {
+        static const parameter_details_type pd = {
+            buffer_details("result", output, "The grid after the last time step", same_size_as_grid),
+            buffer_details("grid", input, "The initial grid of floats, with x varying fastest, then y, then z"),
+            scalar_details<dimension_type>("nx", "Grid length along the x axis"),
+            scalar_details<dimension_type>("ny", "Grid length along the y axis"),
+            scalar_details<dimension_type>("nz", "Grid length along the z axis (default: 1; must be 1 for 2D stencils)", isnt_required),
+            scalar_details<unsigned>("time_steps", "Number of stencil iterations per run (default: 1)", isnt_required),
+        };
+        return pd;
+    }
+
+    const preprocessor_definitions_type& preprocessor_definition_details() const override
+    {
+        static const preprocessor_definitions_type preprocessor_definitions = {
+            { "STENCIL_POINTS", "5 (2D), 7 or 27 (3D) (default: 5)", isnt_required },
+            { "STENCIL_USE_SHARED_MEMORY", "Stage grid plane tiles, with halos, in shared memory; otherwise, gather directly into registers", isnt_required },
+            { "BLOCK_X", "Block dimension along x (default: 32)", isnt_required },
+            { "BLOCK_Y", "Block dimension along y (default: 8)", isnt_required },
+            { "CELLS_PER_THREAD", "Cells computed by each thread, along the last grid dimension (default: 8)", isnt_required },
+        };
+        return preprocessor_definitions;
+    }
+
+    scalar_arguments_map generate_additional_scalar_arguments(execution_context_t&) const override
+    {
+        // Only used where not specified by the user
+        scalar_arguments_map generated;
+        generated["nz"] = any(dimension_type{1});
+        generated["time_steps"] = any(1u);
+        return generated;
+    }
+
+    // Note: Called before the defaults are filled in
+    bool input_sizes_are_valid(const execution_context_t& context) const override
+    {
+        const auto& scalars = context.scalar_input_arguments.typed;
+        std::size_t nz = (scalars.find("nz") == scalars.cend()) ? 1 : get_scalar_argument<dimension_type>(context, "nz");
+        std::size_t nx = get_scalar_argument<dimension_type>(context, "nx");
+        std::size_t ny = get_scalar_argument<dimension_type>(context, "ny");
+        if (nx == 0 or ny == 0 or nz == 0) { return false; }
+        if (is_2d(context) and nz != 1) { return false; }
+        return context.buffers.host_side.inputs.at("grid").size() == nx * ny * nz * sizeof(float);
+    }
+
+    bool extra_validity_checks(const execution_context_t& context) const override
+    {
+        auto points = stencil_points(context);
+        // With no time steps, there would be no launch steps - and the adapter can't be launched otherwise
+        return (points == 5 or points == 7 or points == 27) and time_steps(context) > 0;
+    }
+
+    buffer_sizes scratch_buffer_sizes(const execution_context_t& context) const override
+    {
+        if (time_steps(context) <= 1) { return {}; }
+        return { { "alternate_grid", context.buffers.host_side.inputs.at("grid").size() } };
+    }
+
+    std::vector<kernel_launch_step> launch_steps(const execution_context_t& context) const override
+    {
+        auto block_x = defined_or_default(context, "BLOCK_X", default_block_x);
+        auto block_y = defined_or_default(context, "BLOCK_Y", default_block_y);
+        auto cells_per_thread = defined_or_default(context, "CELLS_PER_THREAD", default_cells_per_thread);
+        auto nx = get_scalar_argument<dimension_type>(context, "nx");
+        auto ny = get_scalar_argument<dimension_type>(context, "ny");
+        auto nz = get_scalar_argument<dimension_type>(context, "nz");
+        optional_launch_config_components_t lc;
+        lc.set_block_dims(block_x, block_y, 1);
+        if (is_2d(context)) {
+            lc.set_grid_dims(util::div_rounding_up(nx, block_x), util::div_rounding_up(ny, block_y * cells_per_thread), 1);
+        }
+        else {
+            lc.set_grid_dims(util::div_rounding_up(nx, block_x), util::div_rounding_up(ny, block_y), util::div_rounding_up(nz, cells_per_thread));
+        }
+        lc.dynamic_shared_memory_size = 0;
+
+        const auto& device_buffers = context.buffers.device_side;
+        const auto& input = device_buffers.inputs.at("grid");
+        const auto& output = device_buffers.outputs.at("result");
+        auto num_time_steps = time_steps(context);
+        std::vector<kernel_launch_step> steps;
+        const device_buffer_type* source = &input;
+        for(unsigned t = 0; t < num_time_steps; t++) {
+            auto steps_remaining_after_this_one = num_time_steps - 1 - t;
+            const auto& destination = (steps_remaining_after_this_one % 2 == 0) ?
+                output : device_buffers.scratch.at("alternate_grid");
+            kernel_launch_step step;
+            step.launch_config_components = lc;
+            push_back_buffer(step.arguments, context, destination);
+            push_back_buffer(step.arguments, context, *source);
+            push_back_scalar<dimension_type>(step.arguments, context, "nx");
+            push_back_scalar<dimension_type>(step.arguments, context, "ny");
+            push_back_scalar<dimension_type>(step.arguments, context, "nz");
+            terminate_arguments(step.arguments, context);
+            steps.emplace_back(std::move(step));
+            source = &destination;
+        }
+        return steps;
+    }
+
+    std::vector<work_quantity> work_per_run(const execution_context_t& context) const override
+    {
+        constexpr const double cells_per_gigacell { 1e9 };
+        return { { "Gcell-updates", double(num_cells(context)) * time_steps(context) / cells_per_gigacell } };
+    }
+};
+
+} // namespace kernel_adapters
+
+#endif /* STENCIL_KERNEL_ADAPTER_HPP_ */
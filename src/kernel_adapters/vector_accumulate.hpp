@@ -2,6 +2,7 @@
 #define VECTOR_ACCUMULATE_KERNEL_ADAPTER_HPP_
 
 #include "kernel_adapter.hpp"
+#include "host_reference.hpp"
 
 namespace kernel_adapters {
 
@@ -16,7 +17,7 @@ public:
     const parameter_details_type& parameter_details() const override
     {
         static const parameter_details_type pd = {
-            buffer_details("A", output, "Accumulator sequence (initialized with a second sequence of addends"),
+            buffer_details("A", inout, "Accumulator sequence (initialized with a second sequence of addends)"),
             buffer_details("B", input, "Sequence of addends"),
             scalar_details<length_type>("length", "Length of each of A and B"),
         };
@@ -60,6 +61,27 @@ public:
         return result;
     }
 
+    // Only available when A_LITTLE_EXTRA is defined as an integer (rather than, say, an expression)
+    optional<host_reference_t> host_reference(const execution_context_t& context) const override
+    {
+        int little_extra;
+        try {
+            little_extra = util::from_string<int>(context.finalized_preprocessor_definitions.valued.at("A_LITTLE_EXTRA"));
+        }
+        catch(std::exception&) { return nullopt; }
+        const auto& initial_a = context.buffers.host_side.inputs.at("A");
+        const auto& b = context.buffers.host_side.inputs.at("B");
+        auto compute = [&initial_a, &b, little_extra](host_buffers_map& outputs, unsigned num_threads) {
+            auto& a = outputs.at("A");
+            host_reference::add_bytes(
+                reinterpret_cast<unsigned char*>(a.data()),
+                reinterpret_cast<const unsigned char*>(initial_a.data()),
+                reinterpret_cast<const unsigned char*>(b.data()),
+                static_cast<unsigned char>(little_extra), a.size(), num_threads);
+        };
+        return host_reference_t{ { { "A", element_type_t::uint8 } }, compute };
+    }
+
     virtual const preprocessor_definitions_type& preprocessor_definition_details() const override
     {
         static const preprocessor_definitions_type preprocessor_definitions = {
@@ -2,6 +2,7 @@
 #define VECTOR_ADD_KERNEL_ADAPTER_HPP_
 
 #include "kernel_adapter.hpp"
+#include "host_reference.hpp"
 
 
 namespace kernel_adapters {
@@ -47,6 +48,27 @@ public:
         return true;
     }
 
+    // Only available when A_LITTLE_EXTRA is defined as an integer (rather than, say, an expression)
+    optional<host_reference_t> host_reference(const execution_context_t& context) const override
+    {
+        int little_extra;
+        try {
+            little_extra = util::from_string<int>(context.finalized_preprocessor_definitions.valued.at("A_LITTLE_EXTRA"));
+        }
+        catch(std::exception&) { return nullopt; }
+        const auto& a = context.buffers.host_side.inputs.at("A");
+        const auto& b = context.buffers.host_side.inputs.at("B");
+        auto compute = [&a, &b, little_extra](host_buffers_map& outputs, unsigned num_threads) {
+            auto& c = outputs.at("C");
+            host_reference::add_bytes(
+                reinterpret_cast<unsigned char*>(c.data()),
+                reinterpret_cast<const unsigned char*>(a.data()),
+                reinterpret_cast<const unsigned char*>(b.data()),
+                static_cast<unsigned char>(little_extra), c.size(), num_threads);
+        };
+        return host_reference_t{ { { "C", element_type_t::uint8 } }, compute };
+    }
+
     virtual const preprocessor_definitions_type& preprocessor_definition_details() const override
     {
         static const preprocessor_definitions_type preprocessor_definitions = {
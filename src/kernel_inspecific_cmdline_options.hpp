@@ -4,6 +4,7 @@
 #include "common_types.hpp" // for execution_ecosystem_t
 
 #include "launch_configuration.hpp"
+#include "element_conversion.hpp"
 
 #include <util/filesystem.hpp>
 #include <util/optional_and_any.hpp>
@@ -13,6 +14,16 @@
 
 #include <string>
 #include <cstdlib>
+#include <unordered_map>
+
+// Identifies an output buffer of an earlier kernel in a pipeline, to be used as an input buffer
+struct buffer_binding_t {
+    std::size_t stage_index; // 0-based
+    std::string output_buffer_name;
+};
+
+// How output files written through memory mappings are flushed to storage
+enum class output_file_sync_t { none, msync, fsync };
 
 // These options are common, and relevant, to any and all kernel adapters
 struct kernel_inspecific_cmdline_options_t {
@@ -40,7 +51,12 @@ struct kernel_inspecific_cmdline_options_t {
     include_paths_t include_dir_paths;
     include_paths_t preinclude_files;
     bool zero_output_buffers;
+    bool generate_inputs;
     bool write_output_buffers_to_files;
+    bool map_output_files; // copy outputs from the device directly into memory-mapped files
+    output_file_sync_t output_file_sync;
+    bool compress_output_files; // even those whose names don't indicate compression
+    element_conversions_t element_conversions; // between the buffer files' and the kernel's element types
     bool overwrite_allowed;
     bool write_ptx_to_file;
     bool always_print_compilation_log;
@@ -53,7 +69,20 @@ struct kernel_inspecific_cmdline_options_t {
     filesystem::path compilation_log_file;
     std::string language_standard; // At the moment, possible values are: empty, "c++11","c++14", "c++17"
     bool time_with_events;
+    std::size_t num_verification_samples; // of each output buffer; 0 for no verification
+    bool run_host_reference; // to check the outputs against, and compare the kernel's speed with
+    double verification_tolerance; // relative, for floating-point elements
+    std::unordered_map<std::string, element_type_t> output_scans; // floating-point outputs to scan after each run
+    bool check_determinism; // by comparing hashes of the outputs, computed on the device, across runs
+    bool watch_sources; // rebuild and rerun whenever the kernel sources change
+    struct {
+        bool enabled;
+        std::string input, output; // paths (e.g. of named pipes), or "-" for the standard input/output
+    } frame_stream;
     optional_launch_config_components_t forced_launch_config_components;
+    bool persistent_grid; // a grid exactly filling the device, rather than the forced or deduced one
+    std::unordered_map<std::string, buffer_binding_t> input_buffer_bindings; // only used for pipeline stages
+    filesystem::path record_directory; // empty unless the run is to be recorded for replay
 };
 
 #endif /* KERNEL_INSPECIFIC_COMMAND_LINE_OPTIONS_HPP_ */
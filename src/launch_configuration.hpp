@@ -50,6 +50,18 @@ DISABLE_WARNING_POP
 
 
 
+// An L2 cache access-policy window over (the beginning of) a buffer: a fraction of the kernel's
+// accesses to it are persisting, i.e. they tend to keep the buffer's lines in the part of the L2
+// cache set aside for such accesses, rather than have them evicted by streaming accesses to
+// other data. CUDA only; requires compute capability 8.0 or later.
+struct l2_access_policy_window_t {
+    std::string            buffer_name;
+    float                  hit_ratio { 1.0f }; // the fraction of accesses in the window which are persisting
+    optional<std::size_t>  persisting_l2_size; // the L2 carve-out for persisting accesses, in bytes; the device's maximum if unset
+    optional<std::size_t>  num_bytes;
+        // Set by the runner: the whole buffer, unless it exceeds the device's maximum window size
+};
+
 // Note: According to this: https://stackoverflow.com/questions/8990454
 // floats can be serialized and de-serialized with perfect accuracy if we
 // use 9 decimal digits (17 for double values)
@@ -63,7 +75,18 @@ struct optional_launch_config_components_t {
     optional<std::array<std::size_t, 3>>   overall_grid_dimensions;
 
     optional<cuda::memory::shared::size_t> dynamic_shared_memory_size;
-    // TODO: Add an optional boolean for cooperativity
+    optional<bool>                         cooperative;
+        // A cooperative launch guarantees all of the grid's blocks are co-resident, so they may
+        // synchronize with each other (e.g. using cooperative_groups::this_grid().sync())
+
+    // Launch attributes beyond the basic configuration (CUDA only)
+    optional<std::array<std::size_t, 3>>   cluster_dimensions;
+        // in blocks, each dividing the corresponding grid dimension; requires CUDA 12.0 and
+        // compute capability 9.0 or later
+    optional<l2_access_policy_window_t>    l2_access_policy_window;
+    optional<int>                          preferred_shared_memory_carveout;
+        // the percentage of a multiprocessor's maximum shared memory to prefer having configured
+        // as shared memory, the rest serving as L1 cache; a hint, applied to the kernel function
 
     bool all_values_present(execution_ecosystem_t ecosystem) const noexcept {
         return
@@ -128,6 +151,13 @@ struct optional_launch_config_components_t {
         else { deduce_overall_dimensions(); }
     }
 
+    // Whether the launch must use the driver's extended launch API, as cuda::launch_configuration_t
+    // can't express all of its attributes
+    bool has_extended_launch_attributes() const noexcept
+    {
+        return (bool) cluster_dimensions or (bool) l2_access_policy_window;
+    }
+
     void set_block_dims(size_t x, size_t y, size_t z)
     {
         block_dimensions.emplace(std::array<size_t, 3>{x, y, z});
@@ -158,7 +188,8 @@ struct optional_launch_config_components_t {
                 { (cuda::grid::block_dimension_t) bd[0],
                   (cuda::grid::block_dimension_t) bd[1],
                   (cuda::grid::block_dimension_t) bd[2] },
-                dynamic_shared_memory_size.value_or(0)
+                dynamic_shared_memory_size.value_or(0),
+                cooperative.value_or(false)
             };
         }
         else {
@@ -184,7 +215,8 @@ struct optional_launch_config_components_t {
                 { (cuda::grid::block_dimension_t) bd[0],
                   (cuda::grid::block_dimension_t) bd[1],
                   (cuda::grid::block_dimension_t) bd[2] },
-                dynamic_shared_memory_size.value_or(0)
+                dynamic_shared_memory_size.value_or(0),
+                cooperative.value_or(false)
             };
         }
     }
@@ -195,6 +227,12 @@ struct optional_launch_config_components_t {
         if (dynamic_shared_memory_size.value_or(0) > 0) {
             throw std::runtime_error("Can't force non-argument-specific dynamic shared memory for an OpenCL kernel");
         }
+        if (cooperative.value_or(false)) {
+            throw std::runtime_error("Cooperative launches are not supported for OpenCL kernels");
+        }
+        if (cluster_dimensions or l2_access_policy_window or preferred_shared_memory_carveout) {
+            throw std::runtime_error("CUDA launch attributes can't be set for an OpenCL kernel");
+        }
         if(not block_dimensions) {
             throw std::runtime_error("Block dimensions not specified");
         }
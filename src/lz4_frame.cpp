@@ -0,0 +1,471 @@
+#include "lz4_frame.hpp"
+
+#include <util/parallel.hpp>
+#include <util/miscellany.hpp>
+#include <util/optional_and_any.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lz4_frame {
+
+namespace {
+
+using byte = unsigned char;
+
+constexpr const std::uint32_t frame_magic { 0x184D2204 };
+constexpr const std::uint32_t skippable_frame_magic_mask { 0xFFFFFFF0 };
+constexpr const std::uint32_t skippable_frame_magic { 0x184D2A50 };
+constexpr const std::uint32_t uncompressed_block_flag { 0x80000000 };
+
+enum : byte {
+    flag_version         = 0x40,
+    flag_version_mask    = 0xC0,
+    flag_independent     = 0x20,
+    flag_block_checksum  = 0x10,
+    flag_content_size    = 0x08,
+    flag_content_checksum= 0x04,
+    flag_reserved        = 0x02,
+    flag_dictionary_id   = 0x01,
+};
+
+// The block maximum size code used when compressing: 7 means 4 MiB
+constexpr const byte compression_block_size_code { 7 };
+
+std::size_t block_max_size(byte size_code)
+{
+    return std::size_t{1} << (8 + 2 * size_code);
+}
+
+// LZ4 block format constants
+constexpr const std::size_t min_match { 4 };
+constexpr const std::size_t last_literals { 5 };
+constexpr const std::size_t match_search_limit { 12 }; // no match may start within this distance of the end
+constexpr const std::size_t max_offset { 65535 };
+constexpr const unsigned hash_log { 16 };
+
+[[noreturn]] void fail(const std::string& what)
+{
+    throw std::runtime_error("Invalid or unsupported LZ4 frame data: " + what);
+}
+
+inline std::uint32_t read_le32(const byte* p)
+{
+    return std::uint32_t{p[0]} | (std::uint32_t{p[1]} << 8) | (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[3]} << 24);
+}
+
+inline std::uint64_t read_le64(const byte* p)
+{
+    return std::uint64_t{read_le32(p)} | (std::uint64_t{read_le32(p + 4)} << 32);
+}
+
+inline void append_le32(host_buffer_type& out, std::uint32_t x)
+{
+    for(int i = 0; i < 4; i++) { out.push_back(static_cast<byte_type>((x >> (8 * i)) & 0xFF)); }
+}
+
+inline void append_le64(host_buffer_type& out, std::uint64_t x)
+{
+    append_le32(out, static_cast<std::uint32_t>(x));
+    append_le32(out, static_cast<std::uint32_t>(x >> 32));
+}
+
+inline std::uint32_t read_unaligned_32(const byte* p)
+{
+    std::uint32_t x;
+    std::memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+inline std::uint32_t rotl32(std::uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+
+constexpr const std::uint32_t prime32_1 { 2654435761U };
+constexpr const std::uint32_t prime32_2 { 2246822519U };
+constexpr const std::uint32_t prime32_3 { 3266489917U };
+constexpr const std::uint32_t prime32_4 {  668265263U };
+constexpr const std::uint32_t prime32_5 {  374761393U };
+
+inline std::uint32_t xxh32_round(std::uint32_t accumulator, std::uint32_t input)
+{
+    return rotl32(accumulator + input * prime32_2, 13) * prime32_1;
+}
+
+std::size_t compress_bound(std::size_t size) { return size + size / 255 + 16; }
+
+inline std::uint32_t hash_of(std::uint32_t sequence)
+{
+    return (sequence * prime32_1) >> (32 - hash_log);
+}
+
+void write_length_continuation(byte*& op, std::size_t length)
+{
+    for(; length >= 255; length -= 255) { *op++ = 255; }
+    *op++ = static_cast<byte>(length);
+}
+
+// Emits one sequence: literals, then (unless this is the last sequence) a match
+void write_sequence(byte*& op, const byte* literals, std::size_t num_literals, std::size_t offset, std::size_t match_length)
+{
+    byte* token = op++;
+    *token = static_cast<byte>(std::min<std::size_t>(num_literals, 15) << 4);
+    if (num_literals >= 15) { write_length_continuation(op, num_literals - 15); }
+    std::memcpy(op, literals, num_literals);
+    op += num_literals;
+    if (match_length == 0) { return; }
+    *op++ = static_cast<byte>(offset & 0xFF);
+    *op++ = static_cast<byte>(offset >> 8);
+    auto match_length_code = match_length - min_match;
+    *token |= static_cast<byte>(std::min<std::size_t>(match_length_code, 15));
+    if (match_length_code >= 15) { write_length_continuation(op, match_length_code - 15); }
+}
+
+// A greedy single-probe compressor, like the reference implementation's default (fast) mode.
+// The destination must have room for compress_bound(size) bytes; returns the compressed size.
+std::size_t compress_block(const byte* src, std::size_t size, byte* dst, std::vector<std::uint32_t>& hash_table)
+{
+    byte* op = dst;
+    std::size_t anchor { 0 };
+    if (size > match_search_limit) {
+        std::fill(hash_table.begin(), hash_table.end(), 0); // Entries hold position + 1; 0 means empty
+        const std::size_t last_match_start = size - match_search_limit;
+        const std::size_t match_end_limit = size - last_literals;
+        std::size_t pos { 0 };
+        unsigned search_attempts { 0 };
+        while (pos <= last_match_start) {
+            auto sequence = read_unaligned_32(src + pos);
+            auto& entry = hash_table[hash_of(sequence)];
+            std::size_t candidate = entry;
+            entry = static_cast<std::uint32_t>(pos + 1);
+            if (candidate == 0 or pos - (candidate - 1) > max_offset or read_unaligned_32(src + candidate - 1) != sequence) {
+                // Skip ahead faster the longer we go without a match, as the data is likely incompressible
+                pos += 1 + (search_attempts++ >> 6);
+                continue;
+            }
+            search_attempts = 0;
+            std::size_t match = candidate - 1;
+            while (pos > anchor and match > 0 and src[pos - 1] == src[match - 1]) { pos--; match--; }
+            std::size_t length { min_match };
+            while (pos + length < match_end_limit and src[pos + length] == src[match + length]) { length++; }
+            write_sequence(op, src + anchor, pos - anchor, pos - match, length);
+            pos += length;
+            anchor = pos;
+            if (pos - 2 <= last_match_start) {
+                hash_table[hash_of(read_unaligned_32(src + pos - 2))] = static_cast<std::uint32_t>(pos - 2 + 1);
+            }
+        }
+    }
+    write_sequence(op, src + anchor, size - anchor, 0, 0);
+    return static_cast<std::size_t>(op - dst);
+}
+
+// Decompresses into [dst, dst_end), where matches may reach back as far as window_start;
+// returns the decompressed size
+std::size_t decompress_block(const byte* src, std::size_t size, byte* dst, byte* dst_end, const byte* window_start)
+{
+    const byte* ip = src;
+    const byte* const ip_end = src + size;
+    byte* op = dst;
+    auto read_length_continuation = [&](std::size_t& length) {
+        byte b;
+        do {
+            if (ip >= ip_end) { fail("truncated block"); }
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+    };
+    while (true) {
+        if (ip >= ip_end) { fail("truncated block"); }
+        auto token = *ip++;
+        std::size_t num_literals = token >> 4;
+        if (num_literals == 15) { read_length_continuation(num_literals); }
+        if (num_literals > static_cast<std::size_t>(ip_end - ip) or num_literals > static_cast<std::size_t>(dst_end - op)) {
+            fail("literals overrunning the block");
+        }
+        std::memcpy(op, ip, num_literals);
+        ip += num_literals;
+        op += num_literals;
+        if (ip == ip_end) { break; } // The last sequence has no match
+        if (ip_end - ip < 2) { fail("truncated block"); }
+        std::size_t offset = std::size_t{ip[0]} | (std::size_t{ip[1]} << 8);
+        ip += 2;
+        if (offset == 0 or offset > static_cast<std::size_t>(op - window_start)) { fail("match offset out of range"); }
+        std::size_t length = token & 0x0F;
+        if (length == 15) { read_length_continuation(length); }
+        length += min_match;
+        if (length > static_cast<std::size_t>(dst_end - op)) { fail("match overrunning the block"); }
+        const byte* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        }
+        else {
+            // Overlapping: the match repeats the bytes being written
+            for(std::size_t i = 0; i < length; i++) { *op++ = *match++; }
+        }
+    }
+    return static_cast<std::size_t>(op - dst);
+}
+
+struct block_t {
+    const byte* data;
+    std::size_t size;
+    bool compressed;
+    optional<std::uint32_t> checksum;
+};
+
+struct frame_descriptor_t {
+    bool independent_blocks;
+    bool has_block_checksums;
+    bool has_content_checksum;
+    std::size_t block_max_size;
+    optional<std::uint64_t> content_size;
+};
+
+std::size_t decompress_block_into(const block_t& block, byte* dst, byte* dst_end, const byte* window_start)
+{
+    if (block.checksum and xxh32(block.data, block.size) != block.checksum.value()) {
+        fail("block checksum mismatch");
+    }
+    if (not block.compressed) {
+        if (block.size > static_cast<std::size_t>(dst_end - dst)) { fail("block exceeding the maximum block size"); }
+        std::memcpy(dst, block.data, block.size);
+        return block.size;
+    }
+    return decompress_block(block.data, block.size, dst, dst_end, window_start);
+}
+
+// Blocks may only be decompressed independently if they're known to do so, and their
+// positions in the output - all but the last must be full - can be determined up-front
+bool decompress_blocks_in_parallel(
+    const frame_descriptor_t&   descriptor,
+    const std::vector<block_t>& blocks,
+    host_buffer_type&           output,
+    unsigned                    num_threads)
+{
+    if (not descriptor.independent_blocks or not descriptor.content_size) { return false; }
+    auto content_size = descriptor.content_size.value();
+    if (util::div_rounding_up(content_size, descriptor.block_max_size) != blocks.size()) { return false; }
+    auto frame_start = output.size();
+    output.resize(frame_start + content_size);
+    auto out = reinterpret_cast<byte*>(output.data()) + frame_start;
+    std::atomic<bool> all_full { true };
+    util::parallel_for(blocks.size(), num_threads, [&](std::size_t i) {
+        auto block_start = out + i * descriptor.block_max_size;
+        auto expected_size = std::min<std::size_t>(descriptor.block_max_size, content_size - i * descriptor.block_max_size);
+        auto block_end = block_start + expected_size;
+        if (decompress_block_into(blocks[i], block_start, block_end, block_start) != expected_size) { all_full = false; }
+    });
+    if (not all_full) {
+        output.resize(frame_start);
+        return false;
+    }
+    return true;
+}
+
+void decompress_blocks_sequentially(
+    const frame_descriptor_t&   descriptor,
+    const std::vector<block_t>& blocks,
+    host_buffer_type&           output)
+{
+    auto frame_start = output.size();
+    if (descriptor.content_size) { output.reserve(frame_start + descriptor.content_size.value()); }
+    for(const auto& block : blocks) {
+        auto block_start = output.size();
+        output.resize(block_start + descriptor.block_max_size);
+        auto out = reinterpret_cast<byte*>(output.data());
+        auto window_start = descriptor.independent_blocks ? out + block_start : out + frame_start;
+        auto decompressed_size = decompress_block_into(block, out + block_start, out + output.size(), window_start);
+        output.resize(block_start + decompressed_size);
+    }
+}
+
+// Decompresses the frame at the beginning of the input, appending to the output;
+// returns the size of the frame
+std::size_t decompress_frame(const byte* frame, std::size_t available, host_buffer_type& output, unsigned num_threads)
+{
+    const byte* ip = frame;
+    const byte* const end = frame + available;
+    auto need = [&](std::size_t n) { if (static_cast<std::size_t>(end - ip) < n) { fail("truncated frame"); } };
+
+    need(4);
+    auto magic = read_le32(ip);
+    ip += 4;
+    if ((magic & skippable_frame_magic_mask) == skippable_frame_magic) {
+        need(4);
+        std::size_t skipped_size = read_le32(ip);
+        ip += 4;
+        need(skipped_size);
+        return static_cast<std::size_t>(ip - frame) + skipped_size;
+    }
+    if (magic != frame_magic) { fail("bad magic number"); }
+
+    need(2);
+    const byte* descriptor_start = ip;
+    auto flags = *ip++;
+    auto block_descriptor = *ip++;
+    if ((flags & flag_version_mask) != flag_version) { fail("unsupported format version"); }
+    if (flags & flag_dictionary_id) { fail("frames using a dictionary are not supported"); }
+    auto block_size_code = static_cast<byte>((block_descriptor >> 4) & 0x07);
+    if (block_size_code < 4) { fail("bad block maximum size"); }
+    frame_descriptor_t descriptor;
+    descriptor.independent_blocks = flags & flag_independent;
+    descriptor.has_block_checksums = flags & flag_block_checksum;
+    descriptor.has_content_checksum = flags & flag_content_checksum;
+    descriptor.block_max_size = block_max_size(block_size_code);
+    if (flags & flag_content_size) {
+        need(8);
+        descriptor.content_size = read_le64(ip);
+        ip += 8;
+    }
+    need(1);
+    auto expected_header_checksum = static_cast<byte>((xxh32(descriptor_start, static_cast<std::size_t>(ip - descriptor_start)) >> 8) & 0xFF);
+    if (*ip++ != expected_header_checksum) { fail("frame header checksum mismatch"); }
+
+    std::vector<block_t> blocks;
+    while (true) {
+        need(4);
+        auto block_header = read_le32(ip);
+        ip += 4;
+        if (block_header == 0) { break; } // The end mark
+        block_t block;
+        block.compressed = not (block_header & uncompressed_block_flag);
+        block.size = block_header & ~uncompressed_block_flag;
+        if (block.size > descriptor.block_max_size) { fail("block exceeding the maximum block size"); }
+        need(block.size);
+        block.data = ip;
+        ip += block.size;
+        if (descriptor.has_block_checksums) {
+            need(4);
+            block.checksum = read_le32(ip);
+            ip += 4;
+        }
+        blocks.push_back(block);
+    }
+
+    auto frame_start = output.size();
+    if (not decompress_blocks_in_parallel(descriptor, blocks, output, num_threads)) {
+        decompress_blocks_sequentially(descriptor, blocks, output);
+    }
+    auto decompressed_size = output.size() - frame_start;
+    if (descriptor.content_size and decompressed_size != descriptor.content_size.value()) {
+        fail("content size mismatch");
+    }
+    if (descriptor.has_content_checksum) {
+        need(4);
+        if (xxh32(output.data() + frame_start, decompressed_size) != read_le32(ip)) {
+            fail("content checksum mismatch");
+        }
+        ip += 4;
+    }
+    return static_cast<std::size_t>(ip - frame);
+}
+
+} // namespace
+
+std::uint32_t xxh32(const void* data, std::size_t size, std::uint32_t seed)
+{
+    auto p = static_cast<const byte*>(data);
+    const byte* const end = p + size;
+    std::uint32_t hash;
+    if (size >= 16) {
+        std::uint32_t v1 = seed + prime32_1 + prime32_2;
+        std::uint32_t v2 = seed + prime32_2;
+        std::uint32_t v3 = seed;
+        std::uint32_t v4 = seed - prime32_1;
+        for(; end - p >= 16; p += 16) {
+            v1 = xxh32_round(v1, read_le32(p));
+            v2 = xxh32_round(v2, read_le32(p + 4));
+            v3 = xxh32_round(v3, read_le32(p + 8));
+            v4 = xxh32_round(v4, read_le32(p + 12));
+        }
+        hash = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+    }
+    else {
+        hash = seed + prime32_5;
+    }
+    hash += static_cast<std::uint32_t>(size);
+    for(; end - p >= 4; p += 4) {
+        hash = rotl32(hash + read_le32(p) * prime32_3, 17) * prime32_4;
+    }
+    for(; p < end; p++) {
+        hash = rotl32(hash + (*p) * prime32_5, 11) * prime32_1;
+    }
+    hash ^= hash >> 15;
+    hash *= prime32_2;
+    hash ^= hash >> 13;
+    hash *= prime32_3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+host_buffer_type compress(poor_mans_span data, unsigned num_threads)
+{
+    auto src = reinterpret_cast<const byte*>(data.data());
+    const auto block_size = block_max_size(compression_block_size_code);
+    auto num_blocks = util::div_rounding_up(data.size(), block_size);
+
+    // Each block is compressed into its own buffer, with its header; these are concatenated
+    // once all are done. The content checksum is computed alongside the last block.
+    std::vector<host_buffer_type> compressed_blocks(num_blocks);
+    std::uint32_t content_checksum { 0 };
+    util::parallel_for(num_blocks + 1, num_threads, [&](std::size_t i) {
+        if (i == num_blocks) {
+            content_checksum = xxh32(src, data.size());
+            return;
+        }
+        thread_local std::vector<std::uint32_t> hash_table(std::size_t{1} << hash_log);
+        auto block_start = src + i * block_size;
+        auto size = std::min(block_size, data.size() - i * block_size);
+        auto& compressed = compressed_blocks[i];
+        compressed.resize(4 + compress_bound(size));
+        auto compressed_data = reinterpret_cast<byte*>(compressed.data()) + 4;
+        auto compressed_size = compress_block(block_start, size, compressed_data, hash_table);
+        std::uint32_t block_header = static_cast<std::uint32_t>(compressed_size);
+        if (compressed_size >= size) {
+            // Not worth it; store the block as-is
+            std::memcpy(compressed_data, block_start, size);
+            compressed_size = size;
+            block_header = static_cast<std::uint32_t>(size) | uncompressed_block_flag;
+        }
+        compressed.resize(4 + compressed_size);
+        for(int b = 0; b < 4; b++) { compressed[b] = static_cast<byte_type>((block_header >> (8 * b)) & 0xFF); }
+    });
+
+    host_buffer_type result;
+    std::size_t total_size { 4 + 2 + 8 + 1 + 4 + 4 };
+    for(const auto& block : compressed_blocks) { total_size += block.size(); }
+    result.reserve(total_size);
+    append_le32(result, frame_magic);
+    auto descriptor_start = result.size();
+    result.push_back(static_cast<byte_type>(flag_version | flag_independent | flag_content_size | flag_content_checksum));
+    result.push_back(static_cast<byte_type>(compression_block_size_code << 4));
+    append_le64(result, data.size());
+    auto header_checksum = xxh32(result.data() + descriptor_start, result.size() - descriptor_start);
+    result.push_back(static_cast<byte_type>((header_checksum >> 8) & 0xFF));
+    for(const auto& block : compressed_blocks) {
+        result.insert(result.end(), block.cbegin(), block.cend());
+    }
+    append_le32(result, 0); // end mark
+    append_le32(result, content_checksum);
+    spdlog::trace("Compressed {} bytes into an LZ4 frame of {} bytes, in {} blocks", data.size(), result.size(), num_blocks);
+    return result;
+}
+
+host_buffer_type decompress(poor_mans_span compressed, unsigned num_threads)
+{
+    auto src = reinterpret_cast<const byte*>(compressed.data());
+    host_buffer_type result;
+    if (compressed.size() == 0) { fail("no frame"); }
+    for(std::size_t pos = 0; pos < compressed.size(); ) {
+        pos += decompress_frame(src + pos, compressed.size() - pos, result, num_threads);
+    }
+    return result;
+}
+
+} // namespace lz4_frame
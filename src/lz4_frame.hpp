@@ -0,0 +1,27 @@
+#ifndef LZ4_FRAME_HPP_
+#define LZ4_FRAME_HPP_
+
+#include <common_types.hpp>
+
+/**
+ * A self-contained implementation of the LZ4 frame format - the format of `.lz4` files
+ * produced by the `lz4` command-line tool and by the LZ4 library's LZ4F_ functions - so
+ * that buffer files can be read and written compressed, without an external dependency.
+ *
+ * Frames are compressed into independent 4 MiB blocks, with the content size and a
+ * content checksum; the blocks are compressed in parallel. Decompression handles any
+ * valid frame (except ones using a dictionary), as well as concatenated and skippable
+ * frames; independent blocks of frames with a known content size are decompressed in
+ * parallel, everything else sequentially.
+ */
+namespace lz4_frame {
+
+host_buffer_type compress(poor_mans_span data, unsigned num_threads);
+host_buffer_type decompress(poor_mans_span compressed, unsigned num_threads);
+
+// The XXH32 hash, which the frame format uses for its checksums
+std::uint32_t xxh32(const void* data, std::size_t size, std::uint32_t seed = 0);
+
+} // namespace lz4_frame
+
+#endif /* LZ4_FRAME_HPP_ */
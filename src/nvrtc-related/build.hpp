@@ -50,6 +50,8 @@
 #include <memory>
 #include <algorithm>
 #include <cstring>
+#include <unordered_map>
+#include <vector>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -96,6 +98,7 @@ struct compilation_result_t {
     optional<cuda::module_t> module;
     optional<std::string> ptx;
     optional<std::string> mangled_signature;
+    std::unordered_map<std::string, std::string> mangled_signatures; // of all kernel functions built
 };
 
 compilation_result_t build_cuda_kernel(
@@ -103,6 +106,8 @@ compilation_result_t build_cuda_kernel(
     const char*,
     const char* kernel_source,
     const char* kernel_function_name,
+    const std::vector<std::string>& additional_kernel_function_names,
+        // May include name expressions for instantiating templates
     bool debug_mode,
     bool generate_line_info,
     const std::string& language_standard,
@@ -132,6 +137,9 @@ compilation_result_t build_cuda_kernel(
     spdlog::debug("Kernel compilation generated-command-line arguments: \"{}\"", render(opts));
 
     program.register_global(kernel_function_name);
+    for(const auto& name : additional_kernel_function_names) {
+        program.register_global(name.c_str());
+    }
 
     try {
         program.compile(opts);
@@ -142,7 +150,7 @@ compilation_result_t build_cuda_kernel(
         // Accounting for a cuda-api-wrappers 0.5.2 gaffe
         auto log_size = strlen(raw_log.data());
         std::string log { raw_log.data(), log_size };
-        return { compilation_failed, std::move(log), nullopt, nullopt, nullopt };
+        return { compilation_failed, std::move(log), nullopt, nullopt, nullopt, {} };
     }
     spdlog::info("Kernel source compiled successfully.");
     bool compilation_succeeded { true };
@@ -153,6 +161,13 @@ compilation_result_t build_cuda_kernel(
 
     std::string mangled_kernel_function_signature = program.get_mangling_of(kernel_function_name);
     spdlog::trace("Mangled kernel function signature is: {}", mangled_kernel_function_signature);
+    std::unordered_map<std::string, std::string> mangled_signatures;
+    mangled_signatures.emplace(kernel_function_name, mangled_kernel_function_signature);
+    for(const auto& name : additional_kernel_function_names) {
+        std::string mangled = program.get_mangling_of(name.c_str());
+        spdlog::trace("Mangled signature of additional kernel function {} is: {}", name, mangled);
+        mangled_signatures.emplace(name, std::move(mangled));
+    }
 
     if (not program.has_ptx()) {
         throw std::runtime_error("No PTX in compiled kernel CUDA program");
@@ -168,7 +183,8 @@ compilation_result_t build_cuda_kernel(
         std::move(log),
         std::move(module),
         std::move(ptx_as_string),
-        std::move(mangled_kernel_function_signature)
+        std::move(mangled_kernel_function_signature),
+        std::move(mangled_signatures)
     };
 }
 
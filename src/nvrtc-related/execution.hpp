@@ -8,21 +8,149 @@ void initialize_execution_context<execution_ecosystem_t::cuda>(execution_context
 {
     auto device = cuda::device::get(execution_context.options.gpu_device_id);
     execution_context.cuda.context = device.create_context();
+    execution_context.cuda.context_lifetime = std::make_shared<bool>(true);
     execution_context.cuda.stream.emplace(execution_context.cuda.context->create_stream(cuda::stream::async));
     spdlog::trace("Created a CUDA context on GPU device {} ", execution_context.cuda.context->device_id());
 }
 
-void launch_time_and_sync_cuda_kernel(execution_context_t& execution_context, run_index_t run_index)
+struct cuda_run_kernels_t {
+    cuda::kernel_t main;
+    std::vector<cuda::kernel_t> steps; // one per launch step, if the adapter uses them
+};
+
+// Resolved ahead of the launches, so as not to delay them (e.g. while being timed)
+cuda_run_kernels_t get_cuda_run_kernels(const execution_context_t& execution_context)
+{
+    auto mangled_kernel_signature = execution_context.cuda.mangled_kernel_signature->c_str();
+    auto kernel = execution_context.cuda.module->get_kernel(mangled_kernel_signature);
+    std::vector<cuda::kernel_t> step_kernels;
+    for(const auto& step : execution_context.launch_steps) {
+        step_kernels.push_back(step.kernel_function.empty() ? kernel :
+            execution_context.cuda.module->get_kernel(
+                execution_context.cuda.mangled_kernel_signatures.at(step.kernel_function).c_str()));
+    }
+    return { kernel, std::move(step_kernels) };
+}
+
+#if CUDA_VERSION >= 12000
+CUaccessPolicyWindow make_access_policy_window(const execution_context_t& execution_context, const l2_access_policy_window_t& window)
+{
+    // Resolved at launch time, since the buffer may be switched, e.g. between the slots of a frame stream
+    const auto& buffer = find_device_side_buffer(execution_context, window.buffer_name)->cuda;
+    CUaccessPolicyWindow result {};
+    result.base_ptr = buffer.data();
+    result.num_bytes = window.num_bytes.value_or(buffer.size());
+    result.hitRatio = window.hit_ratio;
+    result.hitProp = CU_ACCESS_PROPERTY_PERSISTING;
+    result.missProp = CU_ACCESS_PROPERTY_STREAMING;
+    return result;
+}
+
+// For launches with attributes which cuda::launch_configuration_t can't express
+void launch_with_extended_attributes(
+    const execution_context_t&                 execution_context,
+    const cuda::kernel_t&                      kernel,
+    const cuda::stream_t&                      stream,
+    const optional_launch_config_components_t& components,
+    const std::vector<const void*>&            arguments)
+{
+    std::array<CUlaunchAttribute, 3> attributes {};
+    unsigned num_attributes { 0 };
+    if (components.cluster_dimensions) {
+        const auto& cd = components.cluster_dimensions.value();
+        auto& attribute = attributes[num_attributes++];
+        attribute.id = CU_LAUNCH_ATTRIBUTE_CLUSTER_DIMENSION;
+        attribute.value.clusterDim.x = (unsigned) cd[0];
+        attribute.value.clusterDim.y = (unsigned) cd[1];
+        attribute.value.clusterDim.z = (unsigned) cd[2];
+    }
+    if (components.l2_access_policy_window) {
+        auto& attribute = attributes[num_attributes++];
+        attribute.id = CU_LAUNCH_ATTRIBUTE_ACCESS_POLICY_WINDOW;
+        attribute.value.accessPolicyWindow = make_access_policy_window(execution_context, components.l2_access_policy_window.value());
+    }
+    if (components.cooperative.value_or(false)) {
+        auto& attribute = attributes[num_attributes++];
+        attribute.id = CU_LAUNCH_ATTRIBUTE_COOPERATIVE;
+        attribute.value.cooperative = 1;
+    }
+    const auto& gd = components.grid_dimensions.value();
+    const auto& bd = components.block_dimensions.value();
+    CUlaunchConfig config {};
+    config.gridDimX = (unsigned) gd[0];
+    config.gridDimY = (unsigned) gd[1];
+    config.gridDimZ = (unsigned) gd[2];
+    config.blockDimX = (unsigned) bd[0];
+    config.blockDimY = (unsigned) bd[1];
+    config.blockDimZ = (unsigned) bd[2];
+    config.sharedMemBytes = (unsigned) components.dynamic_shared_memory_size.value_or(0);
+    config.hStream = stream.handle();
+    config.attrs = attributes.data();
+    config.numAttrs = num_attributes;
+    auto status = cuLaunchKernelEx(&config, kernel.handle(), const_cast<void**>(arguments.data()), nullptr);
+    if (status != CUDA_SUCCESS) {
+        throw std::runtime_error("Failed launching a kernel with extended launch attributes: CUDA driver error "
+            + std::to_string(status));
+    }
+}
+#endif
+
+void launch_cuda_kernel(
+    const execution_context_t&                 execution_context,
+    const cuda::kernel_t&                      kernel,
+    const cuda::stream_t&                      stream,
+    const launch_configuration_type&           launch_config,
+    const optional_launch_config_components_t& components,
+    const std::vector<const void*>&            arguments)
+{
+    if (components.has_extended_launch_attributes()) {
+#if CUDA_VERSION >= 12000
+        launch_with_extended_attributes(execution_context, kernel, stream, components, arguments);
+        return;
+#else
+        (void) execution_context;
+        throw std::logic_error("Extended launch attributes require CUDA 12.0 or later");
+#endif
+    }
+    cuda::launch_type_erased(kernel, stream, launch_config.cuda, arguments);
+}
+
+// Enqueues the launch (or launches) making up a single run of the kernel, without waiting
+// for them to complete
+void enqueue_cuda_kernel_launches(
+    const execution_context_t& execution_context,
+    const cuda_run_kernels_t&  kernels,
+    const cuda::stream_t&      stream)
+{
+    if (execution_context.launch_steps.empty()) {
+        spdlog::debug("Passing {} arguments to kernel {}",
+            execution_context.finalized_arguments.pointers.size() - 1,
+            execution_context.options.kernel.function_name.c_str());
+
+        launch_cuda_kernel(execution_context, kernels.main, stream, execution_context.kernel_launch_configuration,
+            execution_context.kernel_launch_config_components, execution_context.finalized_arguments.pointers);
+    }
+    else {
+        spdlog::debug("Enqueuing {} launches of kernel {}",
+            execution_context.launch_steps.size(), execution_context.options.kernel.function_name.c_str());
+        for(std::size_t i = 0; i < execution_context.launch_steps.size(); i++) {
+            const auto& step = execution_context.launch_steps[i];
+            launch_cuda_kernel(execution_context, kernels.steps[i], stream, step.launch_config,
+                step.launch_config_components, step.arguments.pointers);
+        }
+    }
+}
+
+optional<execution_duration_type> launch_time_and_sync_cuda_kernel(execution_context_t& execution_context, run_index_t run_index)
 {
     auto& cuda_context = *execution_context.cuda.context;
     cuda::context::current::scoped_override_t cuda_context_for_this_scope(cuda_context);
 
-    const auto& lc = execution_context.kernel_launch_configuration.cuda;
     spdlog::info("Launching kernel {} (function name \"{}\")",
                  execution_context.options.kernel.key,
                  execution_context.options.kernel.function_name);
+    auto kernels = get_cuda_run_kernels(execution_context);
 
-    spdlog::debug("Created a non-blocking CUDA stream on device {}", cuda_context.device_id());
     struct event_pair_t {
         cuda::event_t before, after;
     } ;
@@ -35,30 +163,21 @@ void launch_time_and_sync_cuda_kernel(execution_context_t& execution_context, ru
         };
         execution_context.cuda.stream->enqueue.event(timing_events->before);
     }
-    auto mangled_kernel_signature = execution_context.cuda.mangled_kernel_signature->c_str();
-    auto kernel = execution_context.cuda.module->get_kernel(mangled_kernel_signature);
-
-    spdlog::debug("Passing {} arguments to kernel {}",
-        execution_context.finalized_arguments.pointers.size() - 1,
-        execution_context.options.kernel.function_name.c_str());
-
-    cuda::launch_type_erased(
-        kernel,
-       execution_context.cuda.stream.value(),
-       lc,
-       execution_context.finalized_arguments.pointers);
+    enqueue_cuda_kernel_launches(execution_context, kernels, execution_context.cuda.stream.value());
 
     if (execution_context.options.time_with_events) {
         execution_context.cuda.stream->enqueue.event(timing_events->after);
     }
     execution_context.cuda.stream->synchronize();
 
-    if (execution_context.options.time_with_events) {
-        auto duration = cuda::event::time_elapsed_between(timing_events->before, timing_events->after);
-        spdlog::info("Event-measured time of run {} of kernel {}: {:.0f} nsec",
-            run_index+1, execution_context.kernel_adapter_->kernel_function_name(), ((double) duration.count() * 1000000.0));
-            // TODO: Maybe there's a nicer way to print durations as nsecs?
+    if (not execution_context.options.time_with_events) {
+        return nullopt;
     }
+    auto duration = cuda::event::time_elapsed_between(timing_events->before, timing_events->after);
+    spdlog::info("Event-measured time of run {} of kernel {}: {:.0f} nsec",
+        run_index+1, execution_context.kernel_adapter_->kernel_function_name(), ((double) duration.count() * 1000000.0));
+        // TODO: Maybe there's a nicer way to print durations as nsecs?
+    return std::chrono::duration_cast<execution_duration_type>(duration);
 }
 
 #endif // KERNEL_RUNNER_CUDA_EXECUTION_HPP_
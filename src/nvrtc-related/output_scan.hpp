@@ -0,0 +1,312 @@
+#ifndef KERNEL_RUNNER_CUDA_OUTPUT_SCAN_HPP_
+#define KERNEL_RUNNER_CUDA_OUTPUT_SCAN_HPP_
+
+#include "build.hpp"
+
+#include <execution_context.hpp>
+#include <element_types.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <stdexcept>
+
+// What a scan of a floating-point buffer found; the layout must match that in the scanning
+// kernels' source
+struct output_scan_summary_t {
+    unsigned long long nan_count;
+    unsigned long long infinity_count;
+    unsigned long long subnormal_count;
+    unsigned long long min_key; // The extreme non-NaN values, as doubles encoded so that
+    unsigned long long max_key; // their order is that of the unsigned integers
+};
+
+/**
+ * Kernels scanning a buffer of IEEE 754 values: Each thread classifies the elements of a
+ * grid-stride loop, the counts and extremes are reduced within each warp, and the first
+ * lane of the warp folds them into the summary with atomics - so the summary is all that
+ * needs to be copied back to the host.
+ */
+constexpr const char* output_scan_kernels_source = R"(
+struct scan_summary {
+    unsigned long long nan_count;
+    unsigned long long infinity_count;
+    unsigned long long subnormal_count;
+    unsigned long long min_key;
+    unsigned long long max_key;
+};
+
+__device__ unsigned long long order_preserving_key(double x)
+{
+    unsigned long long bits = (unsigned long long) __double_as_longlong(x);
+    return (bits >> 63) ? ~bits : (bits | (1ull << 63));
+}
+
+__device__ double as_double(unsigned short bits)
+{
+    unsigned long long sign = (unsigned long long) (bits >> 15) << 63;
+    unsigned exponent = (bits >> 10) & 0x1F;
+    unsigned long long mantissa = bits & 0x3FF;
+    if (exponent == 0) {
+        double magnitude = (double) mantissa * 5.9604644775390625e-8; // 2^-24
+        return sign ? -magnitude : magnitude;
+    }
+    unsigned long long double_exponent = (exponent == 0x1F) ? 0x7FF : (exponent - 15 + 1023);
+    return __longlong_as_double((long long) (sign | (double_exponent << 52) | (mantissa << 42)));
+}
+
+__device__ double as_double(unsigned bits) { return (double) __uint_as_float(bits); }
+__device__ double as_double(unsigned long long bits) { return __longlong_as_double((long long) bits); }
+
+template <typename Bits, int ExponentBits, int MantissaBits>
+__device__ void scan(scan_summary* summary, const Bits* elements, unsigned long long length)
+{
+    const Bits exponent_mask = (Bits) ((1ull << ExponentBits) - 1);
+    const Bits mantissa_mask = (Bits) ((1ull << MantissaBits) - 1);
+    unsigned long long nans = 0, infinities = 0, subnormals = 0;
+    unsigned long long min_key = ~0ull, max_key = 0;
+    unsigned long long stride = (unsigned long long) gridDim.x * blockDim.x;
+    for(unsigned long long i = (unsigned long long) blockIdx.x * blockDim.x + threadIdx.x; i < length; i += stride) {
+        Bits bits = elements[i];
+        Bits exponent = (bits >> MantissaBits) & exponent_mask;
+        Bits mantissa = bits & mantissa_mask;
+        if (exponent == exponent_mask) {
+            if (mantissa != 0) { nans++; continue; }
+            infinities++;
+        }
+        else if (exponent == 0 and mantissa != 0) { subnormals++; }
+        unsigned long long key = order_preserving_key(as_double(bits));
+        min_key = (key < min_key) ? key : min_key;
+        max_key = (key > max_key) ? key : max_key;
+    }
+    for(int offset = warpSize / 2; offset > 0; offset /= 2) {
+        nans += __shfl_down_sync(0xFFFFFFFFu, nans, offset);
+        infinities += __shfl_down_sync(0xFFFFFFFFu, infinities, offset);
+        subnormals += __shfl_down_sync(0xFFFFFFFFu, subnormals, offset);
+        unsigned long long other_min_key = __shfl_down_sync(0xFFFFFFFFu, min_key, offset);
+        unsigned long long other_max_key = __shfl_down_sync(0xFFFFFFFFu, max_key, offset);
+        min_key = (other_min_key < min_key) ? other_min_key : min_key;
+        max_key = (other_max_key > max_key) ? other_max_key : max_key;
+    }
+    if (threadIdx.x % warpSize != 0) { return; }
+    if (nans > 0) { atomicAdd(&summary->nan_count, nans); }
+    if (infinities > 0) { atomicAdd(&summary->infinity_count, infinities); }
+    if (subnormals > 0) { atomicAdd(&summary->subnormal_count, subnormals); }
+    atomicMin(&summary->min_key, min_key);
+    atomicMax(&summary->max_key, max_key);
+}
+
+__global__ void scan_float16(scan_summary* summary, const unsigned short* elements, unsigned long long length)
+{
+    scan<unsigned short, 5, 10>(summary, elements, length);
+}
+
+__global__ void scan_float32(scan_summary* summary, const unsigned* elements, unsigned long long length)
+{
+    scan<unsigned, 8, 23>(summary, elements, length);
+}
+
+__global__ void scan_float64(scan_summary* summary, const unsigned long long* elements, unsigned long long length)
+{
+    scan<unsigned long long, 11, 52>(summary, elements, length);
+}
+
+// The SplitMix64 finalizer
+__device__ unsigned long long mix(unsigned long long x)
+{
+    x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27; x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Two 64-bit sums of hashes of each 8-byte word together with its position - which, being
+// sums, don't depend on the order in which the threads add them up
+__global__ void hash_output(unsigned long long* hash, const unsigned char* data, unsigned long long size)
+{
+    unsigned long long num_words = (size + 7) / 8;
+    unsigned long long sums[2] = { 0, 0 };
+    unsigned long long stride = (unsigned long long) gridDim.x * blockDim.x;
+    for(unsigned long long i = (unsigned long long) blockIdx.x * blockDim.x + threadIdx.x; i < num_words; i += stride) {
+        unsigned long long word = 0;
+        if ((i + 1) * 8 <= size) { word = ((const unsigned long long*) data)[i]; }
+        else {
+            for(unsigned long long j = i * 8; j < size; j++) { word |= (unsigned long long) data[j] << (8 * (j - i * 8)); }
+        }
+        sums[0] += mix(word ^ mix(i));
+        sums[1] += mix(word + mix(i ^ 0x9E3779B97F4A7C15ull));
+    }
+    for(int offset = warpSize / 2; offset > 0; offset /= 2) {
+        sums[0] += __shfl_down_sync(0xFFFFFFFFu, sums[0], offset);
+        sums[1] += __shfl_down_sync(0xFFFFFFFFu, sums[1], offset);
+    }
+    if (threadIdx.x % warpSize != 0) { return; }
+    atomicAdd(&hash[0], sums[0]);
+    atomicAdd(&hash[1], sums[1]);
+}
+)";
+
+constexpr const char* output_hash_kernel_name { "hash_output" };
+
+inline double decode_output_scan_key(unsigned long long key)
+{
+    constexpr const unsigned long long sign_bit { 1ull << 63 };
+    unsigned long long bits = (key & sign_bit) ? (key & ~sign_bit) : ~key;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline const char* output_scan_kernel_name(element_type_t type)
+{
+    switch(type) {
+    case element_type_t::float16: return "scan_float16";
+    case element_type_t::float32: return "scan_float32";
+    case element_type_t::float64: return "scan_float64";
+    default:
+        throw std::invalid_argument(std::string("Can't scan buffers of non-floating-point type ") + element_type_name(type));
+    }
+}
+
+void build_output_scan_kernels(execution_context_t& context)
+{
+    spdlog::debug("Building the kernels for scanning outputs.");
+    auto result = build_cuda_kernel(
+        *context.cuda.context,
+        "output_scan",
+        output_scan_kernels_source,
+        output_scan_kernel_name(element_type_t::float16),
+        { output_scan_kernel_name(element_type_t::float32), output_scan_kernel_name(element_type_t::float64),
+          output_hash_kernel_name },
+        false, // debug mode
+        false, // line info
+        "",    // language standard
+        {}, {}, {}, {});
+    if (not result.succeeded) {
+        throw std::runtime_error("Failed building the kernels for scanning outputs: " + result.log.value_or(""));
+    }
+    context.cuda.output_scan_module = std::move(result.module);
+    context.cuda.output_scan_kernel_signatures = std::move(result.mangled_signatures);
+}
+
+// Launches one of the bundled kernels over a buffer, with a grid just large enough for the
+// device to run all of it at once, and waits for it to conclude
+void launch_output_scan_kernel(
+    execution_context_t&            context,
+    const char*                     kernel_name,
+    std::size_t                     num_elements,
+    const std::vector<const void*>& arguments)
+{
+    if (not context.cuda.output_scan_module) {
+        build_output_scan_kernels(context);
+    }
+    constexpr const std::size_t block_size { 256 };
+    optional_launch_config_components_t components;
+    components.set_block_dims(block_size, 1, 1);
+    components.set_grid_dims(std::max<std::size_t>(1, std::min<std::size_t>(blocks_filling_device(context, block_size),
+        util::div_rounding_up(num_elements, block_size))), 1, 1);
+    components.dynamic_shared_memory_size = 0;
+    auto kernel = context.cuda.output_scan_module->get_kernel(
+        context.cuda.output_scan_kernel_signatures.at(kernel_name).c_str());
+    auto& stream = context.cuda.stream.value();
+    cuda::launch_type_erased(kernel, stream, (cuda::launch_configuration_t) components, arguments);
+    stream.synchronize();
+}
+
+/**
+ * Scans the floating-point output buffers the user asked about (--scan-output) on the device,
+ * reporting how many NaN, infinite and subnormal elements each has, and its minimum and
+ * maximum (non-NaN) elements. Only the summary of each scan is copied back to the host.
+ */
+void scan_floating_point_outputs(execution_context_t& context, run_index_t run_index)
+{
+    if (context.options.output_scans.empty()) { return; }
+    auto& cuda_context = *context.cuda.context;
+    cuda::context::current::scoped_override_t scoped_context_override{ cuda_context };
+    auto summary_region = cuda::memory::device::allocate(cuda_context, sizeof(output_scan_summary_t));
+    auto* device_side_summary = static_cast<output_scan_summary_t*>(summary_region.data());
+    for(const auto& p : context.options.output_scans) {
+        const auto& name = p.first;
+        auto type = p.second;
+        const auto& buffer = context.buffers.device_side.outputs.at(name).cuda;
+        unsigned long long length = buffer.size() / element_size(type);
+        if (length == 0) { continue; }
+        output_scan_summary_t summary { 0, 0, 0, ~0ull, 0 };
+        cuda::memory::copy(device_side_summary, &summary, sizeof(summary));
+        const void* elements = buffer.data();
+        launch_output_scan_kernel(context, output_scan_kernel_name(type), length,
+            { &device_side_summary, &elements, &length, nullptr });
+        cuda::memory::copy(&summary, device_side_summary, sizeof(summary));
+
+        auto num_non_nan = length - summary.nan_count;
+        auto level = (summary.nan_count > 0 or summary.infinity_count > 0) ? spdlog::level::warn : spdlog::level::info;
+        if (num_non_nan == 0) {
+            spdlog::log(level, "Run {}: Output buffer '{}' ({} {} elements) is all NaNs",
+                run_index + 1, name, length, element_type_name(type));
+            continue;
+        }
+        spdlog::log(level, "Run {}: Output buffer '{}' ({} {} elements) has {} NaN, {} infinite and {} subnormal "
+            "elements; its (non-NaN) elements range from {} to {}",
+            run_index + 1, name, length, element_type_name(type),
+            summary.nan_count, summary.infinity_count, summary.subnormal_count,
+            decode_output_scan_key(summary.min_key), decode_output_scan_key(summary.max_key));
+    }
+    cuda::memory::device::free(summary_region);
+}
+
+/**
+ * Hashes each output buffer on the device after a run, and compares the hashes with those of
+ * the first run (--check-determinism) - so that nondeterminism, e.g. due to races or to the
+ * order of atomic operations, is detected without copying the outputs to the host. The hash
+ * is not cryptographic, but any accidental difference is all but certain to change it.
+ */
+void check_output_determinism(execution_context_t& context, run_index_t run_index)
+{
+    if (not context.options.check_determinism) { return; }
+    auto& cuda_context = *context.cuda.context;
+    cuda::context::current::scoped_override_t scoped_context_override{ cuda_context };
+    auto& hashes = context.output_hashes;
+    if (run_index == 0) {
+        hashes.of_first_run.clear();
+        hashes.first_divergent_runs.clear();
+    }
+    auto hash_region = cuda::memory::device::allocate(cuda_context, sizeof(output_hash_t));
+    auto* device_side_hash = static_cast<std::uint64_t*>(hash_region.data());
+    for(const auto& p : context.buffers.device_side.outputs) {
+        const auto& name = p.first;
+        const auto& buffer = p.second.cuda;
+        output_hash_t hash { 0, 0 };
+        cuda::memory::copy(device_side_hash, hash.data(), sizeof(hash));
+        const void* data = buffer.data();
+        unsigned long long size = buffer.size();
+        launch_output_scan_kernel(context, output_hash_kernel_name, util::div_rounding_up(buffer.size(), sizeof(std::uint64_t)),
+            { &device_side_hash, &data, &size, nullptr });
+        cuda::memory::copy(hash.data(), device_side_hash, sizeof(hash));
+        spdlog::debug("Run {}: Hash of output buffer '{}' is {:016x}{:016x}", run_index + 1, name, hash[1], hash[0]);
+
+        if (run_index == 0) {
+            hashes.of_first_run[name] = hash;
+            continue;
+        }
+        if (hash == hashes.of_first_run.at(name) or util::contains(hashes.first_divergent_runs, name)) { continue; }
+        hashes.first_divergent_runs.emplace(name, run_index);
+        spdlog::warn("Run {}: Output buffer '{}' differs from its contents after run 1 - the kernel is not deterministic",
+            run_index + 1, name);
+    }
+    cuda::memory::device::free(hash_region);
+
+    if (run_index + 1 < context.options.num_runs) { return; }
+    if (context.options.num_runs < 2) {
+        spdlog::warn("Checking the determinism of the outputs requires multiple runs");
+    }
+    else if (hashes.first_divergent_runs.empty()) {
+        spdlog::info("The outputs of all {} runs are bit-identical", context.options.num_runs);
+    }
+    else {
+        auto first_divergence = std::min_element(hashes.first_divergent_runs.cbegin(), hashes.first_divergent_runs.cend(),
+            [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+        spdlog::warn("The outputs of {} of {} output buffers were not the same in all runs; they first diverged in run {}",
+            hashes.first_divergent_runs.size(), context.buffers.device_side.outputs.size(), first_divergence->second + 1);
+    }
+}
+
+#endif // KERNEL_RUNNER_CUDA_OUTPUT_SCAN_HPP_
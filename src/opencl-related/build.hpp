@@ -8,6 +8,8 @@
 #include <buffer_io.hpp>
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // TODO: Use the generated PTX for the device index!
 std::string obtain_ptx(const cl::Program &built_program, device_id_t device_id)
@@ -126,6 +128,7 @@ struct opencl_compilation_result_t {
     cl::Program program; // Don't need this to be optional, since it's not a RAII type
     cl::Kernel kernel; // Don't need this to be optional, since it's not a RAII type
     optional<std::string> ptx;
+    std::unordered_map<std::string, cl::Kernel> kernels; // all kernel functions built, including the main one
 };
 
 opencl_compilation_result_t build_opencl_kernel(
@@ -133,6 +136,7 @@ opencl_compilation_result_t build_opencl_kernel(
     cl::Device  device,
     device_id_t device_id,
     const char* kernel_name,
+    const std::vector<std::string>& additional_kernel_names,
     const char* kernel_source,
     bool        compile_in_debug_mode,
     bool        generate_line_info,
@@ -175,7 +179,7 @@ opencl_compilation_result_t build_opencl_kernel(
         }
         std::string log = program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device);
         auto compilation_failed { false };
-        return { compilation_failed, log, {}, {}, nullopt };
+        return { compilation_failed, log, {}, {}, nullopt, {} };
     }
     spdlog::trace("OpenCL program built successfully.");
     std::string compilation_log = program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device);
@@ -189,8 +193,13 @@ opencl_compilation_result_t build_opencl_kernel(
     try {
         cl::Kernel kernel(program, kernel_name);
         spdlog::trace("OpenCL kernel object created.");
+        std::unordered_map<std::string, cl::Kernel> kernels { { kernel_name, kernel } };
+        for(const auto& name : additional_kernel_names) {
+            spdlog::debug("Creating OpenCL kernel object for additional kernel '{}'.", name);
+            kernels.emplace(name, cl::Kernel(program, name.c_str()));
+        }
         auto compilation_succeeded { true };
-        return { compilation_succeeded, compilation_log, std::move(program), std::move(kernel), std::move(ptx) };
+        return { compilation_succeeded, compilation_log, std::move(program), std::move(kernel), std::move(ptx), std::move(kernels) };
     } catch(cl::Error& ex) {
         spdlog::error("Failed creating kernel; OpenCL error: {}",  clGetErrorString(ex.err()));
         throw ex;
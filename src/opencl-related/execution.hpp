@@ -32,6 +32,20 @@ opencl_duration_type opencl_command_execution_time(cl::Event& ev)
     return opencl_duration_type{t_end - t_start};
 }
 
+// From the start of the first command to the end of the last one
+opencl_duration_type opencl_commands_execution_time(cl::Event& first, cl::Event& last)
+{
+    cl_ulong t_start { 0 }, t_end { 0 };
+    try {
+        first.getProfilingInfo(CL_PROFILING_COMMAND_START, &t_start);
+        last.getProfilingInfo(CL_PROFILING_COMMAND_END, &t_end);
+    }
+    catch(cl::Error& e) {
+        spdlog::error("Failed obtaining execution event start or end time (using {}): {}", e.what(), clGetErrorString(e.err()) );
+    }
+    return opencl_duration_type{t_end - t_start};
+}
+
 template <>
 void initialize_execution_context<execution_ecosystem_t::opencl>(execution_context_t& execution_context)
 {
@@ -48,41 +62,68 @@ void initialize_execution_context<execution_ecosystem_t::opencl>(execution_conte
         cl::CommandQueue(execution_context.opencl.context, execution_context.opencl.device, queue_properties);
 }
 
-void launch_time_and_sync_opencl_kernel(execution_context_t& context, run_index_t run_index)
+optional<execution_duration_type> launch_time_and_sync_opencl_kernel(execution_context_t& context, run_index_t run_index)
 {
     auto lc = context.kernel_launch_configuration;
     cl::Event kernel_execution; // When uninitialized, no OpenCL API call is made
-
-    set_opencl_kernel_arguments(context.opencl.built_kernel, context.finalized_arguments);
+    cl::Event last_step_execution; // Only used with multiple launch steps
 
     const std::vector<cl::Event>* no_events_to_wait_on { nullptr };
     auto kernel_execution_event_ptr =
     context.options.time_with_events ? &kernel_execution : nullptr;
 
-    try {
-        context.opencl.queue.enqueueNDRangeKernel(
-            context.opencl.built_kernel,
-            lc.opencl.offset(),
-            lc.opencl.global_dims(),
-            lc.opencl.local_dims(),
-            no_events_to_wait_on,
-            kernel_execution_event_ptr);
+    auto enqueue = [&](const cl::Kernel& kernel, const raw_opencl_launch_config& config, cl::Event* event_ptr) {
+        try {
+            context.opencl.queue.enqueueNDRangeKernel(
+                kernel,
+                config.offset(),
+                config.global_dims(),
+                config.local_dims(),
+                no_events_to_wait_on,
+                event_ptr);
+        }
+        catch(cl::Error& e) {
+            spdlog::error("Failed enqueuing kernel: {}", clGetErrorString(e.err()) );
+        }
+    };
+
+    if (context.launch_steps.empty()) {
+        set_opencl_kernel_arguments(context.opencl.built_kernel, context.finalized_arguments);
+        enqueue(context.opencl.built_kernel, lc.opencl, kernel_execution_event_ptr);
     }
-    catch(cl::Error& e) {
-        spdlog::error("Failed enqueuing kernel: {}", clGetErrorString(e.err()) );
+    else {
+        // Kernel arguments are captured when a launch is enqueued, so we can reset them for every step
+        auto num_steps = context.launch_steps.size();
+        for(std::size_t i = 0; i < num_steps; i++) {
+            auto& step = context.launch_steps[i];
+            auto& kernel = step.kernel_function.empty() ?
+                context.opencl.built_kernel : context.opencl.built_kernels.at(step.kernel_function);
+            set_opencl_kernel_arguments(kernel, step.arguments);
+            auto event_ptr =
+                (i == 0) ? kernel_execution_event_ptr :
+                (i + 1 == num_steps and context.options.time_with_events) ? &last_step_execution :
+                nullptr;
+            enqueue(kernel, step.launch_config.opencl, event_ptr);
+        }
     }
 
     spdlog::debug("Launched run {} of kernel '{}'", run_index+1, context.kernel_adapter_->kernel_function_name());
 
     if (context.options.time_with_events) {
-        kernel_execution.wait();
-        auto time_elapsed = opencl_command_execution_time(kernel_execution);
+        auto time_elapsed = [&]() {
+            kernel_execution.wait();
+            if (context.launch_steps.size() <= 1) {
+                return opencl_command_execution_time(kernel_execution);
+            }
+            last_step_execution.wait();
+            return opencl_commands_execution_time(kernel_execution, last_step_execution);
+        }();
         spdlog::info("Event-measured time of run {} of kernel {}: {} nsec",
             run_index+1, context.kernel_adapter_->kernel_function_name(), time_elapsed.count());
+        return std::chrono::duration_cast<execution_duration_type>(time_elapsed);
     }
-    else {
-        context.opencl.queue.finish(); // To make sure we catch any possible errors here.
-    }
+    context.opencl.queue.finish(); // To make sure we catch any possible errors here.
+    return nullopt;
 }
 
 #endif // KERNEL_RUNNER_OPENCL_EXECUTION_HPP_
\ No newline at end of file
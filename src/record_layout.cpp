@@ -0,0 +1,108 @@
+#include "record_layout.hpp"
+
+#include <util/parallel.hpp>
+#include <util/miscellany.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Each block's records, and its slices of the field arrays, should fit in the L2 cache together
+constexpr const std::size_t block_size_in_bytes { 64 * 1024 };
+
+enum class direction_t { to_planar, to_interleaved };
+
+// With the field size known at compile-time, the copies below become plain loads and stores
+template <std::size_t FieldSize>
+void transpose_field(byte_type* planar, byte_type* interleaved, std::size_t record_size, std::size_t num_records, direction_t direction)
+{
+    if (direction == direction_t::to_planar) {
+        for(std::size_t i = 0; i < num_records; i++) {
+            std::memcpy(planar + i * FieldSize, interleaved + i * record_size, FieldSize);
+        }
+    }
+    else {
+        for(std::size_t i = 0; i < num_records; i++) {
+            std::memcpy(interleaved + i * record_size, planar + i * FieldSize, FieldSize);
+        }
+    }
+}
+
+void transpose_field(
+    byte_type*  planar,
+    byte_type*  interleaved,
+    std::size_t field_size,
+    std::size_t record_size,
+    std::size_t num_records,
+    direction_t direction)
+{
+    switch(field_size) {
+    case 1:  transpose_field<1>(planar, interleaved, record_size, num_records, direction); return;
+    case 2:  transpose_field<2>(planar, interleaved, record_size, num_records, direction); return;
+    case 4:  transpose_field<4>(planar, interleaved, record_size, num_records, direction); return;
+    case 8:  transpose_field<8>(planar, interleaved, record_size, num_records, direction); return;
+    case 16: transpose_field<16>(planar, interleaved, record_size, num_records, direction); return;
+    default: break;
+    }
+    for(std::size_t i = 0; i < num_records; i++) {
+        auto planar_field = planar + i * field_size;
+        auto interleaved_field = interleaved + i * record_size;
+        if (direction == direction_t::to_planar) {
+            std::memcpy(planar_field, interleaved_field, field_size);
+        }
+        else {
+            std::memcpy(interleaved_field, planar_field, field_size);
+        }
+    }
+}
+
+void transpose(
+    const record_layout_t& layout,
+    poor_mans_span         planar,
+    poor_mans_span         interleaved,
+    unsigned               num_threads,
+    direction_t            direction)
+{
+    auto record_size = layout.record_size();
+    if (record_size == 0) {
+        throw std::invalid_argument("Records must have a positive size");
+    }
+    if (interleaved.size() % record_size != 0) {
+        throw std::invalid_argument("Buffer size " + std::to_string(interleaved.size())
+            + " is not a multiple of its record size, " + std::to_string(record_size));
+    }
+    if (planar.size() != interleaved.size()) {
+        throw std::invalid_argument("Mismatched sizes of the interleaved and planar buffers");
+    }
+    auto num_records = interleaved.size() / record_size;
+    auto records_per_block = std::max<std::size_t>(1, block_size_in_bytes / record_size);
+    auto num_blocks = util::div_rounding_up(num_records, records_per_block);
+    util::parallel_for(num_blocks, num_threads, [&](std::size_t block_index) {
+        auto first_record = block_index * records_per_block;
+        auto block_records = std::min(records_per_block, num_records - first_record);
+        std::size_t field_offset { 0 };
+        for(auto field_size : layout.field_sizes) {
+            // All of the field arrays preceding this one are num_records elements long
+            auto field_array = planar.data() + num_records * field_offset;
+            transpose_field(
+                field_array + first_record * field_size,
+                interleaved.data() + first_record * record_size + field_offset,
+                field_size, record_size, block_records, direction);
+            field_offset += field_size;
+        }
+    });
+}
+
+} // namespace
+
+void interleaved_to_planar(const record_layout_t& layout, poor_mans_span interleaved, poor_mans_span planar, unsigned num_threads)
+{
+    transpose(layout, planar, interleaved, num_threads, direction_t::to_planar);
+}
+
+void planar_to_interleaved(const record_layout_t& layout, poor_mans_span planar, poor_mans_span interleaved, unsigned num_threads)
+{
+    transpose(layout, planar, interleaved, num_threads, direction_t::to_interleaved);
+}
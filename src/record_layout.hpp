@@ -0,0 +1,32 @@
+#ifndef RECORD_LAYOUT_HPP_
+#define RECORD_LAYOUT_HPP_
+
+#include "common_types.hpp"
+
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The layout of a buffer file holding an array of fixed-size records (array-of-structures),
+ * for a kernel which expects the same data as a structure-of-arrays: an array of each field's
+ * values, one array after the other, in the order of the fields in the record.
+ */
+struct record_layout_t {
+    std::vector<std::size_t> field_sizes; // in bytes, in record order
+
+    std::size_t record_size() const
+    {
+        return std::accumulate(field_sizes.cbegin(), field_sizes.cend(), std::size_t{0});
+    }
+};
+
+using record_layouts_t = std::unordered_map<std::string, record_layout_t>; // by buffer name
+
+// Transposes records into field arrays, and back. Both spans must have the same size - a multiple
+// of the record size. The work is split into cache-sized blocks of records, on multiple threads.
+void interleaved_to_planar(const record_layout_t& layout, poor_mans_span interleaved, poor_mans_span planar, unsigned num_threads);
+void planar_to_interleaved(const record_layout_t& layout, poor_mans_span planar, poor_mans_span interleaved, unsigned num_threads);
+
+#endif /* RECORD_LAYOUT_HPP_ */
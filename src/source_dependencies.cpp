@@ -0,0 +1,86 @@
+#include <source_dependencies.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+struct include_directive_t {
+    std::string path;
+    bool quoted; // "..." rather than <...>
+};
+
+optional<include_directive_t> parse_include_directive(const std::string& line)
+{
+    auto pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos or line[pos] != '#') { return nullopt; }
+    pos = line.find_first_not_of(" \t", pos + 1);
+    static const std::string include_keyword { "include" };
+    if (pos == std::string::npos or line.compare(pos, include_keyword.length(), include_keyword) != 0) { return nullopt; }
+    pos = line.find_first_not_of(" \t", pos + include_keyword.length());
+    if (pos == std::string::npos or (line[pos] != '"' and line[pos] != '<')) { return nullopt; }
+    bool quoted = (line[pos] == '"');
+    auto end = line.find(quoted ? '"' : '>', pos + 1);
+    if (end == std::string::npos or end == pos + 1) { return nullopt; }
+    return include_directive_t{ line.substr(pos + 1, end - pos - 1), quoted };
+}
+
+optional<filesystem::path> locate_include(
+    const include_directive_t& directive,
+    const filesystem::path&    including_file_dir,
+    const include_paths_t&     include_dir_paths)
+{
+    if (directive.quoted) {
+        auto candidate = including_file_dir / directive.path;
+        if (filesystem::is_regular_file(candidate)) { return candidate; }
+    }
+    for(const auto& dir : include_dir_paths) {
+        auto candidate = filesystem::path{dir} / directive.path;
+        if (filesystem::is_regular_file(candidate)) { return candidate; }
+    }
+    return nullopt;
+}
+
+} // namespace
+
+std::vector<filesystem::path> find_included_files(
+    const filesystem::path& source_file,
+    const include_paths_t&  include_dir_paths,
+    const include_paths_t&  preinclude_files)
+{
+    std::vector<filesystem::path> found;
+    std::unordered_set<std::string> already_found { filesystem::canonical(source_file).native() };
+    std::vector<filesystem::path> to_scan { source_file };
+
+    auto add_if_new = [&](const filesystem::path& path) {
+        if (already_found.insert(filesystem::canonical(path).native()).second) {
+            found.push_back(path);
+            to_scan.push_back(path);
+        }
+    };
+
+    for(const auto& preinclude : preinclude_files) {
+        auto located = locate_include(include_directive_t{ preinclude, false }, {}, include_dir_paths);
+        if (located) { add_if_new(located.value()); }
+    }
+    while (not to_scan.empty()) {
+        auto file_path = to_scan.back();
+        to_scan.pop_back();
+        std::ifstream file { file_path.native() };
+        std::string line;
+        while (std::getline(file, line)) {
+            auto directive = parse_include_directive(line);
+            if (not directive) { continue; }
+            auto located = locate_include(directive.value(), file_path.parent_path(), include_dir_paths);
+            if (not located) {
+                spdlog::trace("Could not locate {} (included from {}); skipping it", directive->path, file_path.native());
+                continue;
+            }
+            add_if_new(located.value());
+        }
+    }
+    return found;
+}
@@ -0,0 +1,25 @@
+#ifndef SOURCE_DEPENDENCIES_HPP_
+#define SOURCE_DEPENDENCIES_HPP_
+
+#include <common_types.hpp>
+
+#include <vector>
+
+/**
+ * Locates the files a kernel source file includes, directly or transitively, by scanning
+ * for `#include` directives. Conditional compilation is not evaluated, so this may find
+ * more files than the compiler actually reads; and includes which can't be located in
+ * the search paths (e.g. the standard header substitutes provided to NVRTC) are skipped.
+ *
+ * @param source_file the kernel source file; not itself part of the result
+ * @param include_dir_paths the directories searched, in order, for included files
+ * @param preinclude_files files included before the source, looked up like `<...>` includes
+ * @return the paths of all included files found, each appearing once, in the order
+ * of their discovery
+ */
+std::vector<filesystem::path> find_included_files(
+    const filesystem::path& source_file,
+    const include_paths_t&  include_dir_paths,
+    const include_paths_t&  preinclude_files = {});
+
+#endif /* SOURCE_DEPENDENCIES_HPP_ */
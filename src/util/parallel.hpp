@@ -0,0 +1,54 @@
+#ifndef UTIL_PARALLEL_HPP_
+#define UTIL_PARALLEL_HPP_
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+namespace util {
+
+inline unsigned default_num_threads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Applies f to each of 0, 1, ..., num_tasks - 1, on up to num_threads threads (including the
+// calling one), which take the next task as they become free. If any of the applications
+// throws, the remaining tasks are skipped and the first exception is rethrown.
+template <typename F>
+void parallel_for(std::size_t num_tasks, unsigned num_threads, F f)
+{
+    num_threads = (unsigned) std::min<std::size_t>(std::max(num_threads, 1u), num_tasks);
+    if (num_threads <= 1) {
+        for(std::size_t i = 0; i < num_tasks; i++) { f(i); }
+        return;
+    }
+    std::atomic<std::size_t> next_task { 0 };
+    std::atomic<bool> failed { false };
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    auto work = [&]() {
+        for(auto i = next_task++; i < num_tasks and not failed; i = next_task++) {
+            try { f(i); }
+            catch(...) {
+                std::lock_guard<std::mutex> lock(failure_mutex);
+                if (not failure) { failure = std::current_exception(); }
+                failed = true;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for(unsigned i = 1; i < num_threads; i++) { threads.emplace_back(work); }
+    work();
+    for(auto& thread : threads) { thread.join(); }
+    if (failure) { std::rethrow_exception(failure); }
+}
+
+} // namespace util
+
+#endif /* UTIL_PARALLEL_HPP_ */